@@ -129,7 +129,42 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  // CREATE INDEX ... WITH (compression [= true | false])
+  bool compressed = false;
+  for (auto cell = stmt->options != nullptr ? stmt->options->head : nullptr; cell != nullptr; cell = cell->next) {
+    auto option = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+    if (StringUtil::Lower(option->defname) != "compression") {
+      throw NotImplementedException(fmt::format("index option {} is not supported", option->defname));
+    }
+    if (option->arg == nullptr) {
+      compressed = true;
+      continue;
+    }
+    auto value = reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg);
+    if (value->type == duckdb_libpgquery::T_PGInteger) {
+      compressed = value->val.ival != 0;
+    } else if (value->type == duckdb_libpgquery::T_PGString && StringUtil::Lower(value->val.str) == "true") {
+      compressed = true;
+    } else if (value->type == duckdb_libpgquery::T_PGString && StringUtil::Lower(value->val.str) == "false") {
+      compressed = false;
+    } else {
+      throw bustub::Exception("index option compression takes true or false");
+    }
+  }
+
+  // CREATE INDEX ... USING HASH, a B+ tree otherwise
+  auto index_type = StringUtil::Lower(stmt->accessMethod);
+  if (index_type == "art" || index_type == "btree") {
+    index_type = "btree";
+  } else if (index_type != "hash") {
+    throw NotImplementedException(fmt::format("index type {} is not supported", stmt->accessMethod));
+  }
+  if (index_type == "hash" && compressed) {
+    throw bustub::Exception("hash indexes cannot be compressed");
+  }
+
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols), compressed,
+                                          std::move(index_type));
 }
 
 }  // namespace bustub
@@ -12,6 +12,10 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include "common/exception.h"
 #include "common/macros.h"
 #include "common/logger.h"
@@ -20,218 +24,693 @@ namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
                                                      LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(static_cast<page_id_t>(instance_index)),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      scan_ring_(std::clamp<size_t>(pool_size / 8, 2, SCAN_RING_SIZE), -1),
+      clean_frame_target_(std::max<size_t>(1, pool_size / 8)),
+      prefetch_queue_limit_(std::max<size_t>(1, pool_size / 4)) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(instance_index < num_instances,
+                "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should "
+                "just be 1.");
   // we allocate a consecutive memory space for the buffer pool
   pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
+  frame_io_ = new FrameIoState[pool_size_];
+  page_table_ = new PageTable(pool_size_);
   replacer_ = new LRUKReplacer(pool_size, replacer_k);
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
     pages_[i].ResetMemory();
+    pages_[i].pin_count_ = -1;
   }
 
+  page_cleaner_ = std::thread(&BufferPoolManagerInstance::RunPageCleaner, this);
+  prefetcher_ = std::thread(&BufferPoolManagerInstance::RunPrefetcher, this);
+
   // TODO(students): remove this line after you have implemented the buffer pool manager
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopPrefetcher();
+  {
+    std::scoped_lock lock(latch_);
+    stop_page_cleaner_ = true;
+  }
+  page_cleaner_cv_.notify_one();
+  page_cleaner_.join();
+
   delete[] pages_;
+  delete[] frame_io_;
   delete page_table_;
   delete replacer_;
 }
 
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * { 
-    latch_.lock();
-    // LOG_DEBUG("Enter New Page function");
-    frame_id_t frame_id = INVALID_PAGE_ID;
-    // Page *newpage;
-    if(free_list_.empty() == false){
-      // LOG_DEBUG("Got free pages");
-      // *page_id = AllocatePage();
-      frame_id = free_list_.front();
-      free_list_.pop_front();
-      // LOG_DEBUG("Get a free page from free list");
-      // free frame may not need to reset memory?
-    } else {
-      // LOG_DEBUG("check whether the pages are all pinned");
-      bool is_allpined = true;
-      for(size_t i = 0;i < pool_size_;i++){
-        if(pages_[i].GetPinCount() == 0){
-          is_allpined = false;
-          break;
-        }
-      }
-      if(is_allpined){
-        // LOG_DEBUG("It's all pinned, just return nullptr");
-        page_id = nullptr;
-        latch_.unlock();
-        return nullptr;
-      } else {
-        // LOG_DEBUG("Not all pages are pinned, select one free page");
-        replacer_->Evict(&frame_id); // get a free frame_id of a frame
-        if(pages_[frame_id].IsDirty() == true){
-          // LOG_DEBUG("The page is dirty, flush it back to the disk");
-          page_id_t old_page_id;
-          old_page_id = pages_[frame_id].GetPageId();
-          disk_manager_->WritePage(old_page_id,pages_[frame_id].GetData());
-        }
-        page_table_->Remove(pages_[frame_id].page_id_);
-        // LOG_DEBUG("Remove the old page from page table");
-        // // LOG_DEBUG("Ready to return");
-      }
-      // // LOG_DEBUG("Go here?");
-    }
-    // LOG_DEBUG("Initialize the new page");
-    *page_id = AllocatePage();
-    // LOG_DEBUG("Allocate page successfully");
-    // page_table_->Insert(*page_id,frame_id);
-    // LOG_DEBUG("Insert to page table successfully");
-    pages_[frame_id].ResetMemory();
-    // LOG_DEBUG("Reset memory successfully");
-    pages_[frame_id].page_id_ = *page_id;
-    pages_[frame_id].is_dirty_ = false;
-    pages_[frame_id].pin_count_ = 1;
-    // LOG_DEBUG("Record access and set evictable");
-    replacer_->RecordAccess(frame_id);
-    replacer_->SetEvictable(frame_id, false);
-    page_table_->Insert(*page_id,frame_id);
-    disk_manager_->WritePage(pages_[frame_id].GetPageId(),pages_[frame_id].GetData());
-    // LOG_DEBUG("return the new page");
-    latch_.unlock(); 
-    return &pages_[frame_id];
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+  std::unique_lock<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  page_id_t victim_page_id;
+  if (!AcquireFrame(&lock, &frame_id, &victim_page_id)) {
+    return nullptr;
   }
 
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
-  latch_.lock();
-  // std::cout << "Fetching Page " << page_id << std::endl;
-  frame_id_t frame_id = INVALID_PAGE_ID;
+  // The new page only exists in memory for now. It starts out dirty, so the page cleaner or an eviction writes it.
+  *page_id = AllocatePage();
+  InstallPage(frame_id, *page_id, true);
+  DoFrameIo(&lock, frame_id, victim_page_id, *page_id, false);
+  return &pages_[frame_id];
+}
 
-  if (!page_table_->Find(page_id, frame_id)) {
-    // Not in memory
-    if (!free_list_.empty()) {
-      frame_id = free_list_.front();
-      free_list_.pop_front();
-    } else {
-      bool evicted = replacer_->Evict(&frame_id);
-      // No page evictable
-      if (!evicted) {
-        latch_.unlock();
-        return nullptr;
-      }
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * {
+  frame_id_t frame_id;
 
-      Page *page = &pages_[frame_id];
-      if (page->IsDirty()) {
-        disk_manager_->WritePage(page->GetPageId(), page->GetData());
-      }
-      page_table_->Remove(page->page_id_);
+  // Fast path: the page is resident. Neither the lookup nor the pin takes the latch.
+  if (page_table_->Find(page_id, frame_id) && TryPinResident(frame_id, page_id)) {
+    RecordHit(frame_id, access_type);
+    if (frame_io_[frame_id].io_in_progress_) {
+      std::unique_lock<std::mutex> lock(latch_);
+      WaitForFrameIo(&lock, frame_id);
     }
+    return &pages_[frame_id];
+  }
 
-    Page *page = &pages_[frame_id];
-    page->ResetMemory();
-    page->page_id_ = INVALID_PAGE_ID;
-    page->pin_count_ = 0;
-    page->is_dirty_ = false;
-    page->page_id_ = page_id;
-    disk_manager_->ReadPage(page_id, page->data_);
-    page_table_->Insert(page_id, frame_id);
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!page_table_->Find(page_id, frame_id)) {
+    auto writing = writing_back_.find(page_id);
+    if (writing != writing_back_.end()) {
+      // The page was just evicted and its write-back is still in flight. Reading it now would return stale data.
+      frame_id_t writer = writing->second;
+      WaitForFrameIo(&lock, writer);
+      continue;
+    }
+
+    // Not in memory. Publish the frame as loading page_id before releasing the latch, so that concurrent fetchers of
+    // the same page find it in the page table and wait on this frame only.
+    page_id_t victim_page_id;
+    if (!AcquireFrame(&lock, &frame_id, &victim_page_id, access_type)) {
+      return nullptr;
+    }
+    InstallPage(frame_id, page_id, false);
+    DoFrameIo(&lock, frame_id, victim_page_id, page_id, true);
+    return &pages_[frame_id];
   }
 
+  // Frames are only reclaimed with the latch held, so a frame in the page table can be pinned directly. Pin before
+  // waiting, so that the frame cannot be evicted while it is still being loaded.
   Page *page = &pages_[frame_id];
   page->pin_count_++;
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
-  latch_.unlock();
+  RecordHit(frame_id, access_type);
+  WaitForFrameIo(&lock, frame_id);
+  return page;
+}
+
+auto BufferPoolManagerInstance::FetchPageOptimistic(page_id_t page_id, uint64_t *version) -> Page * {
+  frame_id_t frame_id;
+  if (!page_table_->Find(page_id, frame_id)) {
+    return nullptr;
+  }
+  Page *page = &pages_[frame_id];
+  *version = page->GetVersion();
+  // An even version means the frame is not being reused right now, and checking the page id after reading the version
+  // means it was not reused before either. Reuse after this point changes the version.
+  if ((*version & 1) != 0 || page->page_id_ != page_id) {
+    return nullptr;
+  }
   return page;
 }
 
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
-  latch_.lock();
   frame_id_t frame_id;
-  // LOG_DEBUG("Enter unpin page function");
-  bool in = (page_table_->Find(page_id,frame_id));
-  // LOG_DEBUG("Successfully found?");
-  if(!in || (in && pages_[frame_id].GetPinCount() <= 0)){
-    // LOG_DEBUG("Page not found or doesn't get any threads to pin");
-    latch_.unlock();
+  if (!page_table_->Find(page_id, frame_id)) {
     return false;
   }
-  pages_[frame_id].pin_count_--;
-  if(is_dirty){
-    // LOG_DEBUG("Set dirty bits by is_dirty");
-    pages_[frame_id].is_dirty_ = true;
+  Page *page = &pages_[frame_id];
+  if (page->page_id_ != page_id) {
+    return false;
   }
-  if(pages_[frame_id].GetPinCount() == 0){
-    // the page is evictable by the replacer
-    // LOG_DEBUG("Pin count equals to zero, set evictable");
-    replacer_->SetEvictable(frame_id,true);
-    if(pages_[frame_id].is_dirty_){
-      disk_manager_->WritePage(page_id,pages_[frame_id].GetData());
+  // Set the dirty bit before dropping the pin, so that whoever reclaims the frame next sees it.
+  if (is_dirty) {
+    page->is_dirty_ = true;
+  }
+  int pin_count = page->pin_count_;
+  do {
+    if (pin_count <= 0) {
+      return false;
     }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (pin_count == 1) {
+    // The page is evictable now. A dirty page is written back later by the page cleaner or on eviction.
+    replacer_->SetEvictable(frame_id, true);
   }
-  latch_.unlock();
   return true;
 }
 
-auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool { 
+auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
   assert(page_id != INVALID_PAGE_ID);
-  latch_.lock();
-  // LOG_DEBUG("Enter flush page function");
+  std::unique_lock<std::mutex> lock(latch_);
   frame_id_t frame_id;
-  bool in = (page_table_->Find(page_id,frame_id));
-  if(!in){
-    // LOG_DEBUG("The page doesn't exist");
-    latch_.unlock();
-    return false;
-  } 
-  if(frame_id == INVALID_PAGE_ID){
-    // LOG_DEBUG("The page is invalid");
-    latch_.unlock();
-    return false;
+  while (page_table_->Find(page_id, frame_id)) {
+    auto &io = frame_io_[frame_id];
+    if (io.io_in_progress_ || io.cleaning_) {
+      // The page is still being loaded, or the page cleaner is writing an older copy of it that must not land after
+      // ours. The frame may be reused by the time we wake up, so look it up again.
+      io.io_done_.wait(lock, [&io] { return !io.io_in_progress_ && !io.cleaning_; });
+      continue;
+    }
+    // Pin the frame and mark it as being written, like the page cleaner does, so that the write can run without the
+    // latch: the frame is not evicted meanwhile, and other flushes of the page wait for this one.
+    Page *page = &pages_[frame_id];
+    page->pin_count_++;
+    replacer_->SetEvictable(frame_id, false);
+    io.cleaning_ = true;
+    // AcquireFrame waits for the frames being cleaned, so only a pin that is let go of without waiting on anything
+    // counts as one. If the page latch is held, its holder may be the one waiting in AcquireFrame: the pin then counts
+    // as an ordinary one while waiting for the latch.
+    bool counted = page->TryRLatch();
+    if (counted) {
+      frames_being_cleaned_++;
+    }
+    lock.unlock();
+
+    if (!counted) {
+      page->RLatch();
+    }
+    // Clear the dirty bit first: a thread that modifies the page while it is written sets it again when it unpins.
+    page->is_dirty_ = false;
+    disk_manager_->WritePage(page_id, page->GetData());
+    page->RUnlatch();
+
+    lock.lock();
+    io.cleaning_ = false;
+    io.io_done_.notify_all();
+    if (counted) {
+      frames_being_cleaned_--;
+      cleaning_done_.notify_all();
+    }
+    ReleasePin(frame_id);
+    return true;
   }
-  // LOG_DEBUG("Flush the page");
-  disk_manager_->WritePage(page_id,pages_[frame_id].GetData());
-  pages_[frame_id].is_dirty_ = false;
-  // for(auto it = page_table_.begin();it != page_table_.end();it++){
-  //   if((*it).second == frame_id){
-  //     page_table_.erase(it);
-  //     break;
-  //   }
-  // }
-  latch_.unlock();
-  return true; 
+  return false;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
   for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
-    FlushPgImp(pages_[frame_id].GetPageId());
+    page_id_t page_id;
+    {
+      std::scoped_lock lock(latch_);
+      page_id = pages_[frame_id].GetPageId();
+    }
+    if (page_id != INVALID_PAGE_ID) {
+      FlushPgImp(page_id);
+    }
   }
+  disk_manager_->Sync();
 }
 
-auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool { 
-  latch_.lock();
-  // LOG_DEBUG("Enter delete page function");
+auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
   frame_id_t frame_id;
-  bool in = (page_table_->Find(page_id,frame_id));
-  if(!in){
-    // LOG_DEBUG("The page doesn't exist, return true");
-    latch_.unlock();
+  while (page_table_->Find(page_id, frame_id)) {
+    Page *page = &pages_[frame_id];
+    int unpinned = 0;
+    if (!page->pin_count_.compare_exchange_strong(unpinned, -1)) {
+      if (frames_being_cleaned_ == 0) {
+        return false;
+      }
+      // The pin may belong to the page cleaner, which lets go of its batch shortly.
+      cleaning_done_.wait(lock);
+      continue;
+    }
+    page_table_->Remove(page_id);
+    // The evictable flag in the replacer can lag behind the pin count, see AcquireFrame.
+    replacer_->SetEvictable(frame_id, true);
+    replacer_->Remove(frame_id);
+    page->BeginWrite();
+    page->ResetMemory();
+    page->page_id_ = INVALID_PAGE_ID;
+    page->is_dirty_ = false;
+    page->EndWrite();
+    free_list_.push_back(frame_id);
+    DeallocatePage(page_id);
     return true;
   }
-  if(pages_[page_id].GetPinCount() > 0){
-    // LOG_DEBUG("The page is pinned, return false");
-    latch_.unlock();
+  return true;
+}
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type) {
+  if (!enable_prefetch) {
+    return;
+  }
+  std::scoped_lock lock(latch_);
+  for (auto page_id : page_ids) {
+    EnqueuePrefetch({page_id, 1, nullptr, access_type});
+  }
+}
+
+void BufferPoolManagerInstance::PrefetchChain(page_id_t page_id, size_t count, next_page_fn next_page,
+                                              AccessType access_type) {
+  if (!enable_prefetch || page_id == INVALID_PAGE_ID || count == 0) {
+    return;
+  }
+  if (access_type == AccessType::Scan) {
+    count = std::min(count, std::max<size_t>(1, scan_ring_.size() / 2));
+  }
+  std::scoped_lock lock(latch_);
+  EnqueuePrefetch({page_id, count, count > 1 ? next_page : nullptr, access_type});
+}
+
+void BufferPoolManagerInstance::StopPrefetcher() {
+  {
+    std::scoped_lock lock(latch_);
+    stop_prefetcher_ = true;
+    prefetch_queue_.clear();
+  }
+  prefetch_cv_.notify_one();
+  if (prefetcher_.joinable()) {
+    prefetcher_.join();
+  }
+}
+
+auto BufferPoolManagerInstance::GetDirtyPageCount() -> size_t {
+  std::scoped_lock lock(latch_);
+  size_t dirty_pages = 0;
+  for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
+    if (pages_[frame_id].GetPageId() != INVALID_PAGE_ID && pages_[frame_id].IsDirty()) {
+      dirty_pages++;
+    }
+  }
+  return dirty_pages;
+}
+
+auto BufferPoolManagerInstance::AcquireFrame(std::unique_lock<std::mutex> *lock, frame_id_t *frame_id,
+                                             page_id_t *victim_page_id, AccessType access_type) -> bool {
+  *victim_page_id = INVALID_PAGE_ID;
+  const bool scan = access_type == AccessType::Scan;
+  const size_t ring_slot = scan_ring_next_;
+  if (scan) {
+    scan_ring_next_ = (scan_ring_next_ + 1) % scan_ring_.size();
+  }
+
+  if (scan && ReuseScanRingFrame(ring_slot, frame_id)) {
+    // The frame stays in its slot of the ring.
+  } else if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+  } else {
+    while (true) {
+      if (!replacer_->Evict(frame_id)) {
+        if (frames_being_cleaned_ == 0) {
+          return false;
+        }
+        cleaning_done_.wait(*lock);
+        continue;
+      }
+
+      // Claim the frame, so that lock-free fetches can no longer pin it.
+      Page *victim = &pages_[*frame_id];
+      int unpinned = 0;
+      if (victim->pin_count_.compare_exchange_strong(unpinned, -1)) {
+        break;
+      }
+      // A fetch pinned the frame without the latch after the replacer picked it. Give the frame its access history
+      // back and try another victim. If the pin is already gone again, its SetEvictable(true) may have been lost in
+      // between.
+      replacer_->RecordAccess(*frame_id);
+      if (victim->pin_count_ == 0) {
+        replacer_->SetEvictable(*frame_id, true);
+      }
+    }
+  }
+
+  if (scan) {
+    // The frame that held the slot before, if it could not be reused, goes back to being an ordinary frame.
+    const frame_id_t old_frame = scan_ring_[ring_slot];
+    if (old_frame >= 0 && frame_io_[old_frame].scan_ring_slot_ == static_cast<int>(ring_slot)) {
+      frame_io_[old_frame].scan_ring_slot_ = -1;
+    }
+    scan_ring_[ring_slot] = *frame_id;
+    frame_io_[*frame_id].scan_ring_slot_ = static_cast<int>(ring_slot);
+  } else {
+    frame_io_[*frame_id].scan_ring_slot_ = -1;
+  }
+
+  Page *victim = &pages_[*frame_id];
+  if (victim->page_id_ == INVALID_PAGE_ID) {
+    return true;
+  }
+  page_table_->Remove(victim->page_id_);
+  if (victim->IsDirty()) {
+    // The page cleaner fell behind, so this thread pays for the write-back. Ask the cleaner to catch up.
+    *victim_page_id = victim->page_id_;
+    writing_back_[*victim_page_id] = *frame_id;
+    sync_write_evictions_++;
+    page_cleaner_cv_.notify_one();
+  }
+  return true;
+}
+
+auto BufferPoolManagerInstance::ReuseScanRingFrame(size_t ring_slot, frame_id_t *frame_id) -> bool {
+  const frame_id_t ring_frame = scan_ring_[ring_slot];
+  if (ring_frame < 0 || frame_io_[ring_frame].scan_ring_slot_ != static_cast<int>(ring_slot)) {
     return false;
   }
-  // LOG_DEBUG("The page exists and not pinned, ready to delete");
-  page_table_->Remove(page_id);
-  pages_[frame_id].ResetMemory();
-  free_list_.push_back(frame_id);
-  DeallocatePage(page_id);
-  latch_.unlock();
-  return true; 
+  int unpinned = 0;
+  if (!pages_[ring_frame].pin_count_.compare_exchange_strong(unpinned, -1)) {
+    return false;
+  }
+  // The frame is unpinned, but the replacer may not have heard of it yet, see the claim in AcquireFrame.
+  replacer_->SetEvictable(ring_frame, true);
+  replacer_->Remove(ring_frame);
+  *frame_id = ring_frame;
+  return true;
+}
+
+auto BufferPoolManagerInstance::TryPinResident(frame_id_t frame_id, page_id_t page_id) -> bool {
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_;
+  do {
+    if (pin_count < 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+
+  // The frame may have been evicted and reused between the page table lookup and the pin.
+  if (page->page_id_ != page_id) {
+    ReleasePin(frame_id);
+    return false;
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::RecordHit(frame_id_t frame_id, AccessType access_type) {
+  auto &ring_slot = frame_io_[frame_id].scan_ring_slot_;
+  if (access_type == AccessType::Scan && ring_slot >= 0) {
+    replacer_->SetEvictable(frame_id, false);
+    return;
+  }
+  if (ring_slot >= 0) {
+    ring_slot = -1;
+  }
+  replacer_->RecordAccess(frame_id);
+  replacer_->SetEvictable(frame_id, false);
+}
+
+void BufferPoolManagerInstance::ReleasePin(frame_id_t frame_id) {
+  if (pages_[frame_id].pin_count_.fetch_sub(1) == 1) {
+    replacer_->SetEvictable(frame_id, true);
+  }
+}
+
+void BufferPoolManagerInstance::InstallPage(frame_id_t frame_id, page_id_t page_id, bool is_dirty) {
+  Page *page = &pages_[frame_id];
+  // The frame's old contents are about to go away. Optimistic readers still looking at them must notice, see
+  // FetchPageOptimistic. The version becomes even again once the I/O is done.
+  page->BeginWrite();
+  // Everything a lock-free fetch checks is set before the pin count leaves -1 and the page shows up in the page table.
+  frame_io_[frame_id].io_in_progress_ = true;
+  page->page_id_ = page_id;
+  page->is_dirty_ = is_dirty;
+  page->pin_count_ = 1;
+  replacer_->RecordAccess(frame_id);
+  replacer_->SetEvictable(frame_id, false);
+  page_table_->Insert(page_id, frame_id);
+}
+
+void BufferPoolManagerInstance::DoFrameIo(std::unique_lock<std::mutex> *lock, frame_id_t frame_id,
+                                          page_id_t victim_page_id, page_id_t page_id, bool read_page) {
+  Page *page = &pages_[frame_id];
+  lock->unlock();
+
+  // Nobody else touches the frame memory here: the frame is pinned, and every thread that finds it in the page table
+  // waits for io_in_progress_ to be cleared.
+  if (victim_page_id != INVALID_PAGE_ID) {
+    disk_manager_->WritePage(victim_page_id, page->GetData());
+  }
+  page->ResetMemory();
+  if (read_page) {
+    disk_manager_->ReadPage(page_id, page->data_);
+  }
+
+  lock->lock();
+  if (victim_page_id != INVALID_PAGE_ID) {
+    writing_back_.erase(victim_page_id);
+  }
+  page->EndWrite();
+  frame_io_[frame_id].io_in_progress_ = false;
+  frame_io_[frame_id].io_done_.notify_all();
+}
+
+void BufferPoolManagerInstance::WaitForFrameIo(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+  auto &io = frame_io_[frame_id];
+  io.io_done_.wait(*lock, [&io] { return !io.io_in_progress_; });
+}
+
+void BufferPoolManagerInstance::EnqueuePrefetch(const PrefetchRequest &request) {
+  frame_id_t frame_id;
+  if (stop_prefetcher_ || prefetch_queue_.size() >= prefetch_queue_limit_) {
+    return;
+  }
+  // A resident page only needs the prefetcher if the chain goes on from it.
+  if (request.next_page_ == nullptr && page_table_->Find(request.page_id_, frame_id)) {
+    return;
+  }
+  prefetch_queue_.push_back(request);
+  prefetch_cv_.notify_one();
+}
+
+auto BufferPoolManagerInstance::LoadPrefetchedPage(std::unique_lock<std::mutex> *lock, const PrefetchRequest &request,
+                                                   frame_id_t *frame_id) -> bool {
+  if (page_table_->Find(request.page_id_, *frame_id)) {
+    // Already in memory, or being loaded by a fetch. Pin it without recording an access, since nobody used it yet.
+    pages_[*frame_id].pin_count_++;
+    replacer_->SetEvictable(*frame_id, false);
+    WaitForFrameIo(lock, *frame_id);
+    return true;
+  }
+  if (writing_back_.count(request.page_id_) > 0) {
+    return false;
+  }
+
+  page_id_t victim_page_id;
+  if (!AcquireFrame(lock, frame_id, &victim_page_id, request.access_type_)) {
+    return false;
+  }
+  InstallPage(*frame_id, request.page_id_, false);
+  DoFrameIo(lock, *frame_id, victim_page_id, request.page_id_, true);
+  pages_prefetched_++;
+  return true;
+}
+
+void BufferPoolManagerInstance::LoadPrefetchedPages(std::unique_lock<std::mutex> *lock,
+                                                    std::vector<PrefetchRequest> *requests) {
+  while (!prefetch_queue_.empty() && prefetch_queue_.front().next_page_ == nullptr) {
+    requests->push_back(prefetch_queue_.front());
+    prefetch_queue_.pop_front();
+  }
+
+  struct Load {
+    frame_id_t frame_id_;
+    page_id_t victim_page_id_;
+    page_id_t page_id_;
+  };
+  std::vector<Load> loads;
+  loads.reserve(requests->size());
+  for (const auto &request : *requests) {
+    frame_id_t frame_id;
+    page_id_t victim_page_id;
+    if (page_table_->Find(request.page_id_, frame_id) || writing_back_.count(request.page_id_) > 0) {
+      continue;
+    }
+    if (!AcquireFrame(lock, &frame_id, &victim_page_id, request.access_type_)) {
+      break;
+    }
+    InstallPage(frame_id, request.page_id_, false);
+    loads.push_back({frame_id, victim_page_id, request.page_id_});
+  }
+  if (loads.empty()) {
+    return;
+  }
+  lock->unlock();
+
+  // Like DoFrameIo, for all the frames at once: the victims have to be on disk before their frames are overwritten.
+  std::vector<std::future<bool>> ios;
+  ios.reserve(loads.size());
+  for (const auto &load : loads) {
+    if (load.victim_page_id_ != INVALID_PAGE_ID) {
+      ios.push_back(disk_manager_->WritePageAsync(load.victim_page_id_, pages_[load.frame_id_].GetData()));
+    }
+  }
+  for (auto &io : ios) {
+    io.wait();
+  }
+  ios.clear();
+  for (const auto &load : loads) {
+    pages_[load.frame_id_].ResetMemory();
+    ios.push_back(disk_manager_->ReadPageAsync(load.page_id_, pages_[load.frame_id_].data_));
+  }
+  for (auto &io : ios) {
+    io.wait();
+  }
+
+  lock->lock();
+  for (const auto &load : loads) {
+    if (load.victim_page_id_ != INVALID_PAGE_ID) {
+      writing_back_.erase(load.victim_page_id_);
+    }
+    pages_[load.frame_id_].EndWrite();
+    frame_io_[load.frame_id_].io_in_progress_ = false;
+    frame_io_[load.frame_id_].io_done_.notify_all();
+    ReleasePin(load.frame_id_);
+  }
+  pages_prefetched_ += loads.size();
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+void BufferPoolManagerInstance::RunPrefetcher() {
+  std::unique_lock<std::mutex> lock(latch_);
+  std::vector<PrefetchRequest> single_pages;
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return stop_prefetcher_ || !prefetch_queue_.empty(); });
+    if (stop_prefetcher_) {
+      return;
+    }
+    PrefetchRequest request = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+
+    if (request.next_page_ == nullptr) {
+      single_pages.clear();
+      single_pages.push_back(request);
+      LoadPrefetchedPages(&lock, &single_pages);
+      continue;
+    }
+    frame_id_t frame_id;
+    if (!LoadPrefetchedPage(&lock, request, &frame_id)) {
+      continue;
+    }
+
+    // The rest of the chain may start in another instance of a parallel buffer pool, so do not hold the latch.
+    lock.unlock();
+    Page *page = &pages_[frame_id];
+    page->RLatch();
+    page_id_t next_page_id = request.next_page_(page);
+    page->RUnlatch();
+    ReleasePin(frame_id);
+    prefetch_router_->PrefetchChain(next_page_id, request.count_ - 1, request.next_page_, request.access_type_);
+    lock.lock();
+  }
+}
+
+void BufferPoolManagerInstance::RunPageCleaner() {
+  std::unique_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> batch;
+  std::vector<page_id_t> batch_page_ids;
+  batch.reserve(PAGE_CLEANER_BATCH_SIZE);
+  batch_page_ids.reserve(PAGE_CLEANER_BATCH_SIZE);
+  std::vector<char> copies(PAGE_CLEANER_BATCH_SIZE * BUSTUB_PAGE_SIZE);
+  std::vector<std::future<bool>> writes;
+  writes.reserve(PAGE_CLEANER_BATCH_SIZE);
+
+  while (true) {
+    page_cleaner_cv_.wait_for(lock, page_cleaner_interval);
+    if (stop_page_cleaner_) {
+      return;
+    }
+
+    // Count the frames an eviction could take right away, and pick dirty unpinned frames to clean.
+    size_t ready_frames = free_list_.size();
+    batch.clear();
+    for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
+      Page *page = &pages_[frame_id];
+      if (page->GetPageId() == INVALID_PAGE_ID || page->pin_count_ != 0) {
+        continue;
+      }
+      if (!page->IsDirty()) {
+        ready_frames++;
+      } else if (batch.size() < static_cast<size_t>(PAGE_CLEANER_BATCH_SIZE)) {
+        batch.push_back(static_cast<frame_id_t>(frame_id));
+      }
+    }
+    if (ready_frames >= clean_frame_target_ || batch.empty()) {
+      continue;
+    }
+    // Pages can be pinned without the latch, so pin the batch for real and drop the frames that are in use now. A
+    // thread that pinned a page that way may be modifying it, so the page is copied under its read latch. Waiting for
+    // that latch could deadlock: its holder may be waiting in AcquireFrame for this batch to be released. So pages
+    // whose latch is taken are skipped, they are cleaned another time.
+    batch.erase(std::remove_if(batch.begin(), batch.end(),
+                               [this](frame_id_t frame_id) {
+                                 Page *page = &pages_[frame_id];
+                                 int unpinned = 0;
+                                 if (!page->pin_count_.compare_exchange_strong(unpinned, 1)) {
+                                   return true;
+                                 }
+                                 if (!page->TryRLatch()) {
+                                   ReleasePin(frame_id);
+                                   return true;
+                                 }
+                                 return false;
+                               }),
+                batch.end());
+
+    // The batch is pinned, so it is not evicted while the copies are written.
+    batch_page_ids.clear();
+    for (auto frame_id : batch) {
+      batch_page_ids.push_back(pages_[frame_id].GetPageId());
+      replacer_->SetEvictable(frame_id, false);
+      frame_io_[frame_id].cleaning_ = true;
+    }
+    frames_being_cleaned_ += batch.size();
+    lock.unlock();
+
+    // Whoever modifies a page after the copy marks it dirty again when it unpins, so clear the bit before the copy.
+    for (size_t i = 0; i < batch.size(); i++) {
+      Page *page = &pages_[batch[i]];
+      page->is_dirty_ = false;
+      memcpy(&copies[i * BUSTUB_PAGE_SIZE], page->GetData(), BUSTUB_PAGE_SIZE);
+      page->RUnlatch();
+    }
+
+    // Put the whole batch in flight at once, for disk managers that do asynchronous I/O.
+    writes.clear();
+    for (size_t i = 0; i < batch.size(); i++) {
+      writes.push_back(disk_manager_->WritePageAsync(batch_page_ids[i], &copies[i * BUSTUB_PAGE_SIZE]));
+    }
+    for (size_t i = 0; i < batch.size(); i++) {
+      if (!writes[i].get()) {
+        // The page is still pinned by us, so it is the same page; keep it dirty so that it is written again.
+        pages_[batch[i]].is_dirty_ = true;
+      }
+    }
+
+    lock.lock();
+    for (auto frame_id : batch) {
+      ReleasePin(frame_id);
+      frame_io_[frame_id].cleaning_ = false;
+      frame_io_[frame_id].io_done_.notify_all();
+    }
+    frames_being_cleaned_ -= batch.size();
+    pages_cleaned_ += batch.size();
+    cleaning_done_.notify_all();
+  }
+}
+
+auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
+  const page_id_t next_page_id = next_page_id_.fetch_add(static_cast<page_id_t>(num_instances_));
+  ValidatePageId(next_page_id);
+  return next_page_id;
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+}
 
 }  // namespace bustub
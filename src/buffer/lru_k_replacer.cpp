@@ -14,119 +14,81 @@
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k), frames_(num_frames) {}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   std::scoped_lock<std::mutex> lock(latch_);
 
-  if (curr_size_ == 0) {
+  // Frames with +inf backward k-distance go first.
+  FrameList *list = history_list_.head_ != INVALID_FRAME_ID ? &history_list_ : &cache_list_;
+  if (list->head_ == INVALID_FRAME_ID) {
     return false;
   }
 
-  for (auto it = history_list_.rbegin(); it != history_list_.rend(); it++) {
-    auto frame = *it;
-    if (is_evictable_[frame]) {
-      access_count_[frame] = 0;
-      history_list_.erase(history_map_[frame]);
-      history_map_.erase(frame);
-      *frame_id = frame;
-      curr_size_--;
-      is_evictable_[frame] = false;
-      return true;
-    }
-  }
-
-  for (auto it = cache_list_.rbegin(); it != cache_list_.rend(); it++) {
-    auto frame = *it;
-    if (is_evictable_[frame]) {
-      access_count_[frame] = 0;
-      cache_list_.erase(cache_map_[frame]);
-      cache_map_.erase(frame);
-      *frame_id = frame;
-      curr_size_--;
-      is_evictable_[frame] = false;
-      return true;
-    }
-  }
-
-  return false;
+  auto frame = list->head_;
+  Unlink(list, frame);
+  frames_[frame].access_count_ = 0;
+  frames_[frame].evictable_ = false;
+  curr_size_--;
+  *frame_id = frame;
+  return true;
 }
 
 void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
   std::scoped_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
 
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::exception();
+  auto &entry = frames_[frame_id];
+  if (!entry.evictable_) {
+    entry.access_count_++;
+    return;
   }
 
-  access_count_[frame_id]++;
-
-  if (access_count_[frame_id] == k_) {
-    auto it = history_map_[frame_id];
-    history_list_.erase(it);
-    history_map_.erase(frame_id);
-
-    cache_list_.push_front(frame_id);
-    cache_map_[frame_id] = cache_list_.begin();
-  } else if (access_count_[frame_id] > k_) {
-    if (cache_map_.count(frame_id) != 0U) {
-      auto it = cache_map_[frame_id];
-      cache_list_.erase(it);
-    }
-    cache_list_.push_front(frame_id);
-    cache_map_[frame_id] = cache_list_.begin();
-  } else {
-    if (history_map_.count(frame_id) == 0U) {
-      history_list_.push_front(frame_id);
-      history_map_[frame_id] = history_list_.begin();
-    }
+  // The history list is ordered by first access, so only a frame reaching k accesses moves. Cache frames move to the
+  // most recent end on every access.
+  auto *list = ListOf(frame_id);
+  entry.access_count_++;
+  if (list == &history_list_ && entry.access_count_ < k_) {
+    return;
   }
+  Unlink(list, frame_id);
+  PushBack(&cache_list_, frame_id);
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::exception();
-  }
+  CheckFrameId(frame_id);
 
-  if (access_count_[frame_id] == 0) {
+  auto &entry = frames_[frame_id];
+  if (entry.access_count_ == 0 || entry.evictable_ == set_evictable) {
     return;
   }
 
-  if (!is_evictable_[frame_id] && set_evictable) {
+  if (set_evictable) {
+    PushBack(ListOf(frame_id), frame_id);
     curr_size_++;
-  }
-  if (is_evictable_[frame_id] && !set_evictable) {
+  } else {
+    Unlink(ListOf(frame_id), frame_id);
     curr_size_--;
   }
-  is_evictable_[frame_id] = set_evictable;
+  entry.evictable_ = set_evictable;
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::scoped_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
 
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::exception();
-  }
-
-  auto cnt = access_count_[frame_id];
-  if (cnt == 0) {
+  auto &entry = frames_[frame_id];
+  if (entry.access_count_ == 0) {
     return;
   }
-  if (!is_evictable_[frame_id]) {
+  if (!entry.evictable_) {
     throw std::exception();
   }
-  if (cnt < k_) {
-    history_list_.erase(history_map_[frame_id]);
-    history_map_.erase(frame_id);
-
-  } else {
-    cache_list_.erase(cache_map_[frame_id]);
-    cache_map_.erase(frame_id);
-  }
+  Unlink(ListOf(frame_id), frame_id);
   curr_size_--;
-  access_count_[frame_id] = 0;
-  is_evictable_[frame_id] = false;
+  entry.access_count_ = 0;
+  entry.evictable_ = false;
 }
 
 auto LRUKReplacer::Size() -> size_t {
@@ -134,4 +96,38 @@ auto LRUKReplacer::Size() -> size_t {
   return curr_size_;
 }
 
-}  // namespace bustub
\ No newline at end of file
+void LRUKReplacer::PushBack(FrameList *list, frame_id_t frame_id) {
+  auto &entry = frames_[frame_id];
+  entry.prev_ = list->tail_;
+  entry.next_ = INVALID_FRAME_ID;
+  if (list->tail_ == INVALID_FRAME_ID) {
+    list->head_ = frame_id;
+  } else {
+    frames_[list->tail_].next_ = frame_id;
+  }
+  list->tail_ = frame_id;
+}
+
+void LRUKReplacer::Unlink(FrameList *list, frame_id_t frame_id) {
+  auto &entry = frames_[frame_id];
+  if (entry.prev_ == INVALID_FRAME_ID) {
+    list->head_ = entry.next_;
+  } else {
+    frames_[entry.prev_].next_ = entry.next_;
+  }
+  if (entry.next_ == INVALID_FRAME_ID) {
+    list->tail_ = entry.prev_;
+  } else {
+    frames_[entry.next_].prev_ = entry.prev_;
+  }
+  entry.prev_ = INVALID_FRAME_ID;
+  entry.next_ = INVALID_FRAME_ID;
+}
+
+void LRUKReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw std::exception();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     size_t replacer_k, LogManager *log_manager)
+    : num_instances_(num_instances), instance_pool_size_(pool_size) {
+  BUSTUB_ASSERT(num_instances > 0, "A parallel buffer pool needs at least one instance");
+  // Allocate and create individual BufferPoolManagerInstances
+  instances_.reserve(num_instances_);
+  for (size_t i = 0; i < num_instances_; i++) {
+    instances_.push_back(new BufferPoolManagerInstance(pool_size, static_cast<uint32_t>(num_instances_),
+                                                       static_cast<uint32_t>(i), disk_manager, replacer_k,
+                                                       log_manager));
+    instances_.back()->SetPrefetchRouter(this);
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  // The prefetcher of one instance may hand a chain to any other instance, so stop all of them before deleting any.
+  for (auto *instance : instances_) {
+    instance->StopPrefetcher();
+  }
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance * {
+  BUSTUB_ASSERT(page_id >= 0, "Cannot route an invalid page id");
+  return instances_[static_cast<size_t>(page_id) % num_instances_];
+}
+
+auto ParallelBufferPoolManager::GetDirtyPageCount() -> size_t {
+  size_t dirty_pages = 0;
+  for (auto *instance : instances_) {
+    dirty_pages += instance->GetDirtyPageCount();
+  }
+  return dirty_pages;
+}
+
+auto ParallelBufferPoolManager::GetPagesCleaned() const -> size_t {
+  size_t pages_cleaned = 0;
+  for (auto *instance : instances_) {
+    pages_cleaned += instance->GetPagesCleaned();
+  }
+  return pages_cleaned;
+}
+
+auto ParallelBufferPoolManager::GetSyncWriteEvictions() const -> size_t {
+  size_t sync_write_evictions = 0;
+  for (auto *instance : instances_) {
+    sync_write_evictions += instance->GetSyncWriteEvictions();
+  }
+  return sync_write_evictions;
+}
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type) {
+  std::vector<std::vector<page_id_t>> instance_page_ids(num_instances_);
+  for (auto page_id : page_ids) {
+    instance_page_ids[static_cast<size_t>(page_id) % num_instances_].push_back(page_id);
+  }
+  for (size_t i = 0; i < num_instances_; i++) {
+    if (!instance_page_ids[i].empty()) {
+      instances_[i]->PrefetchPages(instance_page_ids[i], access_type);
+    }
+  }
+}
+
+void ParallelBufferPoolManager::PrefetchChain(page_id_t page_id, size_t count, next_page_fn next_page,
+                                              AccessType access_type) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  GetBufferPoolManager(page_id)->PrefetchChain(page_id, count, next_page, access_type);
+}
+
+auto ParallelBufferPoolManager::FetchPageOptimistic(page_id_t page_id, uint64_t *version) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPageOptimistic(page_id, version);
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
+  // Starting index rotates on every call so that allocation is spread evenly over the instances. Try each instance
+  // once; the first one that has a free or evictable frame wins.
+  const size_t start = next_instance_.fetch_add(1) % num_instances_;
+  for (size_t i = 0; i < num_instances_; i++) {
+    auto *page = instances_[(start + i) % num_instances_]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPgsImp() {
+  for (auto *instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+}  // namespace bustub
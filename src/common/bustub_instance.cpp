@@ -12,6 +12,7 @@
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/bustub_instance.h"
@@ -25,6 +26,7 @@
 #include "execution/executors/mock_scan_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/worker_pool.h"
 #include "fmt/core.h"
 #include "fmt/format.h"
 #include "optimizer/optimizer.h"
@@ -33,27 +35,44 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_uring.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
+/** @return the number of bytes a key on key_schema needs, with every VARCHAR as long as it is declared */
+static auto KeyWidth(const Schema &key_schema) -> uint32_t {
+  uint32_t width = key_schema.GetLength();
+  for (auto idx : key_schema.GetUnlinedColumns()) {
+    // length prefix, characters and the terminating zero
+    width += sizeof(uint32_t) + key_schema.GetColumn(idx).GetVariableLength() + 1;
+  }
+  return width;
+}
+
 auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext> {
-  return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
+  return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_,
+                                           worker_pool_, GetParallelism());
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+BustubInstance::BustubInstance(const std::string &db_file_name, size_t bpm_instances) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  disk_manager_ = new DiskManagerUring(db_file_name);
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // buffer pool size specified in `config.h`. With several shards, each shard gets 128 frames.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    if (bpm_instances > 1) {
+      buffer_pool_manager_ =
+          new ParallelBufferPoolManager(bpm_instances, 128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    } else {
+      buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    }
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -71,9 +90,10 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
 
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
+  worker_pool_ = new WorkerPool();
 }
 
-BustubInstance::BustubInstance() {
+BustubInstance::BustubInstance(size_t bpm_instances) {
   enable_logging = false;
 
   // Storage related.
@@ -83,9 +103,14 @@ BustubInstance::BustubInstance() {
   log_manager_ = new LogManager(disk_manager_);
 
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // buffer pool size specified in `config.h`. With several shards, each shard gets 128 frames.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    if (bpm_instances > 1) {
+      buffer_pool_manager_ =
+          new ParallelBufferPoolManager(bpm_instances, 128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    } else {
+      buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    }
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -103,6 +128,7 @@ BustubInstance::BustubInstance() {
 
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
+  worker_pool_ = new WorkerPool();
 }
 
 void BustubInstance::CmdDisplayTables(ResultWriter &writer) {
@@ -174,7 +200,15 @@ see the execution plan of your query.
 
 auto BustubInstance::ExecuteSql(const std::string &sql, ResultWriter &writer) -> bool {
   auto txn = txn_manager_->Begin();
-  auto result = ExecuteSqlTxn(sql, writer, txn);
+  bool result;
+  try {
+    result = ExecuteSqlTxn(sql, writer, txn);
+  } catch (...) {
+    // A statement that fails leaves nothing behind, not even its transaction
+    txn_manager_->Abort(txn);
+    delete txn;
+    throw;
+  }
   txn_manager_->Commit(txn);
   delete txn;
   return result;
@@ -228,19 +262,35 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         for (const auto &col : index_stmt.cols_) {
           auto idx = index_stmt.table_->schema_.GetColIdx(col->col_name_.back());
           col_ids.push_back(idx);
-          if (index_stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
-            throw NotImplementedException("only support creating index on integer column");
-          }
-        }
-        if (col_ids.size() != 1) {
-          throw NotImplementedException("only support creating index with exactly one column");
         }
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
 
+        // use the narrowest key the key columns fit into
+        auto create_index = [&](auto key) {
+          using KeyType = decltype(key);
+          return catalog_->CreateIndex<KeyType, RID, GenericComparator<sizeof(KeyType)>>(
+              txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
+              sizeof(KeyType), HashFunction<KeyType>{}, index_stmt.compressed_,
+              index_stmt.index_type_ == "hash" ? IndexType::HashTableIndex : IndexType::BPlusTreeIndex);
+        };
+        auto width = KeyWidth(key_schema);
+        if (width > 64) {
+          throw NotImplementedException(fmt::format("index keys of {} bytes are wider than 64 bytes", width));
+        }
+
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
-        auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-            txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
+        IndexInfo *info;
+        if (width <= 4) {
+          info = create_index(GenericKey<4>{});
+        } else if (width <= 8) {
+          info = create_index(GenericKey<8>{});
+        } else if (width <= 16) {
+          info = create_index(GenericKey<16>{});
+        } else if (width <= 32) {
+          info = create_index(GenericKey<32>{});
+        } else {
+          info = create_index(GenericKey<64>{});
+        }
         l.unlock();
 
         if (info == nullptr) {
@@ -391,6 +441,11 @@ BustubInstance::~BustubInstance() {
   if (enable_logging) {
     log_manager_->StopFlushThread();
   }
+  // Dirty pages are only written back lazily, so write them out while the disk manager is still around.
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_manager_->FlushAllPages();
+  }
+  delete worker_pool_;
   delete execution_engine_;
   delete catalog_;
   delete checkpoint_manager_;
@@ -16,8 +16,12 @@ namespace bustub {
 
 std::atomic<bool> enable_logging(false);
 
+std::atomic<bool> enable_prefetch(true);
+
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds page_cleaner_interval = std::chrono::milliseconds(10);
+
 }  // namespace bustub
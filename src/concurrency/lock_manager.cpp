@@ -492,6 +492,7 @@ void LockManager::RunCycleDetection() {
           }
         }
         pair.second->latch_.unlock();
+      }
       for (auto &pair : row_lock_map_) {
         std::unordered_set<txn_id_t> granted_set;
         pair.second->latch_.lock();
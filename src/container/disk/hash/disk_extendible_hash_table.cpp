@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -26,7 +27,25 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                          const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+  // the table starts with a single bucket that every key maps to
+  Page *page = buffer_pool_manager_->NewPage(&directory_page_id_, nullptr);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+  }
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  dir_page->SetPageId(directory_page_id_);
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  Page *bucket_page = buffer_pool_manager_->NewPage(&bucket_page_id, nullptr);
+  if (bucket_page == nullptr) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
+    buffer_pool_manager_->DeletePage(directory_page_id_, nullptr);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+  }
+  reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_page->GetData())->Init();
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true, nullptr);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true, nullptr);
 }
 
 /*****************************************************************************
@@ -46,22 +65,147 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  return 0;
+  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_, nullptr);
+  return page == nullptr ? nullptr : reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id, nullptr);
+  return page == nullptr ? nullptr : reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ReleaseAndThrow(bool write_locked, bool directory_pinned, bool directory_dirty) {
+  if (directory_pinned) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, directory_dirty, nullptr);
+  }
+  if (write_locked) {
+    table_latch_.WUnlock();
+  } else {
+    table_latch_.RUnlock();
+  }
+  throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page, the buffer pool is full");
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::GetOverflowValues(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key,
+                                        std::vector<ValueType> *result) -> bool {
+  page_id_t overflow_page_id = bucket_page->GetOverflowPageId();
+  while (overflow_page_id != INVALID_PAGE_ID) {
+    HASH_TABLE_BUCKET_TYPE *overflow_page = FetchBucketPage(overflow_page_id);
+    if (overflow_page == nullptr) {
+      return false;
+    }
+    overflow_page->GetValue(key, comparator_, result);
+    page_id_t next_page_id = overflow_page->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(overflow_page_id, false, nullptr);
+    overflow_page_id = next_page_id;
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::InsertOverflow(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key, const ValueType &value)
+    -> bool {
+  if (!bucket_page->IsFull()) {
+    return bucket_page->Insert(key, value, comparator_);
+  }
+  page_id_t overflow_page_id = bucket_page->GetOverflowPageId();
+  while (overflow_page_id != INVALID_PAGE_ID) {
+    HASH_TABLE_BUCKET_TYPE *overflow_page = FetchBucketPage(overflow_page_id);
+    if (overflow_page == nullptr) {
+      return false;
+    }
+    if (!overflow_page->IsFull()) {
+      overflow_page->Insert(key, value, comparator_);
+      buffer_pool_manager_->UnpinPage(overflow_page_id, true, nullptr);
+      return true;
+    }
+    page_id_t next_page_id = overflow_page->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(overflow_page_id, false, nullptr);
+    overflow_page_id = next_page_id;
+  }
+  // every page of the chain is full, the new one goes right after the bucket's own page
+  Page *page = buffer_pool_manager_->NewPage(&overflow_page_id, nullptr);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *overflow_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  overflow_page->Init();
+  overflow_page->Insert(key, value, comparator_);
+  overflow_page->SetOverflowPageId(bucket_page->GetOverflowPageId());
+  bucket_page->SetOverflowPageId(overflow_page_id);
+  buffer_pool_manager_->UnpinPage(overflow_page_id, true, nullptr);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::RemoveOverflow(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key, const ValueType &value,
+                                     bool *removed) -> bool {
+  // the page linking to the one being looked at, pinned unless it is the bucket's own page
+  HASH_TABLE_BUCKET_TYPE *prev_page = bucket_page;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  bool prev_dirty = false;
+  bool fetched = true;
+  page_id_t overflow_page_id = bucket_page->GetOverflowPageId();
+  while (overflow_page_id != INVALID_PAGE_ID) {
+    HASH_TABLE_BUCKET_TYPE *overflow_page = FetchBucketPage(overflow_page_id);
+    if (overflow_page == nullptr) {
+      fetched = false;
+      break;
+    }
+    page_id_t next_page_id = overflow_page->GetOverflowPageId();
+    if (overflow_page->Remove(key, value, comparator_)) {
+      *removed = true;
+      bool empty = overflow_page->IsEmpty();
+      buffer_pool_manager_->UnpinPage(overflow_page_id, !empty, nullptr);
+      if (empty) {
+        prev_page->SetOverflowPageId(next_page_id);
+        prev_dirty = true;
+        buffer_pool_manager_->DeletePage(overflow_page_id, nullptr);
+      }
+      break;
+    }
+    if (prev_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(prev_page_id, false, nullptr);
+    }
+    prev_page = overflow_page;
+    prev_page_id = overflow_page_id;
+    overflow_page_id = next_page_id;
+  }
+  if (prev_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, prev_dirty, nullptr);
+  }
+  return fetched;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::PullUpOverflow(HASH_TABLE_BUCKET_TYPE *bucket_page) -> bool {
+  page_id_t overflow_page_id = bucket_page->GetOverflowPageId();
+  HASH_TABLE_BUCKET_TYPE *overflow_page = FetchBucketPage(overflow_page_id);
+  if (overflow_page == nullptr) {
+    return false;
+  }
+  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && overflow_page->IsOccupied(i); i++) {
+    if (overflow_page->IsReadable(i)) {
+      bucket_page->Insert(overflow_page->KeyAt(i), overflow_page->ValueAt(i), comparator_);
+    }
+  }
+  bucket_page->SetOverflowPageId(overflow_page->GetOverflowPageId());
+  buffer_pool_manager_->UnpinPage(overflow_page_id, false, nullptr);
+  buffer_pool_manager_->DeletePage(overflow_page_id, nullptr);
+  return true;
 }
 
 /*****************************************************************************
@@ -69,7 +213,31 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BU
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  if (dir_page == nullptr) {
+    ReleaseAndThrow(false, false);
+  }
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id, nullptr);
+  if (page == nullptr) {
+    ReleaseAndThrow(false, true);
+  }
+  page->RLatch();
+  auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  size_t before = result->size();
+  bucket_page->GetValue(key, comparator_, result);
+  if (!GetOverflowValues(bucket_page, key, result)) {
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false, nullptr);
+    ReleaseAndThrow(false, true);
+  }
+  bool found = result->size() > before;
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false, nullptr);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
+  table_latch_.RUnlock();
+  return found;
 }
 
 /*****************************************************************************
@@ -77,12 +245,140 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  // inserts into a bucket with room only latch that bucket, so they run alongside lookups and other inserts
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  if (dir_page == nullptr) {
+    ReleaseAndThrow(false, false);
+  }
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id, nullptr);
+  if (page == nullptr) {
+    ReleaseAndThrow(false, true);
+  }
+  page->WLatch();
+  auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  // a bucket with overflow pages may hold the pair in any of them, so it is left to SplitInsert like a full one
+  bool slow = bucket_page->IsFull() || bucket_page->GetOverflowPageId() != INVALID_PAGE_ID;
+  bool inserted = !slow && bucket_page->Insert(key, value, comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted, nullptr);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
+  table_latch_.RUnlock();
+  if (slow) {
+    return SplitInsert(transaction, key, value);
+  }
+  return inserted;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  if (dir_page == nullptr) {
+    ReleaseAndThrow(true, false);
+  }
+  bool dir_dirty = false;
+  bool inserted = false;
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+    if (bucket_page == nullptr) {
+      ReleaseAndThrow(true, true, dir_dirty);
+    }
+    bool chained = bucket_page->GetOverflowPageId() != INVALID_PAGE_ID;
+    // another insert may have split the bucket or a remove made room since it was found full
+    if (!chained && !bucket_page->IsFull()) {
+      inserted = bucket_page->Insert(key, value, comparator_);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, inserted, nullptr);
+      break;
+    }
+    // removes may have emptied the bucket's own page, whose entries tell which hash bits the chain holds
+    if (chained && bucket_page->IsEmpty() && !PullUpOverflow(bucket_page)) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false, nullptr);
+      ReleaseAndThrow(true, true, dir_dirty);
+    }
+    std::vector<ValueType> values;
+    bucket_page->GetValue(key, comparator_, &values);
+    if (!GetOverflowValues(bucket_page, key, &values)) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true, nullptr);
+      ReleaseAndThrow(true, true, dir_dirty);
+    }
+    if (std::find(values.begin(), values.end(), value) != values.end()) {
+      // a duplicate pair
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true, nullptr);
+      break;
+    }
+
+    // Splits only ever separate entries on the hash bits a directory of DIRECTORY_ARRAY_SIZE entries can tell apart.
+    // A bucket whose entries, and the key, all have the same of those bits overflows instead.
+    const uint32_t split_mask = DIRECTORY_ARRAY_SIZE - 1;
+    uint32_t hash_bits = Hash(key) & split_mask;
+    bool splittable = false;
+    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && bucket_page->IsOccupied(i); i++) {
+      if (bucket_page->IsReadable(i) && (Hash(bucket_page->KeyAt(i)) & split_mask) != hash_bits) {
+        splittable = true;
+        break;
+      }
+    }
+    if (!splittable) {
+      inserted = InsertOverflow(bucket_page, key, value);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true, nullptr);
+      if (!inserted) {
+        ReleaseAndThrow(true, true, dir_dirty);
+      }
+      break;
+    }
+
+    // the split image is allocated before the directory changes, which a full buffer pool leaves as it is
+    page_id_t image_page_id = INVALID_PAGE_ID;
+    Page *page = buffer_pool_manager_->NewPage(&image_page_id, nullptr);
+    if (page == nullptr) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true, nullptr);
+      ReleaseAndThrow(true, true, dir_dirty);
+    }
+    auto *image_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    image_page->Init();
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if (local_depth == dir_page->GetGlobalDepth()) {
+      dir_page->IncrGlobalDepth();
+    }
+
+    // The entries whose hash has the bit above the local depth set move to the split image. The entries of a chain
+    // all have the same bit, so rather than moving them all, the chain goes to the half of the directory that bit
+    // points to and the empty image to the other one.
+    uint32_t high_bit = 1U << local_depth;
+    bool chain_high = false;
+    if (chained) {
+      for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && bucket_page->IsOccupied(i); i++) {
+        if (bucket_page->IsReadable(i)) {
+          chain_high = (Hash(bucket_page->KeyAt(i)) & high_bit) != 0;
+          break;
+        }
+      }
+    }
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      if (dir_page->GetBucketPageId(i) == bucket_page_id) {
+        dir_page->SetLocalDepth(i, local_depth + 1);
+        if (((i & high_bit) != 0) != chain_high) {
+          dir_page->SetBucketPageId(i, image_page_id);
+        }
+      }
+    }
+    dir_dirty = true;
+    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && !chained; i++) {
+      if (bucket_page->IsReadable(i) && (Hash(bucket_page->KeyAt(i)) & high_bit) != 0) {
+        image_page->Insert(bucket_page->KeyAt(i), bucket_page->ValueAt(i), comparator_);
+        bucket_page->RemoveAt(i);
+      }
+    }
+    buffer_pool_manager_->UnpinPage(image_page_id, true, nullptr);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true, nullptr);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty, nullptr);
+  table_latch_.WUnlock();
+  return inserted;
 }
 
 /*****************************************************************************
@@ -90,14 +386,82 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  if (dir_page == nullptr) {
+    ReleaseAndThrow(false, false);
+  }
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id, nullptr);
+  if (page == nullptr) {
+    ReleaseAndThrow(false, true);
+  }
+  page->WLatch();
+  auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool removed = bucket_page->Remove(key, value, comparator_);
+  if (!removed && !RemoveOverflow(bucket_page, key, value, &removed)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false, nullptr);
+    ReleaseAndThrow(false, true);
+  }
+  // the bucket's own page may be left empty while it has overflow pages, it is only merged once they are gone
+  bool empty = bucket_page->IsEmpty() && bucket_page->GetOverflowPageId() == INVALID_PAGE_ID;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed, nullptr);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
+  table_latch_.RUnlock();
+  if (removed && empty) {
+    Merge(transaction, key, value);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  if (dir_page == nullptr) {
+    // the remove is done already, and an empty bucket that is not merged is only wasted space
+    table_latch_.WUnlock();
+    return;
+  }
+  uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+  uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+  bool merged = false;
+  if (local_depth > 0) {
+    uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    page_id_t image_page_id = dir_page->GetBucketPageId(image_idx);
+    HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+    if (bucket_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
+      table_latch_.WUnlock();
+      return;
+    }
+    // an insert may have refilled the bucket since it was found empty
+    bool empty = bucket_page->IsEmpty() && bucket_page->GetOverflowPageId() == INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false, nullptr);
+    if (empty && dir_page->GetLocalDepth(image_idx) == local_depth) {
+      for (uint32_t i = 0; i < dir_page->Size(); i++) {
+        page_id_t page_id = dir_page->GetBucketPageId(i);
+        if (page_id == bucket_page_id || page_id == image_page_id) {
+          dir_page->SetBucketPageId(i, image_page_id);
+          dir_page->SetLocalDepth(i, local_depth - 1);
+        }
+      }
+      buffer_pool_manager_->DeletePage(bucket_page_id, nullptr);
+      while (dir_page->CanShrink()) {
+        dir_page->DecrGlobalDepth();
+      }
+      merged = true;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, merged, nullptr);
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
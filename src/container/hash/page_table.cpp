@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/container/hash/page_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "container/hash/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t max_entries) : capacity_bits_(1) {
+  // Keep the load factor at or below 1/2 so that probe sequences stay short.
+  while ((static_cast<size_t>(1) << capacity_bits_) < 2 * max_entries) {
+    capacity_bits_++;
+  }
+  mask_ = (static_cast<size_t>(1) << capacity_bits_) - 1;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(mask_ + 1);
+  for (size_t i = 0; i <= mask_; i++) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::Find(const page_id_t &page_id, frame_id_t &frame_id) -> bool {
+  while (true) {
+    auto version = version_.load(std::memory_order_acquire);
+    if ((version & 1) != 0) {
+      // A removal is shifting entries, the probe could miss one that is being moved.
+      continue;
+    }
+
+    bool found = false;
+    frame_id_t result = 0;
+    for (size_t i = HomeSlot(page_id);; i = (i + 1) & mask_) {
+      auto slot = slots_[i].load(std::memory_order_acquire);
+      if (slot == EMPTY_SLOT) {
+        break;
+      }
+      if (SlotPageId(slot) == page_id) {
+        found = true;
+        result = SlotFrameId(slot);
+        break;
+      }
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (version_.load(std::memory_order_relaxed) == version) {
+      if (found) {
+        frame_id = result;
+      }
+      return found;
+    }
+  }
+}
+
+void PageTable::Insert(const page_id_t &page_id, const frame_id_t &frame_id) {
+  BUSTUB_ASSERT(page_id >= 0, "Only valid pages go into the page table");
+  std::scoped_lock lock(write_latch_);
+  for (size_t i = HomeSlot(page_id);; i = (i + 1) & mask_) {
+    auto slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      BUSTUB_ASSERT(size_ <= mask_ / 2, "PageTable is over capacity");
+      size_++;
+      slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    if (SlotPageId(slot) == page_id) {
+      slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+  }
+}
+
+auto PageTable::Remove(const page_id_t &page_id) -> bool {
+  std::scoped_lock lock(write_latch_);
+  size_t hole = HomeSlot(page_id);
+  while (true) {
+    auto slot = slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      return false;
+    }
+    if (SlotPageId(slot) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask_;
+  }
+
+  auto version = version_.load(std::memory_order_relaxed);
+  version_.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  // Backward shift deletion: move every later entry of the cluster that may not live past the hole into it, so that
+  // no probe sequence is cut short and no tombstones pile up.
+  for (size_t i = (hole + 1) & mask_;; i = (i + 1) & mask_) {
+    auto slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    size_t home = HomeSlot(SlotPageId(slot));
+    // The entry can move to the hole unless its home lies cyclically in (hole, i].
+    bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+    if (!stays) {
+      slots_[hole].store(slot, std::memory_order_relaxed);
+      hole = i;
+    }
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_relaxed);
+  size_--;
+
+  version_.store(version + 2, std::memory_order_release);
+  return true;
+}
+
+}  // namespace bustub
@@ -9,27 +9,415 @@
 // Copyright (c) 2015-2021, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "common/exception.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/parallel_pipeline.h"
+#include "type/limits.h"
 
 namespace bustub {
 
+namespace {
+
+/** @return whether an integer type is accumulated natively, BOOLEAN and TIMESTAMP are left to Value */
+auto IsNativeInteger(TypeId type) -> bool {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+auto ToDouble(int64_t bits) -> double {
+  double value;
+  memcpy(&value, &bits, sizeof(double));
+  return value;
+}
+
+auto FromDouble(double value) -> int64_t {
+  int64_t bits;
+  memcpy(&bits, &value, sizeof(double));
+  return bits;
+}
+
+/** @return an integer as a Value of type, which it has to fit in, like a Value::Add() of that type would check */
+auto IntegerAsValue(TypeId type, int64_t value) -> Value {
+  auto check = [value](int64_t min, int64_t max) {
+    if (value < min || value > max) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "Numeric value out of range.");
+    }
+  };
+  switch (type) {
+    case TypeId::BOOLEAN:
+      return ValueFactory::GetBooleanValue(static_cast<int8_t>(value));
+    case TypeId::TINYINT:
+      check(BUSTUB_INT8_MIN, BUSTUB_INT8_MAX);
+      return ValueFactory::GetTinyIntValue(static_cast<int8_t>(value));
+    case TypeId::SMALLINT:
+      check(BUSTUB_INT16_MIN, BUSTUB_INT16_MAX);
+      return ValueFactory::GetSmallIntValue(static_cast<int16_t>(value));
+    case TypeId::INTEGER:
+      check(BUSTUB_INT32_MIN, BUSTUB_INT32_MAX);
+      return ValueFactory::GetIntegerValue(static_cast<int32_t>(value));
+    case TypeId::TIMESTAMP:
+      return ValueFactory::GetTimestampValue(value);
+    default:
+      return ValueFactory::GetBigIntValue(value);
+  }
+}
+
+/** @return the hash of a packed key, mixing it in eight bytes at a time */
+auto HashKey(const char *key, size_t size) -> hash_t {
+  uint64_t hash = size;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, key + i, sizeof(uint64_t));
+    hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 32;
+  }
+  for (; i < size; i++) {
+    hash = (hash ^ static_cast<uint8_t>(key[i])) * 0x100000001b3ULL;
+  }
+  // the 64-bit finalizer of MurmurHash3, for the low bits that pick a slot to depend on every byte
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+}  // namespace
+
+SimpleAggregationHashTable::SimpleAggregationHashTable(const std::vector<AbstractExpressionRef> &group_bys,
+                                                       const std::vector<AbstractExpressionRef> &agg_exprs,
+                                                       const std::vector<AggregationType> &agg_types)
+    : agg_types_(agg_types) {
+  for (const auto &expr : group_bys) {
+    key_types_.push_back(expr->GetReturnType());
+  }
+  generic_idx_.resize(agg_types.size());
+  for (uint32_t i = 0; i < agg_types.size(); i++) {
+    auto type = agg_exprs[i]->GetReturnType();
+    input_types_.push_back(type);
+    auto kind = AccumulatorKind::Generic;
+    switch (agg_types[i]) {
+      case AggregationType::CountStarAggregate:
+        kind = AccumulatorKind::CountStar;
+        break;
+      case AggregationType::CountAggregate:
+        kind = AccumulatorKind::Count;
+        break;
+      case AggregationType::SumAggregate:
+        kind = IsNativeInteger(type)       ? AccumulatorKind::IntegerSum
+               : type == TypeId::DECIMAL ? AccumulatorKind::DecimalSum
+                                         : AccumulatorKind::Generic;
+        break;
+      case AggregationType::MinAggregate:
+        kind = IsNativeInteger(type)       ? AccumulatorKind::IntegerMin
+               : type == TypeId::DECIMAL ? AccumulatorKind::DecimalMin
+                                         : AccumulatorKind::Generic;
+        break;
+      case AggregationType::MaxAggregate:
+        kind = IsNativeInteger(type)       ? AccumulatorKind::IntegerMax
+               : type == TypeId::DECIMAL ? AccumulatorKind::DecimalMax
+                                         : AccumulatorKind::Generic;
+        break;
+    }
+    kinds_.push_back(kind);
+    if (kind == AccumulatorKind::Generic) {
+      generic_idx_[i] = generic_count_++;
+    }
+  }
+}
+
+void SimpleAggregationHashTable::Clear() {
+  slots_.clear();
+  key_arena_.clear();
+  key_offsets_.assign(1, 0);
+  hashes_.clear();
+  accumulators_.clear();
+  generics_.clear();
+}
+
+void SimpleAggregationHashTable::PackKey(const std::vector<const ColumnVector *> &keys, size_t row) {
+  // A NULL flag, then 8 bytes for an integer or a decimal, or the length and bytes of a varchar. A NULL row has a
+  // zero or empty placeholder in its column, so all NULLs pack the same and fall into one group.
+  for (uint32_t i = 0; i < keys.size(); i++) {
+    const auto &column = *keys[i];
+    key_buf_.push_back(static_cast<char>(column.IsNull(row)));
+    if (ColumnVector::IsIntegral(key_types_[i])) {
+      auto value = column.GetInteger(row);
+      key_buf_.insert(key_buf_.end(), reinterpret_cast<const char *>(&value),
+                      reinterpret_cast<const char *>(&value) + sizeof(int64_t));
+    } else if (key_types_[i] == TypeId::DECIMAL) {
+      auto value = column.GetDecimal(row);
+      key_buf_.insert(key_buf_.end(), reinterpret_cast<const char *>(&value),
+                      reinterpret_cast<const char *>(&value) + sizeof(double));
+    } else {
+      const auto &value = column.GetVarchar(row);
+      auto length = static_cast<uint32_t>(value.size());
+      key_buf_.insert(key_buf_.end(), reinterpret_cast<const char *>(&length),
+                      reinterpret_cast<const char *>(&length) + sizeof(uint32_t));
+      key_buf_.insert(key_buf_.end(), value.begin(), value.end());
+    }
+  }
+}
+
+void SimpleAggregationHashTable::Grow() {
+  size_t capacity = slots_.empty() ? 64 : 2 * slots_.size();
+  slots_.assign(capacity, Slot{0, EMPTY_SLOT});
+  auto mask = capacity - 1;
+  for (uint32_t group = 0; group < hashes_.size(); group++) {
+    auto pos = hashes_[group] & mask;
+    while (slots_[pos].group_ != EMPTY_SLOT) {
+      pos = (pos + 1) & mask;
+    }
+    slots_[pos] = Slot{hashes_[group], group};
+  }
+}
+
+auto SimpleAggregationHashTable::FindOrInsert(const char *key, size_t size, hash_t hash) -> uint32_t {
+  // at most half the slots are taken, which keeps the probe sequences short
+  if (2 * (hashes_.size() + 1) > slots_.size()) {
+    Grow();
+  }
+  auto mask = slots_.size() - 1;
+  auto pos = hash & mask;
+  for (; slots_[pos].group_ != EMPTY_SLOT; pos = (pos + 1) & mask) {
+    const auto &slot = slots_[pos];
+    if (slot.hash_ != hash) {
+      continue;
+    }
+    auto offset = key_offsets_[slot.group_];
+    if (key_offsets_[slot.group_ + 1] - offset == size && memcmp(key_arena_.data() + offset, key, size) == 0) {
+      return slot.group_;
+    }
+  }
+
+  auto group = static_cast<uint32_t>(hashes_.size());
+  slots_[pos] = Slot{hash, group};
+  key_arena_.insert(key_arena_.end(), key, key + size);
+  key_offsets_.push_back(key_arena_.size());
+  hashes_.push_back(hash);
+  // Count star starts at zero, the others at NULL
+  for (auto kind : kinds_) {
+    accumulators_.push_back(Accumulator{0, kind != AccumulatorKind::CountStar});
+  }
+  generics_.resize(generics_.size() + generic_count_, ValueFactory::GetNullValueByType(TypeId::INTEGER));
+  return group;
+}
+
+void SimpleAggregationHashTable::Accumulate(AccumulatorKind kind, Accumulator *acc, const Accumulator &in) {
+  if (in.null_) {
+    return;
+  }
+  if (acc->null_) {
+    *acc = in;
+    return;
+  }
+  switch (kind) {
+    case AccumulatorKind::CountStar:
+    case AccumulatorKind::Count:
+    case AccumulatorKind::IntegerSum:
+      if (__builtin_add_overflow(acc->value_, in.value_, &acc->value_)) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "Numeric value out of range.");
+      }
+      break;
+    case AccumulatorKind::IntegerMin:
+      acc->value_ = std::min(acc->value_, in.value_);
+      break;
+    case AccumulatorKind::IntegerMax:
+      acc->value_ = std::max(acc->value_, in.value_);
+      break;
+    case AccumulatorKind::DecimalSum:
+      acc->value_ = FromDouble(ToDouble(acc->value_) + ToDouble(in.value_));
+      break;
+    case AccumulatorKind::DecimalMin:
+      acc->value_ = FromDouble(std::min(ToDouble(acc->value_), ToDouble(in.value_)));
+      break;
+    case AccumulatorKind::DecimalMax:
+      acc->value_ = FromDouble(std::max(ToDouble(acc->value_), ToDouble(in.value_)));
+      break;
+    case AccumulatorKind::Generic:
+      UNREACHABLE("aggregates of other types are kept as values");
+  }
+}
+
+void SimpleAggregationHashTable::AccumulateValue(AggregationType type, Value *acc, const Value &in) {
+  if (in.IsNull()) {
+    return;
+  }
+  if (acc->IsNull()) {
+    *acc = in;
+    return;
+  }
+  switch (type) {
+    case AggregationType::SumAggregate:
+      *acc = acc->Add(in);
+      break;
+    case AggregationType::MinAggregate:
+      *acc = acc->Min(in);
+      break;
+    case AggregationType::MaxAggregate:
+      *acc = acc->Max(in);
+      break;
+    default:
+      UNREACHABLE("counts are accumulated natively");
+  }
+}
+
+void SimpleAggregationHashTable::InsertBatch(const std::vector<const ColumnVector *> &keys,
+                                             const std::vector<const ColumnVector *> &vals, size_t rows) {
+  auto agg_count = kinds_.size();
+  for (size_t row = 0; row < rows; row++) {
+    key_buf_.clear();
+    PackKey(keys, row);
+    auto group = FindOrInsert(key_buf_.data(), key_buf_.size(), HashKey(key_buf_.data(), key_buf_.size()));
+
+    auto *accs = &accumulators_[group * agg_count];
+    for (uint32_t i = 0; i < agg_count; i++) {
+      const auto &column = *vals[i];
+      switch (kinds_[i]) {
+        case AccumulatorKind::CountStar:
+          accs[i].value_++;
+          break;
+        case AccumulatorKind::Count:
+          Accumulate(kinds_[i], &accs[i], Accumulator{1, column.IsNull(row)});
+          break;
+        case AccumulatorKind::IntegerSum:
+        case AccumulatorKind::IntegerMin:
+        case AccumulatorKind::IntegerMax:
+          Accumulate(kinds_[i], &accs[i], Accumulator{column.GetInteger(row), column.IsNull(row)});
+          break;
+        case AccumulatorKind::DecimalSum:
+        case AccumulatorKind::DecimalMin:
+        case AccumulatorKind::DecimalMax:
+          Accumulate(kinds_[i], &accs[i], Accumulator{FromDouble(column.GetDecimal(row)), column.IsNull(row)});
+          break;
+        case AccumulatorKind::Generic:
+          AccumulateValue(agg_types_[i], &generics_[group * generic_count_ + generic_idx_[i]], column.GetValue(row));
+          break;
+      }
+    }
+  }
+}
+
+void SimpleAggregationHashTable::InitCombine() {
+  // without group-bys, the key of the one group packs into no bytes
+  FindOrInsert(nullptr, 0, HashKey(nullptr, 0));
+}
+
+void SimpleAggregationHashTable::Merge(const SimpleAggregationHashTable &other) {
+  auto agg_count = kinds_.size();
+  for (uint32_t other_group = 0; other_group < other.hashes_.size(); other_group++) {
+    auto offset = other.key_offsets_[other_group];
+    auto group = FindOrInsert(other.key_arena_.data() + offset, other.key_offsets_[other_group + 1] - offset,
+                              other.hashes_[other_group]);
+    for (uint32_t i = 0; i < agg_count; i++) {
+      if (kinds_[i] == AccumulatorKind::Generic) {
+        AccumulateValue(agg_types_[i], &generics_[group * generic_count_ + generic_idx_[i]],
+                        other.generics_[other_group * generic_count_ + generic_idx_[i]]);
+      } else {
+        Accumulate(kinds_[i], &accumulators_[group * agg_count + i], other.accumulators_[other_group * agg_count + i]);
+      }
+    }
+  }
+}
+
+auto SimpleAggregationHashTable::GetKey(size_t group) const -> AggregateKey {
+  AggregateKey key;
+  const char *data = key_arena_.data() + key_offsets_[group];
+  for (auto type : key_types_) {
+    bool is_null = *data++ != 0;
+    if (ColumnVector::IsIntegral(type) || type == TypeId::DECIMAL) {
+      int64_t bits;
+      memcpy(&bits, data, sizeof(int64_t));
+      data += sizeof(int64_t);
+      if (is_null) {
+        key.group_bys_.push_back(ValueFactory::GetNullValueByType(type));
+      } else if (type == TypeId::DECIMAL) {
+        key.group_bys_.push_back(ValueFactory::GetDecimalValue(ToDouble(bits)));
+      } else {
+        key.group_bys_.push_back(IntegerAsValue(type, bits));
+      }
+    } else {
+      uint32_t length;
+      memcpy(&length, data, sizeof(uint32_t));
+      data += sizeof(uint32_t);
+      key.group_bys_.push_back(is_null ? ValueFactory::GetNullValueByType(type)
+                                       : ValueFactory::GetVarcharValue(std::string(data, length)));
+      data += length;
+    }
+  }
+  return key;
+}
+
+auto SimpleAggregationHashTable::GetValue(size_t group) const -> AggregateValue {
+  AggregateValue val;
+  const auto *accs = &accumulators_[group * kinds_.size()];
+  for (uint32_t i = 0; i < kinds_.size(); i++) {
+    const auto &acc = accs[i];
+    if (kinds_[i] == AccumulatorKind::Generic) {
+      val.aggregates_.push_back(generics_[group * generic_count_ + generic_idx_[i]]);
+    } else if (acc.null_) {
+      val.aggregates_.push_back(ValueFactory::GetNullValueByType(TypeId::INTEGER));
+    } else if (kinds_[i] == AccumulatorKind::CountStar || kinds_[i] == AccumulatorKind::Count) {
+      val.aggregates_.push_back(IntegerAsValue(TypeId::INTEGER, acc.value_));
+    } else if (input_types_[i] == TypeId::DECIMAL) {
+      val.aggregates_.push_back(ValueFactory::GetDecimalValue(ToDouble(acc.value_)));
+    } else {
+      val.aggregates_.push_back(IntegerAsValue(input_types_[i], acc.value_));
+    }
+  }
+  return val;
+}
+
 AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                                          std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx),plan_(plan),child_(std::move(child)),aht_(plan->GetAggregates(), plan->GetAggregateTypes()),aht_iterator_(aht_.Begin()) {}
+    : AbstractExecutor(exec_ctx),plan_(plan),child_(std::move(child)),aht_(plan->GetGroupBys(), plan->GetAggregates(), plan->GetAggregateTypes()),aht_iterator_(aht_.Begin()) {}
+
+void AggregationExecutor::AggregateBatches(AbstractExecutor *child, SimpleAggregationHashTable *aht) const {
+    // The group-bys and aggregates are computed a column at a time over each batch of child tuples
+    const auto &group_bys = plan_->GetGroupBys();
+    const auto &aggregates = plan_->GetAggregates();
+    TupleBatch batch;
+    // Plain columns of the batch are read in place, only computed ones are materialized into scratch
+    std::vector<ColumnVector> key_scratch(group_bys.size());
+    std::vector<ColumnVector> val_scratch(aggregates.size());
+    std::vector<const ColumnVector *> keys(group_bys.size());
+    std::vector<const ColumnVector *> vals(aggregates.size());
+    while (child->NextBatch(&batch)) {
+      for (size_t i = 0; i < group_bys.size(); i++) {
+        keys[i] = &group_bys[i]->EvaluateBatchRef(batch, &key_scratch[i]);
+      }
+      for (size_t i = 0; i < aggregates.size(); i++) {
+        vals[i] = &aggregates[i]->EvaluateBatchRef(batch, &val_scratch[i]);
+      }
+      aht->InsertBatch(keys, vals, batch.Size());
+    }
+}
 
 void AggregationExecutor::Init() {
-    child_->Init();
-    Tuple tuple{};
-    RID rid{};
+    aht_.Clear();
     if (!plan_->aggregates_.empty() || !plan_->group_bys_.empty()) {
-    while (child_->Next(&tuple, &rid)) {
-      aht_.InsertCombine(MakeAggregateKey(&tuple), MakeAggregateValue(&tuple));
+    if(ParallelPipeline::CanRun(exec_ctx_, plan_->GetChildPlan())){
+        // Every worker aggregates the morsels it scans into a table of its own, merged into aht_ once all are done
+        std::vector<SimpleAggregationHashTable> tables(exec_ctx_->GetParallelism(), aht_);
+        ParallelPipeline::Run(exec_ctx_, plan_->GetChildPlan(), [&](size_t worker, AbstractExecutor *child) {
+            AggregateBatches(child, &tables[worker]);
+        });
+        for(const auto &table : tables){
+            aht_.Merge(table);
+        }
+    } else {
+        child_->Init();
+        AggregateBatches(child_.get(), &aht_);
     }
     if (aht_.Begin() == aht_.End() && plan_->GetGroupBys().empty()) {
-      aht_.InitCombine(MakeAggregateKey(&tuple));
+      aht_.InitCombine();
     }
 
     aht_iterator_ = aht_.Begin();
@@ -41,9 +429,9 @@ auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
         return false;
     }
 
-    std::vector<Value> values{};
-    values.insert(values.end(), aht_iterator_.Key().group_bys_.begin(), aht_iterator_.Key().group_bys_.end());
-    values.insert(values.end(), aht_iterator_.Val().aggregates_.begin(), aht_iterator_.Val().aggregates_.end());
+    std::vector<Value> values = aht_iterator_.Key().group_bys_;
+    auto aggregates = aht_iterator_.Val().aggregates_;
+    values.insert(values.end(), aggregates.begin(), aggregates.end());
     *tuple = Tuple{values, &GetOutputSchema()};
     *rid = tuple->GetRid();
 
@@ -52,6 +440,24 @@ auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     return true;
 }
 
+auto AggregationExecutor::NextBatch(TupleBatch *batch) -> bool {
+    batch->Reset(&GetOutputSchema());
+    while (!batch->IsFull() && aht_iterator_ != aht_.End()) {
+        uint32_t col = 0;
+        auto key = aht_iterator_.Key();
+        auto agg = aht_iterator_.Val();
+        for (const auto &group_by : key.group_bys_) {
+            batch->GetColumn(col++).Append(group_by);
+        }
+        for (const auto &val : agg.aggregates_) {
+            batch->GetColumn(col++).Append(val);
+        }
+        batch->EndRow();
+        ++aht_iterator_;
+    }
+    return batch->Size() > 0;
+}
+
 auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
 
 }  // namespace bustub
@@ -0,0 +1,299 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression.cpp
+//
+// Identification: src/execution/compiled_expression.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/expressions/compiled_expression.h"
+
+#include <cstring>
+#include <utility>
+
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "type/limits.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return whether values of type can be held in a register */
+auto IsCompilable(TypeId type) -> bool {
+  return type == TypeId::BOOLEAN || type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER ||
+         type == TypeId::BIGINT;
+}
+
+auto ConstantAsInteger(const Value &val) -> int64_t {
+  switch (val.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return val.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return val.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return val.GetAs<int32_t>();
+    default:
+      return val.GetAs<int64_t>();
+  }
+}
+
+template <typename T>
+auto ReadRaw(const char *data) -> T {
+  T raw;
+  memcpy(&raw, data, sizeof(T));
+  return raw;
+}
+
+}  // namespace
+
+CompiledExpression::CompiledExpression(AbstractExpressionRef expr, const Schema &schema, const Schema *right_schema)
+    : expr_(std::move(expr)), schema_(&schema), right_schema_(right_schema) {
+  if (Compile(*expr_, schema, right_schema) < 0) {
+    program_.clear();
+  }
+}
+
+auto CompiledExpression::Compile(const AbstractExpression &expr, const Schema &schema, const Schema *right_schema)
+    -> int {
+  Instruction instr{};
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(&expr); column != nullptr) {
+    // outside of a join, Evaluate reads every column from its one tuple whatever its tuple index
+    instr.op_ = OpCode::LoadColumn;
+    instr.tuple_idx_ = right_schema == nullptr ? 0 : column->GetTupleIdx();
+    instr.col_idx_ = column->GetColIdx();
+    const auto &col = (instr.tuple_idx_ == 0 ? schema : *right_schema).GetColumn(instr.col_idx_);
+    instr.type_ = col.GetType();
+    instr.offset_ = col.GetOffset();
+    if (!IsCompilable(instr.type_)) {
+      return -1;
+    }
+  } else if (const auto *constant = dynamic_cast<const ConstantValueExpression *>(&expr); constant != nullptr) {
+    const auto &val = constant->val_;
+    if (!IsCompilable(val.GetTypeId())) {
+      return -1;
+    }
+    instr.op_ = OpCode::LoadConstant;
+    instr.null_ = val.IsNull();
+    if (!instr.null_) {
+      instr.constant_ = ConstantAsInteger(val);
+    }
+  } else if (expr.GetChildren().size() == 2) {
+    if (const auto *comparison = dynamic_cast<const ComparisonExpression *>(&expr); comparison != nullptr) {
+      switch (comparison->comp_type_) {
+        case ComparisonType::Equal:
+          instr.op_ = OpCode::Equal;
+          break;
+        case ComparisonType::NotEqual:
+          instr.op_ = OpCode::NotEqual;
+          break;
+        case ComparisonType::LessThan:
+          instr.op_ = OpCode::LessThan;
+          break;
+        case ComparisonType::LessThanOrEqual:
+          instr.op_ = OpCode::LessThanOrEqual;
+          break;
+        case ComparisonType::GreaterThan:
+          instr.op_ = OpCode::GreaterThan;
+          break;
+        case ComparisonType::GreaterThanOrEqual:
+          instr.op_ = OpCode::GreaterThanOrEqual;
+          break;
+      }
+    } else if (const auto *logic = dynamic_cast<const LogicExpression *>(&expr); logic != nullptr) {
+      instr.op_ = logic->logic_type_ == LogicType::And ? OpCode::And : OpCode::Or;
+    } else if (const auto *arithmetic = dynamic_cast<const ArithmeticExpression *>(&expr); arithmetic != nullptr) {
+      instr.op_ = arithmetic->compute_type_ == ArithmeticType::Plus ? OpCode::Plus : OpCode::Minus;
+    } else {
+      return -1;
+    }
+    auto lhs = Compile(*expr.GetChildAt(0), schema, right_schema);
+    auto rhs = lhs < 0 ? -1 : Compile(*expr.GetChildAt(1), schema, right_schema);
+    if (rhs < 0) {
+      return -1;
+    }
+    instr.lhs_ = static_cast<uint8_t>(lhs);
+    instr.rhs_ = static_cast<uint8_t>(rhs);
+  } else {
+    return -1;
+  }
+
+  // every instruction writes a register of its own
+  if (program_.size() >= MAX_REGISTERS) {
+    return -1;
+  }
+  instr.dst_ = static_cast<uint8_t>(program_.size());
+  program_.push_back(instr);
+  return instr.dst_;
+}
+
+template <typename Loader>
+auto CompiledExpression::Run(Loader &&load) const -> Register {
+  std::array<Register, MAX_REGISTERS> regs{};
+  for (const auto &instr : program_) {
+    const auto &l = regs[instr.lhs_];
+    const auto &r = regs[instr.rhs_];
+    auto &dst = regs[instr.dst_];
+    switch (instr.op_) {
+      case OpCode::LoadColumn:
+        dst = load(instr);
+        break;
+      case OpCode::LoadConstant:
+        dst = {instr.constant_, instr.null_};
+        break;
+      case OpCode::Equal:
+        dst = {static_cast<int64_t>(l.value_ == r.value_), l.null_ || r.null_};
+        break;
+      case OpCode::NotEqual:
+        dst = {static_cast<int64_t>(l.value_ != r.value_), l.null_ || r.null_};
+        break;
+      case OpCode::LessThan:
+        dst = {static_cast<int64_t>(l.value_ < r.value_), l.null_ || r.null_};
+        break;
+      case OpCode::LessThanOrEqual:
+        dst = {static_cast<int64_t>(l.value_ <= r.value_), l.null_ || r.null_};
+        break;
+      case OpCode::GreaterThan:
+        dst = {static_cast<int64_t>(l.value_ > r.value_), l.null_ || r.null_};
+        break;
+      case OpCode::GreaterThanOrEqual:
+        dst = {static_cast<int64_t>(l.value_ >= r.value_), l.null_ || r.null_};
+        break;
+      case OpCode::And:
+        // false wins over NULL, which wins over true
+        if ((!l.null_ && l.value_ == 0) || (!r.null_ && r.value_ == 0)) {
+          dst = {0, false};
+        } else {
+          dst = {1, l.null_ || r.null_};
+        }
+        break;
+      case OpCode::Or:
+        // true wins over NULL, which wins over false
+        if ((!l.null_ && l.value_ != 0) || (!r.null_ && r.value_ != 0)) {
+          dst = {1, false};
+        } else {
+          dst = {0, l.null_ || r.null_};
+        }
+        break;
+      case OpCode::Plus:
+      case OpCode::Minus: {
+        // INTEGER arithmetic wraps around, and a result that lands on the NULL sentinel reads back as NULL
+        auto l32 = static_cast<uint32_t>(l.value_);
+        auto r32 = static_cast<uint32_t>(r.value_);
+        auto result = static_cast<int32_t>(instr.op_ == OpCode::Plus ? l32 + r32 : l32 - r32);
+        dst = {result, l.null_ || r.null_ || result == BUSTUB_INT32_NULL};
+        break;
+      }
+    }
+  }
+  return regs[program_.back().dst_];
+}
+
+auto CompiledExpression::LoadFromTuple(const Instruction &instr, const Tuple *tuple) -> Register {
+  const char *data = tuple->GetData() + instr.offset_;
+  switch (instr.type_) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT: {
+      auto raw = ReadRaw<int8_t>(data);
+      return {raw, raw == BUSTUB_INT8_NULL};
+    }
+    case TypeId::SMALLINT: {
+      auto raw = ReadRaw<int16_t>(data);
+      return {raw, raw == BUSTUB_INT16_NULL};
+    }
+    case TypeId::INTEGER: {
+      auto raw = ReadRaw<int32_t>(data);
+      return {raw, raw == BUSTUB_INT32_NULL};
+    }
+    default: {
+      auto raw = ReadRaw<int64_t>(data);
+      return {raw, raw == BUSTUB_INT64_NULL};
+    }
+  }
+}
+
+auto CompiledExpression::ToValue(const Register &reg) const -> Value {
+  auto type = expr_->GetReturnType();
+  if (reg.null_) {
+    return ValueFactory::GetNullValueByType(type);
+  }
+  switch (type) {
+    case TypeId::BOOLEAN:
+      return ValueFactory::GetBooleanValue(reg.value_ != 0);
+    case TypeId::TINYINT:
+      return ValueFactory::GetTinyIntValue(static_cast<int8_t>(reg.value_));
+    case TypeId::SMALLINT:
+      return ValueFactory::GetSmallIntValue(static_cast<int16_t>(reg.value_));
+    case TypeId::BIGINT:
+      return ValueFactory::GetBigIntValue(reg.value_);
+    default:
+      return ValueFactory::GetIntegerValue(static_cast<int32_t>(reg.value_));
+  }
+}
+
+auto CompiledExpression::Evaluate(const Tuple *tuple) const -> Value {
+  if (!IsCompiled()) {
+    return expr_->Evaluate(tuple, *schema_);
+  }
+  return ToValue(Run([tuple](const Instruction &instr) { return LoadFromTuple(instr, tuple); }));
+}
+
+auto CompiledExpression::EvaluateJoin(const Tuple *left_tuple, const Tuple *right_tuple) const -> Value {
+  if (!IsCompiled()) {
+    return expr_->EvaluateJoin(left_tuple, *schema_, right_tuple, *right_schema_);
+  }
+  return ToValue(Run([left_tuple, right_tuple](const Instruction &instr) {
+    return LoadFromTuple(instr, instr.tuple_idx_ == 0 ? left_tuple : right_tuple);
+  }));
+}
+
+auto CompiledExpression::EvaluatePredicate(const Tuple *tuple) const -> bool {
+  if (!IsCompiled()) {
+    auto value = expr_->Evaluate(tuple, *schema_);
+    return !value.IsNull() && value.GetAs<bool>();
+  }
+  auto reg = Run([tuple](const Instruction &instr) { return LoadFromTuple(instr, tuple); });
+  return !reg.null_ && reg.value_ != 0;
+}
+
+auto CompiledExpression::EvaluateJoinPredicate(const Tuple *left_tuple, const Tuple *right_tuple) const -> bool {
+  if (!IsCompiled()) {
+    auto value = expr_->EvaluateJoin(left_tuple, *schema_, right_tuple, *right_schema_);
+    return !value.IsNull() && value.GetAs<bool>();
+  }
+  auto reg = Run([left_tuple, right_tuple](const Instruction &instr) {
+    return LoadFromTuple(instr, instr.tuple_idx_ == 0 ? left_tuple : right_tuple);
+  });
+  return !reg.null_ && reg.value_ != 0;
+}
+
+void CompiledExpression::EvaluateBatch(const TupleBatch &batch, ColumnVector *out) const {
+  // a lone column or constant is copied faster by the expression itself
+  if (program_.size() <= 1) {
+    expr_->EvaluateBatch(batch, out);
+    return;
+  }
+  out->Reset(expr_->GetReturnType());
+  for (size_t row = 0; row < batch.Size(); row++) {
+    auto reg = Run([&batch, row](const Instruction &instr) {
+      const auto &column = batch.GetColumn(instr.col_idx_);
+      return Register{column.GetInteger(row), column.IsNull(row)};
+    });
+    if (reg.null_) {
+      out->AppendNull();
+    } else {
+      out->AppendInteger(reg.value_);
+    }
+  }
+}
+
+}  // namespace bustub
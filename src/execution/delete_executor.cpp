@@ -40,7 +40,8 @@ auto DeleteExecutor::Next(Tuple *tuple, RID *rid) -> bool {
         txn = exec_ctx_->GetTransaction();
         checking_table_->table_->MarkDelete(*rid,txn);
         for(auto &temp : index_info_){
-            temp->index_->DeleteEntry(child_tuple,*rid,txn);
+            auto key = child_tuple.KeyFromTuple(checking_table_->schema_, temp->key_schema_, temp->index_->GetKeyAttrs());
+            temp->index_->DeleteEntry(key,*rid,txn);
         }
         status = child_executor_->Next(&child_tuple,rid);
         count++;
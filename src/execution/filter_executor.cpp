@@ -6,7 +6,10 @@ namespace bustub {
 
 FilterExecutor::FilterExecutor(ExecutorContext *exec_ctx, const FilterPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_executor_(std::move(child_executor)),
+      predicate_(plan_->GetPredicate(), child_executor_->GetOutputSchema()) {}
 
 void FilterExecutor::Init() {
   // Initialize the child executor
@@ -14,8 +17,6 @@ void FilterExecutor::Init() {
 }
 
 auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  auto filter_expr = plan_->GetPredicate();
-
   while (true) {
     // Get the next tuple
     const auto status = child_executor_->Next(tuple, rid);
@@ -24,11 +25,28 @@ auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
       return false;
     }
 
-    auto value = filter_expr->Evaluate(tuple, child_executor_->GetOutputSchema());
-    if (!value.IsNull() && value.GetAs<bool>()) {
+    if (predicate_.EvaluatePredicate(tuple)) {
       return true;
     }
   }
 }
 
+auto FilterExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+
+  // A child batch may have no tuple that passes, keep going until one does
+  while (batch->Size() == 0) {
+    if (!child_executor_->NextBatch(&child_batch_)) {
+      return false;
+    }
+    predicate_.EvaluateBatch(child_batch_, &selection_);
+    for (size_t row = 0; row < child_batch_.Size(); row++) {
+      if (!selection_.IsNull(row) && selection_.GetInteger(row) != 0) {
+        batch->AppendRow(child_batch_, row);
+      }
+    }
+  }
+  return true;
+}
+
 }  // namespace bustub
@@ -12,23 +12,409 @@
 
 #include "execution/executors/hash_join_executor.h"
 
-// Note for 2022 Fall: You don't need to implement HashJoinExecutor to pass all tests. You ONLY need to implement it
-// if you want to get faster in leaderboard tests.
+#include <algorithm>
+#include <mutex>  // NOLINT
+
+#include "common/exception.h"
+#include "execution/parallel_pipeline.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&left_child,
                                    std::unique_ptr<AbstractExecutor> &&right_child)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_child_(std::move(left_child)),
+      right_child_(std::move(right_child)) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void HashJoinExecutor::Init() { throw NotImplementedException("HashJoinExecutor is not implemented"); }
+HashJoinExecutor::~HashJoinExecutor() { ReleasePartitions(); }
+
+void HashJoinExecutor::Init() {
+  left_child_->Init();
+  ReleasePartitions();
+  partitions_.resize(1 << HASH_JOIN_PARTITION_BITS);
+  bytes_ = 0;
+
+  if (ParallelPipeline::CanRun(exec_ctx_, plan_->GetRightPlan())) {
+    ParallelBuild();
+  } else {
+    // The build tuples are kept serialized, so the right child is read a tuple at a time. NULL keys equal nothing, so
+    // their build tuples are never needed.
+    right_child_->Init();
+    Tuple tuple;
+    RID rid;
+    while (right_child_->Next(&tuple, &rid)) {
+      auto key = plan_->RightJoinKeyExpression().Evaluate(&tuple, right_child_->GetOutputSchema());
+      if (!key.IsNull()) {
+        auto hash = HashKey(key);
+        AddBuildTuple(tuple, std::move(key), hash);
+      }
+    }
+    for (auto &partition : partitions_) {
+      if (partition.spilled_) {
+        FinishSpilled(&partition.build_page_);
+      } else {
+        BuildTable(&partition);
+      }
+    }
+  }
+
+  left_done_ = false;
+  loaded_ = nullptr;
+  spilled_idx_ = 0;
+  left_batch_.Reset(&left_child_->GetOutputSchema());
+  left_row_ = 0;
+  probing_ = false;
+  out_batch_.Reset(&GetOutputSchema());
+  out_idx_ = 0;
+}
+
+auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (out_idx_ >= out_batch_.Size()) {
+    if (!NextBatch(&out_batch_)) {
+      return false;
+    }
+    out_idx_ = 0;
+  }
+  *tuple = out_batch_.GetTuple(out_idx_);
+  *rid = out_batch_.GetRid(out_idx_);
+  out_idx_++;
+  return true;
+}
+
+auto HashJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull()) {
+    if (probing_) {
+      if (const auto *right_tuple = NextMatch(); right_tuple != nullptr) {
+        matched_ = true;
+        AppendJoined(batch, right_tuple);
+        continue;
+      }
+      probing_ = false;
+      if (plan_->GetJoinType() == JoinType::LEFT && !matched_) {
+        AppendJoined(batch, nullptr);
+      }
+      continue;
+    }
+    if (++left_row_ >= left_batch_.Size()) {
+      if (!NextLeftBatch()) {
+        break;
+      }
+      left_row_ = 0;
+    }
+    StartProbe();
+  }
+  return batch->Size() > 0;
+}
+
+auto HashJoinExecutor::HashKey(const Value &key) -> hash_t {
+  // HashValue shifts bytes into the high bits, the 64-bit finalizer of MurmurHash3 spreads them over all of them
+  uint64_t hash = HashUtil::HashValue(&key);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
 
-auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+void HashJoinExecutor::AddBuildTuple(const Tuple &tuple, Value key, hash_t hash) {
+  auto &partition = partitions_[PartitionOf(hash)];
+  if (partition.spilled_) {
+    WriteSpilled(tuple, &partition.build_pages_, &partition.build_page_);
+    return;
+  }
+  auto bytes = sizeof(Tuple) + tuple.GetLength() + sizeof(Value) + sizeof(hash_t) + 2 * sizeof(Slot);
+  partition.tuples_.push_back(tuple);
+  partition.keys_.push_back(std::move(key));
+  partition.hashes_.push_back(hash);
+  partition.bytes_ += bytes;
+  bytes_ += bytes;
+
+  // spilling the largest partitions first keeps as much of the build side in memory as fits
+  while (bytes_ > static_cast<size_t>(HASH_JOIN_BUDGET)) {
+    auto largest = std::max_element(partitions_.begin(), partitions_.end(),
+                                    [](const Partition &a, const Partition &b) { return a.bytes_ < b.bytes_; });
+    Spill(&*largest);
+  }
+}
+
+void HashJoinExecutor::ParallelBuild() {
+  auto workers = exec_ctx_->GetParallelism();
+  const auto &schema = right_child_->GetOutputSchema();
+  // Each worker holds up to its share of the budget before merging, so the build side takes twice the budget at most
+  auto local_budget = static_cast<size_t>(HASH_JOIN_BUDGET) / workers;
+  std::mutex latch;
+  ParallelPipeline::Run(exec_ctx_, plan_->GetRightPlan(), [&](size_t /* worker */, AbstractExecutor *child) {
+    std::vector<Partition> local(partitions_.size());
+    size_t local_bytes = 0;
+    Tuple tuple;
+    RID rid;
+    while (child->Next(&tuple, &rid)) {
+      auto key = plan_->RightJoinKeyExpression().Evaluate(&tuple, schema);
+      if (key.IsNull()) {
+        continue;
+      }
+      auto hash = HashKey(key);
+      auto &partition = local[PartitionOf(hash)];
+      local_bytes += sizeof(Tuple) + tuple.GetLength() + sizeof(Value) + sizeof(hash_t);
+      partition.tuples_.push_back(std::move(tuple));
+      partition.keys_.push_back(std::move(key));
+      partition.hashes_.push_back(hash);
+      if (local_bytes > local_budget) {
+        std::scoped_lock lock(latch);
+        MergeBuildTuples(&local);
+        local_bytes = 0;
+      }
+    }
+    std::scoped_lock lock(latch);
+    MergeBuildTuples(&local);
+  });
+
+  for (auto &partition : partitions_) {
+    FinishSpilled(&partition.build_page_);
+  }
+  // The partitions are independent, so their tables are built on the workers as well
+  exec_ctx_->GetWorkerPool()->Run(workers, [&](size_t worker) {
+    for (size_t i = worker; i < partitions_.size(); i += workers) {
+      if (!partitions_[i].spilled_) {
+        BuildTable(&partitions_[i]);
+      }
+    }
+  });
+}
+
+void HashJoinExecutor::MergeBuildTuples(std::vector<Partition> *local) {
+  for (auto &partition : *local) {
+    for (size_t i = 0; i < partition.tuples_.size(); i++) {
+      AddBuildTuple(partition.tuples_[i], std::move(partition.keys_[i]), partition.hashes_[i]);
+    }
+    partition.tuples_.clear();
+    partition.keys_.clear();
+    partition.hashes_.clear();
+  }
+}
+
+void HashJoinExecutor::Spill(Partition *partition) {
+  for (const auto &tuple : partition->tuples_) {
+    WriteSpilled(tuple, &partition->build_pages_, &partition->build_page_);
+  }
+  partition->tuples_ = std::vector<Tuple>();
+  partition->keys_ = std::vector<Value>();
+  partition->hashes_ = std::vector<hash_t>();
+  bytes_ -= partition->bytes_;
+  partition->bytes_ = 0;
+  partition->spilled_ = true;
+}
+
+void HashJoinExecutor::WriteSpilled(const Tuple &tuple, std::vector<page_id_t> *pages, TmpTuplePage **page) {
+  TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+  if (*page != nullptr && (*page)->Insert(tuple, &tmp_tuple)) {
+    return;
+  }
+  FinishSpilled(page);
+  page_id_t page_id;
+  auto *new_page = exec_ctx_->GetBufferPoolManager()->NewPage(&page_id);
+  if (new_page == nullptr) {
+    throw ExecutionException("hash join cannot spill, the buffer pool is full");
+  }
+  *page = reinterpret_cast<TmpTuplePage *>(new_page);
+  (*page)->Init(page_id, BUSTUB_PAGE_SIZE);
+  pages->push_back(page_id);
+  if (!(*page)->Insert(tuple, &tmp_tuple)) {
+    throw ExecutionException("hash join cannot spill a tuple larger than a page");
+  }
+}
+
+void HashJoinExecutor::FinishSpilled(TmpTuplePage **page) {
+  if (*page != nullptr) {
+    exec_ctx_->GetBufferPoolManager()->UnpinPage((*page)->GetTablePageId(), true);
+    *page = nullptr;
+  }
+}
+
+void HashJoinExecutor::ReadSpilled(page_id_t page_id, std::vector<Tuple> *tuples) {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  auto *page = reinterpret_cast<TmpTuplePage *>(bpm->FetchPage(page_id));
+  if (page == nullptr) {
+    throw ExecutionException("hash join cannot read back a spilled page, the buffer pool is full");
+  }
+  for (uint32_t offset = page->GetFreeSpacePointer(); offset < BUSTUB_PAGE_SIZE;) {
+    Tuple tuple;
+    offset = page->Get(offset, &tuple);
+    tuples->push_back(std::move(tuple));
+  }
+  bpm->UnpinPage(page_id, false);
+  bpm->DeletePage(page_id);
+}
+
+void HashJoinExecutor::BuildTable(Partition *partition) {
+  partition->slots_.clear();
+  if (partition->tuples_.empty()) {
+    return;
+  }
+  size_t capacity = 2;
+  while (capacity < 2 * partition->tuples_.size()) {
+    capacity <<= 1;
+  }
+  partition->slots_.assign(capacity, Slot{0, EMPTY_SLOT});
+  auto mask = capacity - 1;
+  for (uint32_t i = 0; i < partition->tuples_.size(); i++) {
+    auto hash = partition->hashes_[i];
+    auto pos = (hash >> HASH_JOIN_PARTITION_BITS) & mask;
+    while (partition->slots_[pos].tuple_idx_ != EMPTY_SLOT) {
+      pos = (pos + 1) & mask;
+    }
+    partition->slots_[pos] = Slot{hash, i};
+  }
+}
+
+auto HashJoinExecutor::LoadSpilledPartition() -> bool {
+  if (loaded_ != nullptr) {
+    *loaded_ = Partition();
+    loaded_ = nullptr;
+  }
+  while (spilled_idx_ < partitions_.size()) {
+    auto &partition = partitions_[spilled_idx_++];
+    if (!partition.spilled_) {
+      continue;
+    }
+    // partitions are not split again, one that outgrows the budget on its own is still joined in memory
+    for (auto page_id : partition.build_pages_) {
+      ReadSpilled(page_id, &partition.tuples_);
+    }
+    partition.build_pages_.clear();
+    for (const auto &tuple : partition.tuples_) {
+      auto key = plan_->RightJoinKeyExpression().Evaluate(&tuple, right_child_->GetOutputSchema());
+      partition.hashes_.push_back(HashKey(key));
+      partition.keys_.push_back(std::move(key));
+    }
+    BuildTable(&partition);
+    partition.spilled_ = false;
+    loaded_ = &partition;
+    return true;
+  }
+  return false;
+}
+
+auto HashJoinExecutor::NextLeftBatch() -> bool {
+  if (!left_done_) {
+    if (left_child_->NextBatch(&left_batch_)) {
+      left_keys_ = &plan_->LeftJoinKeyExpression().EvaluateBatchRef(left_batch_, &left_keys_scratch_);
+      return true;
+    }
+    // the partitions kept in memory are done with, the spilled ones are joined one at a time from here on
+    left_done_ = true;
+    for (auto &partition : partitions_) {
+      if (partition.spilled_) {
+        FinishSpilled(&partition.probe_page_);
+      } else {
+        partition = Partition();
+      }
+    }
+  }
+  while (true) {
+    if (loaded_ != nullptr && !loaded_->probe_pages_.empty()) {
+      auto page_id = loaded_->probe_pages_.back();
+      loaded_->probe_pages_.pop_back();
+      std::vector<Tuple> tuples;
+      ReadSpilled(page_id, &tuples);
+      left_batch_.Reset(&left_child_->GetOutputSchema());
+      for (const auto &tuple : tuples) {
+        left_batch_.AppendTuple(tuple, RID{});
+      }
+      left_keys_ = &plan_->LeftJoinKeyExpression().EvaluateBatchRef(left_batch_, &left_keys_scratch_);
+      return true;
+    }
+    if (!LoadSpilledPartition()) {
+      return false;
+    }
+  }
+}
+
+void HashJoinExecutor::StartProbe() {
+  probing_ = true;
+  matched_ = false;
+  probe_partition_ = nullptr;
+  if (left_keys_->IsNull(left_row_)) {
+    return;
+  }
+  auto key = left_keys_->GetValue(left_row_);
+  auto hash = HashKey(key);
+  auto &partition = partitions_[PartitionOf(hash)];
+  if (partition.spilled_) {
+    WriteSpilled(left_batch_.GetTuple(left_row_), &partition.probe_pages_, &partition.probe_page_);
+    probing_ = false;
+    return;
+  }
+  if (partition.slots_.empty()) {
+    return;
+  }
+  probe_partition_ = &partition;
+  probe_hash_ = hash;
+  probe_key_ = std::move(key);
+  probe_slot_ = (hash >> HASH_JOIN_PARTITION_BITS) & (partition.slots_.size() - 1);
+}
+
+auto HashJoinExecutor::NextMatch() -> const Tuple * {
+  if (probe_partition_ == nullptr) {
+    return nullptr;
+  }
+  const auto &slots = probe_partition_->slots_;
+  auto mask = slots.size() - 1;
+  // the table is at most half full, so the run of slots ends before wrapping around to where it began
+  while (slots[probe_slot_].tuple_idx_ != EMPTY_SLOT) {
+    const auto &slot = slots[probe_slot_];
+    probe_slot_ = (probe_slot_ + 1) & mask;
+    if (slot.hash_ == probe_hash_ &&
+        probe_partition_->keys_[slot.tuple_idx_].CompareEquals(probe_key_) == CmpBool::CmpTrue) {
+      return &probe_partition_->tuples_[slot.tuple_idx_];
+    }
+  }
+  return nullptr;
+}
+
+void HashJoinExecutor::ReleasePartitions() {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  for (auto &partition : partitions_) {
+    FinishSpilled(&partition.build_page_);
+    FinishSpilled(&partition.probe_page_);
+    for (auto page_id : partition.build_pages_) {
+      bpm->DeletePage(page_id);
+    }
+    for (auto page_id : partition.probe_pages_) {
+      bpm->DeletePage(page_id);
+    }
+  }
+  partitions_.clear();
+  loaded_ = nullptr;
+  probe_partition_ = nullptr;
+  probing_ = false;
+}
+
+void HashJoinExecutor::AppendJoined(TupleBatch *batch, const Tuple *right_tuple) const {
+  const auto &left_schema = left_child_->GetOutputSchema();
+  const auto &right_schema = right_child_->GetOutputSchema();
+  uint32_t col = 0;
+  for (uint32_t i = 0; i < left_schema.GetColumnCount(); i++) {
+    batch->GetColumn(col++).AppendFrom(left_batch_.GetColumn(i), left_row_);
+  }
+  for (uint32_t i = 0; i < right_schema.GetColumnCount(); i++) {
+    if (right_tuple == nullptr) {
+      batch->GetColumn(col++).AppendNull();
+    } else {
+      batch->GetColumn(col++).Append(right_tuple->GetValue(&right_schema, i));
+    }
+  }
+  batch->EndRow();
+}
 
 }  // namespace bustub
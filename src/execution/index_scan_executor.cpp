@@ -9,30 +9,92 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include "execution/executors/index_scan_executor.h"
 
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-     : AbstractExecutor(exec_ctx),plan_{plan},iter_{BPlusTreeIndexIteratorForOneIntegerColumn(nullptr, nullptr)} {
+     : AbstractExecutor(exec_ctx),plan_{plan} {
         this->checking_index_ = this->exec_ctx_->GetCatalog()->GetIndex(plan->index_oid_);
         this->checking_table_ = this->exec_ctx_->GetCatalog()->GetTable(checking_index_->table_name_);
-        this->tree_ = dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(checking_index_->index_.get());
-        this->iter_ = tree_->GetBeginIterator();
     }
 
+template <size_t KeySize>
+auto IndexScanExecutor::ScanTree(Index *index) -> bool {
+    auto *tree = dynamic_cast<BPlusTreeIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>> *>(index);
+    if(tree == nullptr){
+        return false;
+    }
+    auto *key_schema = checking_index_->index_->GetKeySchema();
+    std::optional<GenericKey<KeySize>> lower_key;
+    if(!plan_->lower_bound_.empty()){
+        lower_key.emplace();
+        lower_key->SetFromKey(Tuple(plan_->lower_bound_, key_schema));
+    }
+    std::optional<GenericKey<KeySize>> upper_key;
+    if(!plan_->upper_bound_.empty()){
+        upper_key.emplace();
+        upper_key->SetFromKey(Tuple(plan_->upper_bound_, key_schema));
+    }
+    // keys equal to an exclusive lower bound are only at the start of the scan, keys past the upper bound end it
+    next_rid_ = [iter = lower_key.has_value() ? tree->GetBeginIterator(*lower_key) : tree->GetBeginIterator(),
+                 lower_key, upper_key, comparator = GenericComparator<KeySize>(key_schema),
+                 lower_inclusive = plan_->lower_inclusive_ || !lower_key.has_value(),
+                 upper_inclusive = plan_->upper_inclusive_](RID *rid) mutable {
+        while(!lower_inclusive && !iter.IsEnd() && comparator((*iter).first, *lower_key) == 0){
+            ++iter;
+        }
+        lower_inclusive = true;
+        if(iter.IsEnd()){
+            return false;
+        }
+        if(upper_key.has_value()){
+            int cmp = comparator((*iter).first, *upper_key);
+            if(cmp > 0 || (cmp == 0 && !upper_inclusive)){
+                return false;
+            }
+        }
+        *rid = (*iter).second;
+        ++iter;
+        return true;
+    };
+    return true;
+}
+
 void IndexScanExecutor::Init() { 
+    auto *index = checking_index_->index_.get();
+    if(checking_index_->index_type_ == IndexType::HashTableIndex){
+        // a hash index only finds the keys equal to a given one, the optimizer plans no other scan of it
+        if(plan_->lower_bound_.empty() || plan_->upper_bound_.empty() || !plan_->lower_inclusive_ ||
+           !plan_->upper_inclusive_){
+            throw NotImplementedException("hash indexes only support equality lookups");
+        }
+        std::vector<RID> rids;
+        index->ScanKey(Tuple(plan_->lower_bound_, index->GetKeySchema()), &rids, exec_ctx_->GetTransaction());
+        next_rid_ = [rids = std::move(rids), next = size_t{0}](RID *rid) mutable {
+            if(next == rids.size()){
+                return false;
+            }
+            *rid = rids[next++];
+            return true;
+        };
+        return;
+    }
+    if(!ScanTree<4>(index) && !ScanTree<8>(index) && !ScanTree<16>(index) && !ScanTree<32>(index) &&
+       !ScanTree<64>(index)){
+        throw NotImplementedException("index scan only supports B+ tree indexes");
+    }
 }
 
 auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { 
-    if(iter_ == tree_->GetEndIterator()){
+    if(!next_rid_(rid)){
         return false;
-    } else {
-        *rid = (*iter_).second;
-        checking_table_->table_->GetTuple(*rid, tuple, exec_ctx_->GetTransaction());
-        ++iter_;
-
-        return true;
     }
+    checking_table_->table_->GetTuple(*rid, tuple, exec_ctx_->GetTransaction());
+    return true;
 }
 
 }  // namespace bustub
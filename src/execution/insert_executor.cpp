@@ -41,7 +41,8 @@ auto InsertExecutor::Next(Tuple *tuple, RID *rid) -> bool {
         txn = exec_ctx_->GetTransaction();
         checking_table_->table_->InsertTuple(child_tuple,rid,txn);
         for(auto &temp : index_info_){
-            temp->index_->InsertEntry(child_tuple,*rid,txn);
+            auto key = child_tuple.KeyFromTuple(checking_table_->schema_, temp->key_schema_, temp->index_->GetKeyAttrs());
+            temp->index_->InsertEntry(key,*rid,txn);
         }
         status = child_executor_->Next(&child_tuple,rid);
         count++;
@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_queue.cpp
+//
+// Identification: src/execution/morsel_queue.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/morsel_queue.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "storage/page/table_page.h"
+
+namespace bustub {
+
+MorselQueue::MorselQueue(TableHeap *table_heap, BufferPoolManager *bpm, Transaction *txn, size_t pages_per_morsel)
+    : table_heap_(table_heap),
+      bpm_(bpm),
+      txn_(txn),
+      pages_per_morsel_(pages_per_morsel) {
+  table_heap_->GetPageIds(&page_ids_);
+}
+
+auto MorselQueue::Next(Morsel *morsel) -> bool {
+  auto first = next_.fetch_add(pages_per_morsel_);
+  if (first >= page_ids_.size()) {
+    return false;
+  }
+  morsel->page_ids_ = page_ids_.data() + first;
+  morsel->page_count_ = std::min(pages_per_morsel_, page_ids_.size() - first);
+  return true;
+}
+
+void MorselQueue::ReadPage(page_id_t page_id, std::vector<Tuple> *tuples) {
+  tuples->clear();
+  auto page = static_cast<TablePage *>(bpm_->FetchPage(page_id, AccessType::Scan));
+  BUSTUB_ENSURE(page != nullptr, "BPM full");
+  page->RLatch();
+  RID rid;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    // the page is latched already, see TableIterator
+    Tuple tuple;
+    if (!table_heap_->GetTuple(rid, &tuple, txn_, false, AccessType::Scan)) {
+      page->RUnlatch();
+      bpm_->UnpinPage(page_id, false);
+      throw bustub::Exception("read non-existing tuple");
+    }
+    tuples->push_back(std::move(tuple));
+  }
+  page->RUnlatch();
+  bpm_->UnpinPage(page_id, false);
+}
+
+}  // namespace bustub
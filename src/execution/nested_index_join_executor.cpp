@@ -24,11 +24,33 @@ NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const Ne
   }
   index_info_ = this->exec_ctx_->GetCatalog()->GetIndex(plan_->index_oid_);
   table_info_ = this->exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_);
-  tree_ = dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(index_info_->index_.get());
 }
 
 void NestIndexJoinExecutor::Init() { 
   child_->Init();
+  outer_batch_.clear();
+  inner_rids_.clear();
+  cursor_ = 0;
+  match_ = 0;
+}
+
+auto NestIndexJoinExecutor::FillOuterBatch() -> bool {
+  Transaction *txn = exec_ctx_->GetTransaction();
+  outer_batch_.clear();
+  cursor_ = 0;
+  std::vector<Tuple> keys;
+  Tuple left_tuple{};
+  RID lrid{};
+  while(outer_batch_.size() < static_cast<size_t>(INDEX_JOIN_BATCH_SIZE) && child_->Next(&left_tuple,&lrid)){
+    auto v = plan_->KeyPredicate()->Evaluate(&left_tuple, child_->GetOutputSchema());
+    keys.emplace_back(std::vector<Value>{v}, index_info_->index_->GetKeySchema());
+    outer_batch_.push_back(left_tuple);
+  }
+  if(outer_batch_.empty()){
+    return false;
+  }
+  index_info_->index_->ScanKeys(keys, &inner_rids_, txn);
+  return true;
 }
 
 auto NestIndexJoinExecutor::NULLLeftJoin(Tuple *tuple) -> Tuple{
@@ -59,21 +81,19 @@ auto NestIndexJoinExecutor::InnerJoin(Tuple *left_tuple, Tuple *right_tuple) ->
 
 auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { 
   Transaction *txn = exec_ctx_->GetTransaction();
-  Tuple left_tuple{};
   Tuple right_tuple{};
-  RID lrid{};
-  std::vector<Value> values;
-  std::vector<RID> right_rids;
-  while(child_->Next(&left_tuple,&lrid)){
-    auto v = plan_->KeyPredicate()->Evaluate(&left_tuple, child_->GetOutputSchema());
-    tree_->ScanKey(Tuple{{v}, index_info_->index_->GetKeySchema()}, &right_rids,txn);
-    if(!right_rids.empty()){
-      table_info_->table_->GetTuple(right_rids[0],&right_tuple, txn);
+  while(cursor_ < outer_batch_.size() || FillOuterBatch()){
+    auto &left_tuple = outer_batch_[cursor_];
+    const auto &right_rids = inner_rids_[cursor_];
+    if(match_ < right_rids.size()){
+      table_info_->table_->GetTuple(right_rids[match_++],&right_tuple, txn);
       *tuple = InnerJoin(&left_tuple,&right_tuple);
       *rid = tuple->GetRid();
       return true;
     }
-    if(plan_->GetJoinType() == JoinType::LEFT){
+    cursor_++;
+    match_ = 0;
+    if(right_rids.empty() && plan_->GetJoinType() == JoinType::LEFT){
       *tuple = NULLLeftJoin(&left_tuple);
       *rid = tuple->GetRid();
       return true;
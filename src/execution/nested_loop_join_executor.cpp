@@ -20,7 +20,8 @@ namespace bustub {
 NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
                                                std::unique_ptr<AbstractExecutor> &&left_executor,
                                                std::unique_ptr<AbstractExecutor> &&right_executor)
-    : AbstractExecutor(exec_ctx),plan_{plan},lchild_(std::move(left_executor)),rchild_(std::move(right_executor)) {
+    : AbstractExecutor(exec_ctx),plan_{plan},lchild_(std::move(left_executor)),rchild_(std::move(right_executor)),
+      predicate_(plan->predicate_,lchild_->GetOutputSchema(),&rchild_->GetOutputSchema()) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
@@ -70,10 +71,7 @@ auto NestedLoopJoinExecutor::InnerJoin(Tuple *left_tuple, Tuple *right_tuple) ->
 };
 
 auto NestedLoopJoinExecutor::Matched(Tuple *left_tuple, Tuple *right_tuple) const -> bool {
-  auto value = plan_->Predicate().EvaluateJoin(left_tuple, lchild_->GetOutputSchema(), right_tuple,
-                                               rchild_->GetOutputSchema());
-
-  return !value.IsNull() && value.GetAs<bool>();
+  return predicate_.EvaluateJoinPredicate(left_tuple,right_tuple);
 };
 
 auto NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { 
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_pipeline.cpp
+//
+// Identification: src/execution/parallel_pipeline.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/parallel_pipeline.h"
+
+#include <utility>
+#include <vector>
+
+#include "execution/executors/filter_executor.h"
+#include "execution/executors/projection_executor.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+
+namespace bustub {
+
+auto ParallelPipeline::GetScan(const AbstractPlanNodeRef &plan) -> const AbstractPlanNode * {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan:
+      return plan.get();
+    case PlanType::Filter:
+    case PlanType::Projection:
+      return GetScan(plan->GetChildAt(0));
+    default:
+      return nullptr;
+  }
+}
+
+auto ParallelPipeline::CanRun(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan) -> bool {
+  return exec_ctx->GetParallelism() > 1 && GetScan(plan) != nullptr;
+}
+
+auto ParallelPipeline::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan,
+                                      MorselQueue *morsels) -> std::unique_ptr<AbstractExecutor> {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan:
+      return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan.get()), morsels);
+    case PlanType::Filter: {
+      const auto *filter_plan = dynamic_cast<const FilterPlanNode *>(plan.get());
+      auto child = CreateExecutor(exec_ctx, filter_plan->GetChildPlan(), morsels);
+      return std::make_unique<FilterExecutor>(exec_ctx, filter_plan, std::move(child));
+    }
+    case PlanType::Projection: {
+      const auto *projection_plan = dynamic_cast<const ProjectionPlanNode *>(plan.get());
+      auto child = CreateExecutor(exec_ctx, projection_plan->GetChildPlan(), morsels);
+      return std::make_unique<ProjectionExecutor>(exec_ctx, projection_plan, std::move(child));
+    }
+    default:
+      UNREACHABLE("not a pipeline");
+  }
+}
+
+void ParallelPipeline::Run(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan,
+                           const std::function<void(size_t, AbstractExecutor *)> &sink) {
+  const auto *scan_plan = dynamic_cast<const SeqScanPlanNode *>(GetScan(plan));
+  auto *table_info = exec_ctx->GetCatalog()->GetTable(scan_plan->GetTableOid());
+  MorselQueue morsels(table_info->table_.get(), exec_ctx->GetBufferPoolManager(), exec_ctx->GetTransaction());
+
+  // The executor trees are built here, the catalog is not to be read from several threads
+  auto workers = exec_ctx->GetParallelism();
+  std::vector<std::unique_ptr<AbstractExecutor>> executors;
+  executors.reserve(workers);
+  for (size_t worker = 0; worker < workers; worker++) {
+    executors.push_back(CreateExecutor(exec_ctx, plan, &morsels));
+  }
+  exec_ctx->GetWorkerPool()->Run(workers, [&](size_t worker) {
+    executors[worker]->Init();
+    sink(worker, executors[worker].get());
+  });
+}
+
+}  // namespace bustub
@@ -5,7 +5,12 @@ namespace bustub {
 
 ProjectionExecutor::ProjectionExecutor(ExecutorContext *exec_ctx, const ProjectionPlanNode *plan,
                                        std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
+  exprs_.reserve(plan_->GetExpressions().size());
+  for (const auto &expr : plan_->GetExpressions()) {
+    exprs_.emplace_back(expr, child_executor_->GetOutputSchema());
+  }
+}
 
 void ProjectionExecutor::Init() {
   // Initialize the child executor
@@ -25,12 +30,27 @@ auto ProjectionExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   // Compute expressions
   std::vector<Value> values{};
   values.reserve(GetOutputSchema().GetColumnCount());
-  for (const auto &expr : plan_->GetExpressions()) {
-    values.push_back(expr->Evaluate(&child_tuple, child_executor_->GetOutputSchema()));
+  for (const auto &expr : exprs_) {
+    values.push_back(expr.Evaluate(&child_tuple));
   }
 
   *tuple = Tuple{values, &GetOutputSchema()};
 
   return true;
 }
+
+auto ProjectionExecutor::NextBatch(TupleBatch *batch) -> bool {
+  if (!child_executor_->NextBatch(&child_batch_)) {
+    return false;
+  }
+
+  // Compute each expression over the whole batch
+  batch->Reset(&GetOutputSchema());
+  for (uint32_t i = 0; i < exprs_.size(); i++) {
+    exprs_[i].EvaluateBatch(child_batch_, &batch->GetColumn(i));
+  }
+  batch->CopyRids(child_batch_);
+
+  return true;
+}
 }  // namespace bustub
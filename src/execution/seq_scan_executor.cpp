@@ -14,15 +14,43 @@
 
 namespace bustub {
 
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx),plan_(plan) {
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan, MorselQueue *morsels)
+    : AbstractExecutor(exec_ctx),plan_(plan),morsels_(morsels) {
     this->checking_table_ = this->exec_ctx_->GetCatalog()->GetTable(plan->table_oid_);
 }
 
 void SeqScanExecutor::Init() { 
+    if(morsels_ != nullptr){
+        // the morsels are handed out as the workers go, they cannot be scanned again
+        morsel_ = Morsel{};
+        page_tuples_.clear();
+        page_idx_ = 0;
+        return;
+    }
     iter_ = checking_table_->table_->Begin(exec_ctx_->GetTransaction());
 }
 
+auto SeqScanExecutor::NextMorselPage() -> bool {
+    if(morsel_.page_count_ == 0 && !morsels_->Next(&morsel_)){
+        return false;
+    }
+    morsels_->ReadPage(*morsel_.page_ids_++, &page_tuples_);
+    morsel_.page_count_--;
+    page_idx_ = 0;
+    return true;
+}
+
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { 
+    if(morsels_ != nullptr){
+        while(page_idx_ >= page_tuples_.size()){
+            if(!NextMorselPage()){
+                return false;
+            }
+        }
+        *tuple = std::move(page_tuples_[page_idx_++]);
+        *rid = tuple->GetRid();
+        return true;
+    }
     if(iter_ == checking_table_->table_->End()){
         return false;
     } else {
@@ -33,4 +61,24 @@ auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     }
 }
 
+auto SeqScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+    batch->Reset(&GetOutputSchema());
+    if(morsels_ != nullptr){
+        while(!batch->IsFull()){
+            if(page_idx_ >= page_tuples_.size() && !NextMorselPage()){
+                break;
+            }
+            for(; page_idx_ < page_tuples_.size() && !batch->IsFull(); page_idx_++){
+                batch->AppendTuple(page_tuples_[page_idx_], page_tuples_[page_idx_].GetRid());
+            }
+        }
+        return batch->Size() > 0;
+    }
+    while(!batch->IsFull() && iter_ != checking_table_->table_->End()){
+        batch->AppendTuple(*iter_, iter_->GetRid());
+        ++iter_;
+    }
+    return batch->Size() > 0;
+}
+
 }  // namespace bustub
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/tuple_batch.h"
+
+#include "common/exception.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+void ColumnVector::Reset(TypeId type) {
+  type_ = type;
+  size_ = 0;
+  nulls_.clear();
+  integers_.clear();
+  decimals_.clear();
+  varchars_.clear();
+}
+
+auto ColumnVector::GetValue(size_t row) const -> Value {
+  if (IsNull(row)) {
+    return ValueFactory::GetNullValueByType(type_);
+  }
+  switch (type_) {
+    case TypeId::BOOLEAN:
+      return ValueFactory::GetBooleanValue(static_cast<int8_t>(integers_[row]));
+    case TypeId::TINYINT:
+      return ValueFactory::GetTinyIntValue(static_cast<int8_t>(integers_[row]));
+    case TypeId::SMALLINT:
+      return ValueFactory::GetSmallIntValue(static_cast<int16_t>(integers_[row]));
+    case TypeId::INTEGER:
+      return ValueFactory::GetIntegerValue(static_cast<int32_t>(integers_[row]));
+    case TypeId::BIGINT:
+      return ValueFactory::GetBigIntValue(integers_[row]);
+    case TypeId::TIMESTAMP:
+      return ValueFactory::GetTimestampValue(integers_[row]);
+    case TypeId::DECIMAL:
+      return ValueFactory::GetDecimalValue(decimals_[row]);
+    case TypeId::VARCHAR:
+      return ValueFactory::GetVarcharValue(varchars_[row]);
+    default:
+      throw Exception(ExceptionType::MISMATCH_TYPE, "column vector of an unsupported type");
+  }
+}
+
+void ColumnVector::AppendNull() {
+  if (IsIntegral(type_)) {
+    integers_.push_back(0);
+  } else if (type_ == TypeId::DECIMAL) {
+    decimals_.push_back(0);
+  } else {
+    varchars_.emplace_back();
+  }
+  AppendNotNull();
+  nulls_.back() |= uint64_t{1} << ((size_ - 1) % 64);
+}
+
+void ColumnVector::Append(const Value &value) {
+  if (value.IsNull()) {
+    AppendNull();
+    return;
+  }
+  switch (type_) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      AppendInteger(value.GetAs<int8_t>());
+      break;
+    case TypeId::SMALLINT:
+      AppendInteger(value.GetAs<int16_t>());
+      break;
+    case TypeId::INTEGER:
+      AppendInteger(value.GetAs<int32_t>());
+      break;
+    case TypeId::BIGINT:
+      AppendInteger(value.GetAs<int64_t>());
+      break;
+    case TypeId::TIMESTAMP:
+      AppendInteger(static_cast<int64_t>(value.GetAs<uint64_t>()));
+      break;
+    case TypeId::DECIMAL:
+      AppendDecimal(value.GetAs<double>());
+      break;
+    case TypeId::VARCHAR:
+      AppendVarchar(std::string(value.GetData(), value.GetLength() - 1));
+      break;
+    default:
+      throw Exception(ExceptionType::MISMATCH_TYPE, "column vector of an unsupported type");
+  }
+}
+
+void ColumnVector::AppendFrom(const ColumnVector &other, size_t row) {
+  if (other.IsNull(row)) {
+    AppendNull();
+  } else if (IsIntegral(type_)) {
+    AppendInteger(other.integers_[row]);
+  } else if (type_ == TypeId::DECIMAL) {
+    AppendDecimal(other.decimals_[row]);
+  } else {
+    AppendVarchar(other.varchars_[row]);
+  }
+}
+
+void TupleBatch::Reset(const Schema *schema) {
+  schema_ = schema;
+  columns_.resize(schema->GetColumnCount());
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].Reset(schema->GetColumn(i).GetType());
+  }
+  rids_.clear();
+}
+
+void TupleBatch::AppendTuple(const Tuple &tuple, const RID &rid) {
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].Append(tuple.GetValue(schema_, i));
+  }
+  rids_.push_back(rid);
+}
+
+void TupleBatch::AppendRow(const TupleBatch &other, size_t row) {
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].AppendFrom(other.columns_[i], row);
+  }
+  rids_.push_back(other.rids_[row]);
+}
+
+auto TupleBatch::GetTuple(size_t row) const -> Tuple {
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values.push_back(column.GetValue(row));
+  }
+  return Tuple{values, schema_};
+}
+
+}  // namespace bustub
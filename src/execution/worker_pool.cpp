@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// worker_pool.cpp
+//
+// Identification: src/execution/worker_pool.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/worker_pool.h"
+
+#include <exception>
+
+namespace bustub {
+
+WorkerPool::~WorkerPool() {
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::Run(size_t workers, const std::function<void(size_t)> &task) {
+  std::mutex done_latch;
+  std::condition_variable done_cv;
+  size_t running = workers;
+  std::exception_ptr error;
+
+  {
+    std::scoped_lock lock(latch_);
+    // a thread for every task, so that all the workers of a query run at once
+    while (threads_.size() < workers) {
+      threads_.emplace_back([this] { WorkerLoop(); });
+    }
+    for (size_t worker = 0; worker < workers; worker++) {
+      jobs_.emplace_back([&, worker] {
+        try {
+          task(worker);
+        } catch (...) {
+          std::scoped_lock done_lock(done_latch);
+          if (error == nullptr) {
+            error = std::current_exception();
+          }
+        }
+        std::scoped_lock done_lock(done_latch);
+        if (--running == 0) {
+          done_cv.notify_one();
+        }
+      });
+    }
+  }
+  cv_.notify_all();
+
+  std::unique_lock done_lock(done_latch);
+  done_cv.wait(done_lock, [&] { return running == 0; });
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+void WorkerPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock lock(latch_);
+      cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+      if (jobs_.empty()) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    job();
+  }
+}
+
+}  // namespace bustub
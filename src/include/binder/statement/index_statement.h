@@ -21,7 +21,8 @@ namespace bustub {
 class IndexStatement : public BoundStatement {
  public:
   explicit IndexStatement(std::string index_name, std::unique_ptr<BoundBaseTableRef> table,
-                          std::vector<std::unique_ptr<BoundColumnRef>> cols);
+                          std::vector<std::unique_ptr<BoundColumnRef>> cols, bool compressed = false,
+                          std::string index_type = "btree");
 
   /** Name of the index */
   std::string index_name_;
@@ -32,6 +33,12 @@ class IndexStatement : public BoundStatement {
   /** Name of the columns */
   std::vector<std::unique_ptr<BoundColumnRef>> cols_;
 
+  /** Whether the index pages are compressed, `WITH (compression)` */
+  bool compressed_;
+
+  /** The data structure of the index, `btree` or `hash` from `USING HASH` */
+  std::string index_type_;
+
   auto ToString() const -> std::string override;
 };
 
@@ -15,6 +15,7 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
@@ -30,6 +31,8 @@ class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
+  /** Reads the id of the page that follows a page in a linked list of pages, e.g. TablePage::GetNextPageId. */
+  using next_page_fn = page_id_t (*)(Page *page);
 
   BufferPoolManager() = default;
   /**
@@ -45,6 +48,20 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetch a page, telling the buffer pool how it is going to be used.
+   * @param page_id id of the page to fetch
+   * @param access_type the access hint, see AccessType
+   * @param callback grading callback, may be nullptr
+   * @return the requested page, or nullptr if it cannot be fetched
+   */
+  auto FetchPage(page_id_t page_id, AccessType access_type, bufferpool_callback_fn callback = nullptr) -> Page * {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto *result = FetchPgImp(page_id, access_type);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
   /** Grading function. Do not modify! */
   auto UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -87,6 +104,36 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /**
+   * Start reading pages into the buffer pool in the background. This is only a hint: nothing is pinned for the
+   * caller, and pages that cannot get a frame right away are skipped. The default implementation ignores it.
+   * @param page_ids ids of the pages that are going to be fetched soon
+   * @param access_type the hint the pages are going to be fetched with
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown) {}
+
+  /**
+   * Prefetch page_id and the pages following it in a linked list of pages, up to count pages in total. The id of each
+   * next page is only known once the page before it is in memory, so the chain is read one page at a time in the
+   * background. The default implementation ignores it.
+   * @param page_id the first page to prefetch, may be INVALID_PAGE_ID
+   * @param count the number of pages to prefetch
+   * @param next_page reads the id of the next page from a page of the chain
+   * @param access_type the hint the pages are going to be fetched with
+   */
+  virtual void PrefetchChain(page_id_t page_id, size_t count, next_page_fn next_page,
+                             AccessType access_type = AccessType::Unknown) {}
+
+  /**
+   * Find a page that is in memory without pinning or latching it, for optimistic readers. The page can change or be
+   * evicted at any time, so the caller must not trust what it reads until Page::ValidateVersion(*version) succeeds.
+   * The default implementation never finds anything, so callers fall back to FetchPage.
+   * @param page_id id of the page
+   * @param[out] version the version of the page to validate against
+   * @return the page, or nullptr if it is not in memory or is being written right now
+   */
+  virtual auto FetchPageOptimistic(page_id_t page_id, uint64_t *version) -> Page * { return nullptr; }
+
  // protected:
   /**
    * Grading function. Do not modify!
@@ -104,9 +151,10 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be used
    * @return the requested page
    */
-  virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
+  virtual auto FetchPgImp(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page * = 0;
 
   /**
    * Unpin the target page from the buffer pool.
@@ -12,14 +12,18 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "buffer/lru_k_replacer.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
+#include "container/hash/page_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -41,6 +45,19 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
                             LogManager *log_manager = nullptr);
 
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of this instance
+   * @param num_instances the total number of instances in the parallel buffer pool
+   * @param instance_index the index of this instance in the parallel buffer pool
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr);
+
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
    */
@@ -52,6 +69,59 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @brief Return the number of pages in the buffer pool that are dirty right now. */
+  auto GetDirtyPageCount() -> size_t;
+
+  /** @brief Return the number of pages written back by the background page cleaner so far. */
+  auto GetPagesCleaned() const -> size_t { return pages_cleaned_; }
+
+  /** @brief Return the number of evictions that had to write back a dirty victim on the caller's thread. */
+  auto GetSyncWriteEvictions() const -> size_t { return sync_write_evictions_; }
+
+  /** @brief Return the number of pages the prefetcher has read from disk so far. */
+  auto GetPagesPrefetched() const -> size_t { return pages_prefetched_; }
+
+  /**
+   * @brief Queue the pages that are not in memory yet for the prefetcher.
+   * @param page_ids ids of the pages that are going to be fetched soon
+   * @param access_type the hint the pages are going to be fetched with
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown) override;
+
+  /**
+   * @brief Queue a chain of pages for the prefetcher. Each page of the chain is pinned by the prefetcher just long
+   * enough to read the id of the next one, which is then handed to the prefetch router. Scans prefetch at most half of
+   * the scan ring ahead, so that the prefetched pages are not recycled before the scan gets to them.
+   * @param page_id the first page to prefetch, may be INVALID_PAGE_ID
+   * @param count the number of pages to prefetch
+   * @param next_page reads the id of the next page from a page of the chain
+   * @param access_type the hint the pages are going to be fetched with
+   */
+  void PrefetchChain(page_id_t page_id, size_t count, next_page_fn next_page,
+                     AccessType access_type = AccessType::Unknown) override;
+
+  /**
+   * @brief Look page_id up in the page table without the latch, pinning it or recording an access. The frame's
+   * version changes whenever it is reused for another page, so a stale frame fails validation.
+   * @param page_id id of the page
+   * @param[out] version the version of the page to validate against
+   * @return the page, or nullptr if it is not in memory or is being written right now
+   */
+  auto FetchPageOptimistic(page_id_t page_id, uint64_t *version) -> Page * override;
+
+  /**
+   * @brief Set the buffer pool the prefetcher hands the rest of a chain to. A ParallelBufferPoolManager sets itself,
+   * because the next page of a chain may belong to another instance.
+   * @param router the buffer pool that routes prefetch requests, this instance by default
+   */
+  void SetPrefetchRouter(BufferPoolManager *router) { prefetch_router_ = router; }
+
+  /**
+   * @brief Stop the prefetcher thread and drop the queued requests. Prefetch requests are ignored afterwards. Called by
+   * the destructor, and by a ParallelBufferPoolManager before it destroys any of its instances.
+   */
+  void StopPrefetcher();
+
  protected:
   /**
    * TODO(P1): Add implementation
@@ -85,10 +155,13 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    *
    * In addition, remember to disable eviction and record the access history of the frame like you did for NewPgImp().
    *
+   * A page that misses with AccessType::Scan is loaded into the scan ring instead, see scan_ring_.
+   *
    * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be used
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
    */
-  auto FetchPgImp(page_id_t page_id) -> Page * override;
+  auto FetchPgImp(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page * override;
 
   /**
    * TODO(P1): Add implementation
@@ -121,7 +194,7 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the pages in the buffer pool to disk, then sync the disk manager.
    */
   void FlushAllPgsImp() override;
 
@@ -142,10 +215,12 @@ class BufferPoolManagerInstance : public BufferPoolManager {
 
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+  /** The next page id to be allocated, only ids congruent to instance_index_ are handed out by this instance */
+  std::atomic<page_id_t> next_page_id_ = instance_index_;
 
   /** Array of buffer pool pages. */
   Page *pages_;
@@ -153,21 +228,102 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   DiskManager *disk_manager_;
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_;
-  /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  /** Page table for keeping track of buffer pool pages. Lookups are lock-free; it is only modified under latch_. */
+  PageTable *page_table_;
   /** Replacer to find unpinned pages for replacement. */
   LRUKReplacer *replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch serializes the slow paths: misses, evictions, deletions, flushes and the page cleaner. It protects the
+   * free list, writing_back_ and the page cleaner state, and every change to the page table and to a page's id. Hits
+   * and unpins do not take it; they pin and unpin with atomic operations on the page's pin count, see TryPinResident.
+   * It is never held while reading from or writing to disk on a miss; see FrameIoState.
+   */
   std::mutex latch_;
 
+  /** Per-frame state for the disk I/O that runs without latch_ held, and for the scan ring. */
+  struct FrameIoState {
+    /** True while the frame is writing back its old page or loading its new page. */
+    std::atomic<bool> io_in_progress_{false};
+    /** True while the page cleaner or FlushPgImp is writing out the frame. */
+    bool cleaning_{false};
+    /** Notified, with latch_ held, when io_in_progress_ or cleaning_ goes back to false. */
+    std::condition_variable io_done_;
+    /** The slot of scan_ring_ holding this frame, or -1. Any fetch that is not a scan takes the frame out of the ring. */
+    std::atomic<int> scan_ring_slot_{-1};
+  };
+  /** Array of I/O states, indexed by frame id like pages_. */
+  FrameIoState *frame_io_;
+  /** Evicted dirty pages whose write-back is still in flight, mapped to the frame doing the write. */
+  std::unordered_map<page_id_t, frame_id_t> writing_back_;
+
+  /**
+   * Frames lent to sequential scans, in the style of PostgreSQL's buffer access strategies. A scan miss reuses the
+   * frame in the next slot of the ring if that frame is unpinned and no other kind of access has touched it, instead of
+   * evicting from the replacer. So a scan over a large table only ever takes scan_ring_.size() frames from the rest of
+   * the pool. Empty slots hold -1. Protected by latch_.
+   */
+  std::vector<frame_id_t> scan_ring_;
+  /** The slot of scan_ring_ the next scan miss goes to. */
+  size_t scan_ring_next_{0};
+
+  /** Number of free or clean unpinned frames the page cleaner tries to keep ready for eviction. */
+  const size_t clean_frame_target_;
+  /** Background thread writing back dirty frames, see RunPageCleaner. */
+  std::thread page_cleaner_;
+  /** Set, with latch_ held, to make the page cleaner exit. */
+  bool stop_page_cleaner_{false};
+  /** Wakes up the page cleaner before its interval expires. */
+  std::condition_variable page_cleaner_cv_;
+  /**
+   * Number of frames the page cleaner and FlushPgImp have pinned, and read latched, to write them out. They are let go
+   * of without waiting on anything, so AcquireFrame may wait for them.
+   */
+  size_t frames_being_cleaned_{0};
+  /** Notified, with latch_ held, when the page cleaner or FlushPgImp unpins the frames it wrote. */
+  std::condition_variable cleaning_done_;
+  /** Pages written back by the page cleaner. */
+  std::atomic<size_t> pages_cleaned_{0};
+  /** Evictions that wrote back a dirty victim synchronously. */
+  std::atomic<size_t> sync_write_evictions_{0};
+
+  /** A page, or a chain of pages, the prefetcher should read. */
+  struct PrefetchRequest {
+    page_id_t page_id_;
+    /** Number of pages to prefetch, starting with page_id_. */
+    size_t count_;
+    /** Reads the next page id of the chain, nullptr if count_ is 1. */
+    next_page_fn next_page_;
+    AccessType access_type_;
+  };
+  /** Requests waiting for the prefetcher, at most prefetch_queue_limit_. Protected by latch_. */
+  std::deque<PrefetchRequest> prefetch_queue_;
+  const size_t prefetch_queue_limit_;
+  /** Background thread reading the prefetched pages, see RunPrefetcher. */
+  std::thread prefetcher_;
+  /** Set, with latch_ held, to make the prefetcher exit. */
+  bool stop_prefetcher_{false};
+  /** Notified when a request is queued. */
+  std::condition_variable prefetch_cv_;
+  /** The buffer pool the next pages of a chain are handed to. */
+  BufferPoolManager *prefetch_router_{this};
+  /** Pages read from disk by the prefetcher. */
+  std::atomic<size_t> pages_prefetched_{0};
+
   /**
    * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
    * @return the id of the allocated page
    */
   auto AllocatePage() -> page_id_t;
 
+  /**
+   * @brief Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions
+   * to validate input data and ensure that a parallel BPM is routing requests to the correct BPI.
+   * @param page_id the page id to validate
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
   /**
    * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
    * @param page_id id of the page to deallocate
@@ -176,6 +332,121 @@ class BufferPoolManagerInstance : public BufferPoolManager {
     // This is a no-nop right now without a more complex data structure to track deallocated pages
   }
 
-  // TODO(student): You may add additional private members and helper functions
+  /**
+   * @brief Take a frame from the free list, or evict one from the replacer. Caller should acquire the latch before
+   * calling this function.
+   *
+   * The returned frame has a pin count of -1, so that no one can pin it until the caller installs the new page. The
+   * victim page is removed from the page table. If it is dirty it is recorded in writing_back_, and the caller
+   * must write it back with DoFrameIo before the frame memory is reused. If the only unpinned frames are the ones the
+   * page cleaner is writing out, waits for the page cleaner to release them. For AccessType::Scan, the next frame of
+   * the scan ring is reused if possible, and the returned frame takes its place in the ring.
+   *
+   * @param lock the lock on latch_ held by the caller
+   * @param[out] frame_id the acquired frame
+   * @param[out] victim_page_id the dirty page that still has to be written back, or INVALID_PAGE_ID
+   * @param access_type how the page loaded into the frame is going to be used
+   * @return false if all the frames are pinned
+   */
+  auto AcquireFrame(std::unique_lock<std::mutex> *lock, frame_id_t *frame_id, page_id_t *victim_page_id,
+                    AccessType access_type = AccessType::Unknown) -> bool;
+
+  /**
+   * @brief Take the frame in a slot of the scan ring, if it can be reused. Caller should acquire the latch before
+   * calling this function.
+   * @param ring_slot the slot of scan_ring_
+   * @param[out] frame_id the reclaimed frame, with a pin count of -1 and out of the replacer
+   * @return false if the slot is empty, or its frame is pinned or has left the ring
+   */
+  auto ReuseScanRingFrame(size_t ring_slot, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Pin a frame found in the page table without holding the latch. Fails if the frame is being reclaimed, or
+   * if it has been reused for another page since the lookup.
+   * @param frame_id the frame the page table returned
+   * @param page_id the page that was looked up
+   * @return true if the page is pinned
+   */
+  auto TryPinResident(frame_id_t frame_id, page_id_t page_id) -> bool;
+
+  /**
+   * @brief Record a fetch that hit a frame pinned by the caller. A scan touching a frame of the scan ring does not
+   * count as an access for the replacer, so that scanned pages stay first in line for eviction. Any other access takes
+   * the frame out of the ring.
+   * @param frame_id the pinned frame
+   * @param access_type the hint the page was fetched with
+   */
+  void RecordHit(frame_id_t frame_id, AccessType access_type);
+
+  /**
+   * @brief Drop one pin of a frame, and make it evictable if that was the last one.
+   * @param frame_id the frame to unpin
+   */
+  void ReleasePin(frame_id_t frame_id);
+
+  /**
+   * @brief Install page_id into a frame returned by AcquireFrame, pinned once and marked as doing I/O, and publish it
+   * in the page table. Caller should acquire the latch before calling this function.
+   */
+  void InstallPage(frame_id_t frame_id, page_id_t page_id, bool is_dirty);
+
+  /**
+   * @brief Do the disk I/O of a frame, with the latch released. The dirty victim (if any) is written back first,
+   * then the frame is zeroed and page_id is read from disk if requested. The latch is held again on return, and every
+   * thread waiting on the frame has been woken up.
+   * @param lock the lock on latch_ held by the caller
+   * @param frame_id the frame doing I/O
+   * @param victim_page_id the dirty page to write back, or INVALID_PAGE_ID
+   * @param page_id the page being loaded into the frame
+   * @param read_page true to read page_id from disk, false for a new page
+   */
+  void DoFrameIo(std::unique_lock<std::mutex> *lock, frame_id_t frame_id, page_id_t victim_page_id, page_id_t page_id,
+                 bool read_page);
+
+  /**
+   * @brief Block until no I/O is in flight on the frame. The latch is released while waiting.
+   * @param lock the lock on latch_ held by the caller
+   * @param frame_id the frame to wait on
+   */
+  void WaitForFrameIo(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
+
+  /**
+   * @brief Queue a prefetch request, unless the queue is full or the page is already in memory. Caller should acquire
+   * the latch before calling this function.
+   */
+  void EnqueuePrefetch(const PrefetchRequest &request);
+
+  /**
+   * @brief Bring the page of a prefetch request into memory and pin it. Caller should acquire the latch before calling
+   * this function; it is released while reading from disk.
+   * @param lock the lock on latch_ held by the caller
+   * @param request the request to serve
+   * @param[out] frame_id the frame holding the page
+   * @return false if the page could not be loaded
+   */
+  auto LoadPrefetchedPage(std::unique_lock<std::mutex> *lock, const PrefetchRequest &request, frame_id_t *frame_id)
+      -> bool;
+
+  /**
+   * @brief Bring the pages of the given prefetch requests, and of all the single page requests queued behind them,
+   * into memory without pinning them. All their disk I/O is in flight at once. Caller should acquire the latch before
+   * calling this function; it is released while the pages are read.
+   * @param lock the lock on latch_ held by the caller
+   * @param requests single page requests taken off the queue
+   */
+  void LoadPrefetchedPages(std::unique_lock<std::mutex> *lock, std::vector<PrefetchRequest> *requests);
+
+  /**
+   * @brief Body of the prefetcher thread. Serves the prefetch requests in order, and hands the rest of every chain
+   * back to the prefetch router once the id of its next page is known.
+   */
+  void RunPrefetcher();
+
+  /**
+   * @brief Body of the page cleaner thread. Whenever fewer than clean_frame_target_ frames are free or clean and
+   * unpinned, copies a batch of dirty unpinned frames, writes the copies back without the latch held, and only then
+   * lets the frames be evicted again. Frames whose page read latch cannot be taken right away are left for later.
+   */
+  void RunPageCleaner();
 };
 }  // namespace bustub
@@ -12,10 +12,7 @@
 
 #pragma once
 
-#include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
 #include <vector>
 
 #include "common/config.h"
@@ -33,6 +30,12 @@ namespace bustub {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Frame ids are dense, so all the per-frame state lives in an array indexed by frame id. Evictable frames are
+ * threaded on two intrusive lists: the history list for frames with fewer than k accesses, and the cache list for the
+ * others. Non-evictable frames are not linked at all, so Evict never has to skip over them. A frame is appended to
+ * the most recent end of its list when it becomes evictable, and a cache frame moves there again on every access.
+ * Every operation is O(1) and allocates nothing.
  */
 class LRUKReplacer {
  public:
@@ -133,23 +136,51 @@ class LRUKReplacer {
   auto Size() -> size_t;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  [[maybe_unused]] size_t current_timestamp_{0};
+  /** Per-frame state, including the intrusive links of the list the frame is on. */
+  struct FrameEntry {
+    /** Number of accesses since the frame was last evicted or removed. */
+    size_t access_count_{0};
+    /** Previous frame in the list, towards the eviction end, or INVALID_FRAME_ID. */
+    frame_id_t prev_{INVALID_FRAME_ID};
+    /** Next frame in the list, towards the most recent end, or INVALID_FRAME_ID. */
+    frame_id_t next_{INVALID_FRAME_ID};
+    /** Whether the frame is evictable, in which case it is linked into history_list_ or cache_list_. */
+    bool evictable_{false};
+  };
+
+  /** An intrusive doubly linked list of frames. The head is the next victim. */
+  struct FrameList {
+    frame_id_t head_{INVALID_FRAME_ID};
+    frame_id_t tail_{INVALID_FRAME_ID};
+  };
+
+  static constexpr frame_id_t INVALID_FRAME_ID = -1;
+
+  /** @brief Return the list an evictable frame is linked into. */
+  auto ListOf(frame_id_t frame_id) -> FrameList * {
+    return frames_[frame_id].access_count_ < k_ ? &history_list_ : &cache_list_;
+  }
+
+  /** @brief Append frame_id at the most recent end of list. */
+  void PushBack(FrameList *list, frame_id_t frame_id);
+
+  /** @brief Unlink frame_id from list. */
+  void Unlink(FrameList *list, frame_id_t frame_id);
+
+  /** @brief Throw if frame_id is out of range. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
   size_t curr_size_{0};
   size_t replacer_size_;
   size_t k_;
   std::mutex latch_;
 
-  std::unordered_map<frame_id_t, size_t> access_count_;
-
-  std::list<frame_id_t> history_list_;
-  std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> history_map_;
-
-  std::list<frame_id_t> cache_list_;
-  std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> cache_map_;
-
-  std::unordered_map<frame_id_t, bool> is_evictable_;
+  /** Per-frame state, indexed by frame id. */
+  std::vector<FrameEntry> frames_;
+  /** Evictable frames with fewer than k accesses, in the order they became evictable. */
+  FrameList history_list_;
+  /** Evictable frames with at least k accesses, least recently used first. */
+  FrameList cache_list_;
 };
 
 }  // namespace bustub
\ No newline at end of file
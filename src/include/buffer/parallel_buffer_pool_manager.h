@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards the buffer pool into several independent BufferPoolManagerInstances.
+ *
+ * A page always lives in the instance `page_id % num_instances`, so every operation on an existing page only takes
+ * the latch of one shard. Each shard owns its own page table, replacer and free list. New pages are allocated in a
+ * round-robin fashion over the shards; every shard hands out page ids congruent to its index, so page ids stay unique
+ * across the whole pool.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @brief Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr);
+
+  /**
+   * @brief Destroys an existing ParallelBufferPoolManager and all of its instances.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @brief Return the total number of frames over all the instances. */
+  auto GetPoolSize() -> size_t override { return num_instances_ * instance_pool_size_; }
+
+  /** @brief Return the number of shards in this buffer pool. */
+  auto GetNumInstances() const -> size_t { return num_instances_; }
+
+  /**
+   * @brief Return the instance responsible for the given page.
+   * @param page_id id of the page
+   * @return the BufferPoolManagerInstance that owns page_id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /** @brief Return the number of dirty pages over all the instances. */
+  auto GetDirtyPageCount() -> size_t;
+
+  /** @brief Return the number of pages written back by the page cleaners of all the instances. */
+  auto GetPagesCleaned() const -> size_t;
+
+  /** @brief Return the number of evictions over all the instances that wrote back a dirty victim synchronously. */
+  auto GetSyncWriteEvictions() const -> size_t;
+
+  /** @brief Hand every page to the prefetcher of its owning instance. */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown) override;
+
+  /**
+   * @brief Hand a chain of pages to the prefetcher of the instance owning its first page. Every instance hands the
+   * rest of a chain back here, so the chain can cross instances.
+   */
+  void PrefetchChain(page_id_t page_id, size_t count, next_page_fn next_page,
+                     AccessType access_type = AccessType::Unknown) override;
+
+  /** @brief Look page_id up in its owning instance without pinning it. */
+  auto FetchPageOptimistic(page_id_t page_id, uint64_t *version) -> Page * override;
+
+ protected:
+  /** @brief Fetch page_id from its owning instance. */
+  auto FetchPgImp(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page * override;
+
+  /** @brief Unpin page_id in its owning instance. */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /** @brief Flush page_id in its owning instance. */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Create a new page. The instances are tried in a round-robin fashion, starting from a different
+   * instance on every call, until one of them is able to allocate a frame.
+   * @param[out] page_id id of the created page
+   * @return nullptr if every instance is full of pinned pages, otherwise pointer to the new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /** @brief Delete page_id from its owning instance. */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /** @brief Flush all the pages of every instance. */
+  void FlushAllPgsImp() override;
+
+ private:
+  /** Number of shards. */
+  const size_t num_instances_;
+  /** Number of frames in each shard. */
+  const size_t instance_pool_size_;
+  /** The shards, indexed by page_id % num_instances_. */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /** The shard NewPgImp starts probing from next time. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -40,6 +43,7 @@ class LogManager;
 class CheckpointManager;
 class Catalog;
 class ExecutionEngine;
+class WorkerPool;
 
 class ResultWriter {
  public:
@@ -211,9 +215,18 @@ class BustubInstance {
   auto MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext>;
 
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Create a BusTub instance backed by the given database file.
+   * @param db_file_name the database file
+   * @param bpm_instances the number of buffer pool shards; more than one uses a ParallelBufferPoolManager
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t bpm_instances = 1);
 
-  BustubInstance();
+  /**
+   * Create an in-memory BusTub instance.
+   * @param bpm_instances the number of buffer pool shards; more than one uses a ParallelBufferPoolManager
+   */
+  explicit BustubInstance(size_t bpm_instances = 1);
 
   ~BustubInstance();
 
@@ -252,6 +265,7 @@ class BustubInstance {
   CheckpointManager *checkpoint_manager_;
   Catalog *catalog_;
   ExecutionEngine *execution_engine_;
+  WorkerPool *worker_pool_;
   std::shared_mutex catalog_lock_;
 
   auto GetSessionVariable(const std::string &key) -> std::string {
@@ -266,6 +280,15 @@ class BustubInstance {
     return variable == "1" || variable == "true" || variable == "yes";
   }
 
+  /** @return the number of workers a query runs its pipelines on, as set by SET parallelism = N */
+  auto GetParallelism() -> size_t {
+    auto variable = GetSessionVariable("parallelism");
+    if (variable.empty() || !std::all_of(variable.begin(), variable.end(), ::isdigit)) {
+      return 1;
+    }
+    return std::clamp<size_t>(std::strtoull(variable.c_str(), nullptr, 10), 1, MAX_PARALLELISM);
+  }
+
  private:
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
@@ -21,9 +21,15 @@ namespace bustub {
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
 extern std::chrono::milliseconds cycle_detection_interval;
 
+/** The page cleaner of every buffer pool instance wakes up at least every PAGE_CLEANER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
 /** True if logging should be enabled, false otherwise. */
 extern std::atomic<bool> enable_logging;
 
+/** True if the buffer pool should act on prefetch requests, false to ignore them. */
+extern std::atomic<bool> enable_prefetch;
+
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
@@ -35,7 +41,25 @@ static constexpr int BUSTUB_PAGE_SIZE = 4096;
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
-static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int LRUK_REPLACER_K = 10;          // lookback window for lru-k replacer
+static constexpr int PAGE_CLEANER_BATCH_SIZE = 16;  // max dirty pages written back in one page cleaner round
+static constexpr int SCAN_RING_SIZE = 16;           // max frames a buffer pool instance lends to sequential scans
+static constexpr int READ_AHEAD_PAGES = 4;          // pages table and index iterators prefetch ahead of themselves
+static constexpr int URING_QUEUE_DEPTH = 64;        // max page requests in flight in an io_uring disk manager
+static constexpr int OPTIMISTIC_READ_RETRIES = 8;   // times a latch-free b+ tree read restarts before latching
+static constexpr double BTREE_FILL_FACTOR = 0.9;    // fraction of every b+ tree node a bulk load fills
+static constexpr int INDEX_JOIN_BATCH_SIZE = 128;   // outer tuples an index join looks up in the index at once
+static constexpr int HASH_JOIN_PARTITION_BITS = 4;  // a hash join splits its build side into 2^bits partitions
+static constexpr int HASH_JOIN_BUDGET = 4 << 20;    // bytes of build tuples a hash join holds before spilling
+static constexpr int VECTOR_BATCH_SIZE = 1024;      // max rows an executor produces in one NextBatch() call
+static constexpr int MORSEL_PAGES = 8;              // pages of a table a parallel scan worker takes at a time
+static constexpr int MAX_PARALLELISM = 16;          // max workers a query runs on, whatever SET parallelism says
+
+/**
+ * How a page is about to be used, passed to the buffer pool as a hint when fetching it. Pages fetched by a sequential
+ * scan are confined to a small ring of frames, so that a large scan does not evict the working set of everyone else.
+ */
+enum class AccessType { Unknown = 0, Lookup, Scan, Index };
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
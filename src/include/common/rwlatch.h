@@ -39,6 +39,12 @@ class ReaderWriterLatch {
    */
   void RLock() { mutex_.lock_shared(); }
 
+  /**
+   * Acquire a read latch if that does not have to wait.
+   * @return true if the read latch was acquired
+   */
+  auto TryRLock() -> bool { return mutex_.try_lock_shared(); }
+
   /**
    * Release a read latch.
    */
@@ -30,6 +30,10 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * A full bucket whose entries all have the same hash bits the directory could split on, e.g. because they all have the
+ * same key, cannot be split. It grows a chain of overflow pages instead. The overflow pages are only reached through
+ * the bucket's own page, whose latch covers them, and hold entries of those hash bits only.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class DiskExtendibleHashTable {
@@ -124,7 +128,7 @@ class DiskExtendibleHashTable {
   /**
    * Fetches the directory page from the buffer pool manager.
    *
-   * @return a pointer to the directory page
+   * @return a pointer to the directory page, nullptr if the buffer pool is full
    */
   auto FetchDirectoryPage() -> HashTableDirectoryPage *;
 
@@ -132,10 +136,63 @@ class DiskExtendibleHashTable {
    * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
    *
    * @param bucket_page_id the page_id to fetch
-   * @return a pointer to a bucket page
+   * @return a pointer to a bucket page, nullptr if the buffer pool is full
    */
   auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
 
+  /**
+   * Fails an operation that could not get a page because the buffer pool is full. Releases what the operation holds
+   * first: the table latch, and the directory page if it is pinned.
+   *
+   * @param write_locked whether the table latch is held in write mode
+   * @param directory_pinned whether the directory page is pinned
+   * @param directory_dirty whether the operation modified the directory page
+   */
+  [[noreturn]] void ReleaseAndThrow(bool write_locked, bool directory_pinned, bool directory_dirty = false);
+
+  /**
+   * Collects the values of a key from the overflow pages of a bucket.
+   *
+   * @param bucket_page the bucket, latched by the caller
+   * @param key the key to look up
+   * @param[out] result the values are appended to it
+   * @return false if an overflow page could not be fetched, the buffer pool is full
+   */
+  auto GetOverflowValues(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key, std::vector<ValueType> *result)
+      -> bool;
+
+  /**
+   * Inserts a pair into the first page of a bucket's chain with room, or into a new overflow page. The caller holds
+   * the table latch in write mode, and checked that the pair is not in the chain yet.
+   *
+   * @param bucket_page the bucket
+   * @param key the key to insert
+   * @param value the value to insert
+   * @return false if a page could not be fetched or allocated, the buffer pool is full
+   */
+  auto InsertOverflow(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Removes a pair from the overflow pages of a bucket. An overflow page it empties is unlinked and deleted.
+   *
+   * @param bucket_page the bucket, write latched by the caller
+   * @param key the key to remove
+   * @param value the value to remove
+   * @param[out] removed set to whether the pair was found
+   * @return false if an overflow page could not be fetched, the buffer pool is full
+   */
+  auto RemoveOverflow(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key, const ValueType &value, bool *removed)
+      -> bool;
+
+  /**
+   * Moves the entries of the first overflow page of a bucket into the bucket's own page, which removes left empty, and
+   * deletes the overflow page. The caller holds the table latch in write mode.
+   *
+   * @param bucket_page the empty bucket
+   * @return false if the overflow page could not be fetched, the buffer pool is full
+   */
+  auto PullUpOverflow(HASH_TABLE_BUCKET_TYPE *bucket_page) -> bool;
+
   /**
    * Performs insertion with an optional bucket splitting.
    *
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/container/hash/page_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "container/hash/hash_table.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps page ids to frame ids for the buffer pool.
+ *
+ * It is a fixed-capacity open-addressing table with linear probing. Every slot is a single 64-bit atomic word holding
+ * both the page id and the frame id, so a reader never sees a half-written entry. Find takes no lock: inserts publish
+ * an entry with one atomic store, and removals, which shift later entries of the probe sequence back by one, bump a
+ * version counter that readers check afterwards, like a seqlock. Writers are serialized by write_latch_.
+ *
+ * The buffer pool never holds more pages than it has frames, so the capacity is fixed at construction time and the
+ * table never grows.
+ */
+class PageTable : public HashTable<page_id_t, frame_id_t> {
+ public:
+  /**
+   * @brief Create a new PageTable.
+   * @param max_entries the maximum number of pages that are in the table at the same time
+   */
+  explicit PageTable(size_t max_entries);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  ~PageTable() override = default;
+
+  /**
+   * @brief Find the frame holding page_id. Lock-free.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page
+   * @return true if page_id is in the table
+   */
+  auto Find(const page_id_t &page_id, frame_id_t &frame_id) -> bool override;
+
+  /**
+   * @brief Map page_id to frame_id, overwriting an existing mapping for page_id.
+   * @param page_id the page
+   * @param frame_id the frame holding the page
+   */
+  void Insert(const page_id_t &page_id, const frame_id_t &frame_id) override;
+
+  /**
+   * @brief Remove the mapping of page_id.
+   * @param page_id the page to remove
+   * @return true if page_id was in the table
+   */
+  auto Remove(const page_id_t &page_id) -> bool override;
+
+  /** @return the number of pages in the table */
+  auto Size() const -> size_t { return size_; }
+
+ private:
+  /** A slot with this value is empty. Page ids are never negative, so no entry can look like this. */
+  static constexpr uint64_t EMPTY_SLOT = ~static_cast<uint64_t>(0);
+
+  static auto MakeSlot(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto SlotPageId(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto SlotFrameId(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the slot the probe sequence of page_id starts at */
+  auto HomeSlot(page_id_t page_id) const -> size_t {
+    // Fibonacci hashing spreads the mostly sequential page ids over the whole table.
+    return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                               (64 - capacity_bits_)) &
+           mask_;
+  }
+
+  /** Number of slots is 2^capacity_bits_, at least twice max_entries. */
+  size_t capacity_bits_;
+  size_t mask_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  /** Odd while a removal is moving entries around. */
+  std::atomic<uint64_t> version_{0};
+  std::atomic<size_t> size_{0};
+  /** Serializes writers. */
+  std::mutex write_latch_;
+};
+
+}  // namespace bustub
@@ -78,13 +78,26 @@ class ExecutionEngine {
 
  private:
   /**
-   * Poll the executor until exhausted, or exception escapes.
+   * Poll the executor until exhausted, or exception escapes. A plan that is vectorized all the way down is polled a
+   * batch at a time.
    * @param executor The root executor
    * @param plan The plan to execute
    * @param result_set The tuple result set
    */
   static void PollExecutor(AbstractExecutor *executor, const AbstractPlanNodeRef &plan,
                            std::vector<Tuple> *result_set) {
+    if (executor->IsVectorized()) {
+      TupleBatch batch;
+      while (executor->NextBatch(&batch)) {
+        if (result_set != nullptr) {
+          for (size_t row = 0; row < batch.Size(); row++) {
+            result_set->push_back(batch.GetTuple(row));
+          }
+        }
+      }
+      return;
+    }
+
     RID rid{};
     Tuple tuple{};
     while (executor->Next(&tuple, &rid)) {
@@ -18,6 +18,7 @@
 
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
+#include "execution/worker_pool.h"
 #include "storage/page/tmp_tuple_page.h"
 
 namespace bustub {
@@ -33,10 +34,18 @@ class ExecutorContext {
    * @param bpm The buffer pool manager that the executor uses
    * @param txn_mgr The transaction manager that the executor uses
    * @param lock_mgr The lock manager that the executor uses
+   * @param worker_pool The threads parallel pipelines run on, nullptr to run the whole query on the calling thread
+   * @param parallelism The number of workers a parallel pipeline runs on
    */
   ExecutorContext(Transaction *transaction, Catalog *catalog, BufferPoolManager *bpm, TransactionManager *txn_mgr,
-                  LockManager *lock_mgr)
-      : transaction_(transaction), catalog_{catalog}, bpm_{bpm}, txn_mgr_(txn_mgr), lock_mgr_(lock_mgr) {}
+                  LockManager *lock_mgr, WorkerPool *worker_pool = nullptr, size_t parallelism = 1)
+      : transaction_(transaction),
+        catalog_{catalog},
+        bpm_{bpm},
+        txn_mgr_(txn_mgr),
+        lock_mgr_(lock_mgr),
+        worker_pool_(worker_pool),
+        parallelism_(worker_pool == nullptr ? 1 : parallelism) {}
 
   ~ExecutorContext() = default;
 
@@ -60,6 +69,12 @@ class ExecutorContext {
   /** @return the transaction manager */
   auto GetTransactionManager() -> TransactionManager * { return txn_mgr_; }
 
+  /** @return the worker pool */
+  auto GetWorkerPool() -> WorkerPool * { return worker_pool_; }
+
+  /** @return the number of workers a parallel pipeline runs on, 1 if the query runs on the calling thread only */
+  auto GetParallelism() const -> size_t { return parallelism_; }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -71,6 +86,10 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The worker pool associated with this executor context */
+  WorkerPool *worker_pool_;
+  /** The number of workers of a parallel pipeline */
+  size_t parallelism_;
 };
 
 }  // namespace bustub
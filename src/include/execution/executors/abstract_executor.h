@@ -13,6 +13,7 @@
 #pragma once
 
 #include "execution/executor_context.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -20,6 +21,9 @@ namespace bustub {
  * The AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
  * This is the base class from which all executors in the BustTub execution
  * engine inherit, and defines the minimal interface that all executors support.
+ *
+ * Executors may also be driven a batch of tuples at a time through NextBatch(). A consumer drives an executor
+ * through one of Next() and NextBatch(), never both.
  */
 class AbstractExecutor {
  public:
@@ -46,6 +50,25 @@ class AbstractExecutor {
    */
   virtual auto Next(Tuple *tuple, RID *rid) -> bool = 0;
 
+  /**
+   * Yield the next batch of tuples from this executor. The default implementation gathers them from Next(), so that
+   * any executor can feed a parent that consumes batches.
+   * @param[out] batch The next tuples produced by this executor, at most VECTOR_BATCH_SIZE of them
+   * @return `true` if the batch holds any tuple, `false` if there are no more tuples
+   */
+  virtual auto NextBatch(TupleBatch *batch) -> bool {
+    batch->Reset(&GetOutputSchema());
+    Tuple tuple{};
+    RID rid{};
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->AppendTuple(tuple, rid);
+    }
+    return batch->Size() > 0;
+  }
+
+  /** @return `true` if this executor and all of its children produce batches without going through Next() */
+  virtual auto IsVectorized() const -> bool { return false; }
+
   /** @return The schema of the tuples that this executor produces */
   virtual auto GetOutputSchema() const -> const Schema & = 0;
 
@@ -13,7 +13,6 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -29,160 +28,147 @@
 namespace bustub {
 
 /**
- * A simplified hash table that has all the necessary functionality for aggregations.
+ * A flat hash table that has all the necessary functionality for aggregations.
+ *
+ * The key of each group is packed into bytes in an arena, one after another, and found through an open-addressing
+ * table of slots holding its hash. Each aggregate of a group is a native accumulator, whose kind is picked from the
+ * aggregation type and the input type when the table is created: counts, and sums, mins and maxes of integers and
+ * decimals are combined as int64_t or double without going through Value. Aggregates of other types, such as the MIN
+ * of a VARCHAR, are kept as Values.
  */
 class SimpleAggregationHashTable {
  public:
   /**
    * Construct a new SimpleAggregationHashTable instance.
+   * @param group_bys the group-by expressions
    * @param agg_exprs the aggregation expressions
    * @param agg_types the types of aggregations
    */
-  SimpleAggregationHashTable(const std::vector<AbstractExpressionRef> &agg_exprs,
-                             const std::vector<AggregationType> &agg_types)
-      : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
-
-  /** @return The initial aggregrate value for this aggregation executor */
-  auto GenerateInitialAggregateValue() -> AggregateValue {
-    std::vector<Value> values{};
-    for (const auto &agg_type : agg_types_) {
-      switch (agg_type) {
-        case AggregationType::CountStarAggregate:
-          // Count start starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::CountAggregate:
-        case AggregationType::SumAggregate:
-        case AggregationType::MinAggregate:
-        case AggregationType::MaxAggregate:
-          // Others starts at null.
-          values.emplace_back(ValueFactory::GetNullValueByType(TypeId::INTEGER));
-          break;
-      }
-    }
-    return {values};
-  }
-  void InitCombine(const AggregateKey &agg_key) {
-    if (ht_.count(agg_key) == 0) {
-      ht_.insert({agg_key, GenerateInitialAggregateValue()});
-    }
-  }
+  SimpleAggregationHashTable(const std::vector<AbstractExpressionRef> &group_bys,
+                             const std::vector<AbstractExpressionRef> &agg_exprs,
+                             const std::vector<AggregationType> &agg_types);
+
   /**
-   * TODO(Student)
-   *
-   * Combines the input into the aggregation result.
-   * @param[out] result The output aggregate value
-   * @param input The input value
+   * Combines a batch of rows into the aggregation results of their groups.
+   * @param keys the group-bys of the rows, one column for each group-by expression
+   * @param vals the inputs of the aggregates of the rows, one column for each aggregation expression
+   * @param rows the number of rows
    */
-  void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
-    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
-      switch (agg_types_[i]) {
-        case AggregationType::CountStarAggregate:
-          result->aggregates_[i] = result->aggregates_[i].Add(ValueFactory::GetIntegerValue(1));
-          break;
-        case AggregationType::CountAggregate:
-          if (input.aggregates_[i].IsNull()) {
-            break;
-          }
-          if (result->aggregates_[i].IsNull()) {
-            result->aggregates_[i] = ValueFactory::GetIntegerValue(1);
-          } else {
-            result->aggregates_[i] = result->aggregates_[i].Add(ValueFactory::GetIntegerValue(1));
-          }
-          break;
-        case AggregationType::SumAggregate:
-          if (input.aggregates_[i].IsNull()) {
-            break;
-          }
-          if (result->aggregates_[i].IsNull()) {
-            result->aggregates_[i] = input.aggregates_[i];
-          } else {
-            result->aggregates_[i] = result->aggregates_[i].Add(input.aggregates_[i]);
-          }
-          break;
-        case AggregationType::MinAggregate:
-          if (input.aggregates_[i].IsNull()) {
-            break;
-          }
-          if (result->aggregates_[i].IsNull()) {
-            result->aggregates_[i] = input.aggregates_[i];
-          } else {
-            result->aggregates_[i] = result->aggregates_[i].Min(input.aggregates_[i]);
-          }
-          break;
-        case AggregationType::MaxAggregate:
-          if (input.aggregates_[i].IsNull()) {
-            break;
-          }
-          if (result->aggregates_[i].IsNull()) {
-            result->aggregates_[i] = input.aggregates_[i];
-          } else {
-            result->aggregates_[i] = result->aggregates_[i].Max(input.aggregates_[i]);
-          }
-          break;
-      }
-    }
-  }
+  void InsertBatch(const std::vector<const ColumnVector *> &keys, const std::vector<const ColumnVector *> &vals,
+                   size_t rows);
+
+  /** Inserts the one group of an aggregation without group-bys with its initial aggregate values, if it is missing */
+  void InitCombine();
 
   /**
-   * Inserts a value into the hash table and then combines it with the current aggregation.
-   * @param agg_key the key to be inserted
-   * @param agg_val the value to be inserted
+   * Merges the partial aggregates of another table over the same aggregations into this one.
+   * @param other The table, built by one worker of a parallel aggregation
    */
-  void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht_.count(agg_key) == 0) {
-      ht_.insert({agg_key, GenerateInitialAggregateValue()});
-    }
-    CombineAggregateValues(&ht_[agg_key], agg_val);
-  }
+  void Merge(const SimpleAggregationHashTable &other);
 
   /**
    * Clear the hash table
    */
-  void Clear() { ht_.clear(); }
+  void Clear();
 
-  /** An iterator over the aggregation hash table */
+  /** @return the key of a group */
+  auto GetKey(size_t group) const -> AggregateKey;
+
+  /** @return the aggregate values of a group */
+  auto GetValue(size_t group) const -> AggregateValue;
+
+  /** An iterator over the groups of the aggregation hash table, in the order they were inserted */
   class Iterator {
    public:
-    /** Creates an iterator for the aggregate map. */
-    explicit Iterator(std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter) : iter_{iter} {}
+    /** Creates an iterator at a group of the table. */
+    Iterator(const SimpleAggregationHashTable *table, size_t group) : table_{table}, group_{group} {}
 
     /** @return The key of the iterator */
-    auto Key() -> const AggregateKey & { return iter_->first; }
+    auto Key() -> AggregateKey { return table_->GetKey(group_); }
 
     /** @return The value of the iterator */
-    auto Val() -> const AggregateValue & { return iter_->second; }
+    auto Val() -> AggregateValue { return table_->GetValue(group_); }
 
     /** @return The iterator before it is incremented */
     auto operator++() -> Iterator & {
-      ++iter_;
+      ++group_;
       return *this;
     }
 
     /** @return `true` if both iterators are identical */
-    auto operator==(const Iterator &other) -> bool { return this->iter_ == other.iter_; }
+    auto operator==(const Iterator &other) -> bool { return this->group_ == other.group_; }
 
     /** @return `true` if both iterators are different */
-    auto operator!=(const Iterator &other) -> bool { return this->iter_ != other.iter_; }
+    auto operator!=(const Iterator &other) -> bool { return this->group_ != other.group_; }
 
    private:
-    /** Aggregates map */
-    std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter_;
+    const SimpleAggregationHashTable *table_;
+    size_t group_;
   };
 
   /** @return Iterator to the start of the hash table */
-  auto Begin() -> Iterator { return Iterator{ht_.cbegin()}; }
+  auto Begin() -> Iterator { return Iterator{this, 0}; }
 
   /** @return Iterator to the end of the hash table */
-  auto End() -> Iterator { return Iterator{ht_.cend()}; }
+  auto End() -> Iterator { return Iterator{this, hashes_.size()}; }
 
  private:
-  /** The hash table is just a map from aggregate keys to aggregate values */
-  std::unordered_map<AggregateKey, AggregateValue> ht_{};
-  /** The aggregate expressions that we have */
-  const std::vector<AbstractExpressionRef> &agg_exprs_;
-  /** The types of aggregations that we have */
-  const std::vector<AggregationType> &agg_types_;
+  /** How an aggregate is accumulated, picked from its aggregation type and input type */
+  enum class AccumulatorKind : uint8_t {
+    CountStar,
+    Count,
+    IntegerSum,
+    IntegerMin,
+    IntegerMax,
+    DecimalSum,
+    DecimalMin,
+    DecimalMax,
+    Generic,
+  };
+
+  /** An aggregate of a group, an integer or the bits of a double, NULL until there is an input that is not NULL */
+  struct Accumulator {
+    int64_t value_;
+    bool null_;
+  };
+
+  /** A slot of the open-addressing table, pointing at a group */
+  struct Slot {
+    hash_t hash_;
+    uint32_t group_;
+  };
+
+  static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+  /** Appends the packed key of a row to key_buf_ */
+  void PackKey(const std::vector<const ColumnVector *> &keys, size_t row);
+  /** @return the group of a packed key, inserted with the initial aggregate values if it is missing */
+  auto FindOrInsert(const char *key, size_t size, hash_t hash) -> uint32_t;
+  /** Doubles the slots, or allocates the first ones */
+  void Grow();
+  /** Combines input into an accumulator of one of the native kinds, in is skipped if it is NULL */
+  static void Accumulate(AccumulatorKind kind, Accumulator *acc, const Accumulator &in);
+  /** Combines input into an accumulator kept as a Value */
+  static void AccumulateValue(AggregationType type, Value *acc, const Value &in);
+
+  std::vector<TypeId> key_types_;
+  std::vector<AggregationType> agg_types_;
+  std::vector<TypeId> input_types_;
+  std::vector<AccumulatorKind> kinds_;
+  /** For each aggregate kept as a Value, its index among those of a group in generics_ */
+  std::vector<uint32_t> generic_idx_;
+  size_t generic_count_{0};
+
+  std::vector<Slot> slots_;
+  /** The packed keys, the key of group g spans [key_offsets_[g], key_offsets_[g + 1]) of the arena */
+  std::vector<char> key_arena_;
+  std::vector<size_t> key_offsets_{0};
+  std::vector<hash_t> hashes_;
+  /** The accumulators of group g are at [g * agg_types_.size(), (g + 1) * agg_types_.size()) */
+  std::vector<Accumulator> accumulators_;
+  std::vector<Value> generics_;
+  /** The packed key of the row being inserted */
+  std::vector<char> key_buf_;
 };
 
 /**
@@ -211,6 +197,15 @@ class AggregationExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the aggregation.
+   * @param[out] batch The next tuples produced by the aggregation
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  auto IsVectorized() const -> bool override { return child_->IsVectorized(); }
+
   /** @return The output schema for the aggregation */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
@@ -218,25 +213,9 @@ class AggregationExecutor : public AbstractExecutor {
   auto GetChildExecutor() const -> const AbstractExecutor *;
 
  private:
-  /** @return The tuple as an AggregateKey */
-  auto MakeAggregateKey(const Tuple *tuple) -> AggregateKey {
-    std::vector<Value> keys;
-    for (const auto &expr : plan_->GetGroupBys()) {
-      keys.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
-    }
-    return {keys};
-  }
-
-  /** @return The tuple as an AggregateValue */
-  auto MakeAggregateValue(const Tuple *tuple) -> AggregateValue {
-    std::vector<Value> vals;
-    for (const auto &expr : plan_->GetAggregates()) {
-      vals.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
-    }
-    return {vals};
-  }
+  /** Combines every batch of tuples child produces into aht */
+  void AggregateBatches(AbstractExecutor *child, SimpleAggregationHashTable *aht) const;
 
- private:
   /** The aggregation plan node */
   const AggregationPlanNode *plan_;
   /** The child executor that produces tuples over which the aggregation is computed */
@@ -17,6 +17,7 @@
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/compiled_expression.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "storage/table/tuple.h"
@@ -48,6 +49,15 @@ class FilterExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the filter.
+   * @param[out] batch The next tuples produced by the filter
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  auto IsVectorized() const -> bool override { return child_executor_->IsVectorized(); }
+
   /** @return The output schema for the filter plan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
@@ -57,5 +67,12 @@ class FilterExecutor : public AbstractExecutor {
 
   /** The child executor from which tuples are obtained */
   std::unique_ptr<AbstractExecutor> child_executor_;
+
+  /** The predicate, compiled against the schema of the child */
+  CompiledExpression predicate_;
+
+  /** The batch of child tuples being filtered, and the value of the predicate on each of them */
+  TupleBatch child_batch_;
+  ColumnVector selection_;
 };
 }  // namespace bustub
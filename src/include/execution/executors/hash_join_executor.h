@@ -14,16 +14,28 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "common/util/hash_util.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/hash_join_plan.h"
+#include "storage/page/tmp_tuple_page.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * HashJoinExecutor executes an equi-JOIN on two tables with a hash table built on the right side.
+ *
+ * The build side is split into partitions by the hash of the join key, each with its own flat open-addressing table,
+ * small enough to stay in cache while it is probed. When the build side outgrows HASH_JOIN_BUDGET, the largest
+ * partitions are spilled to TmpTuplePages, and so are the left tuples that hash to them. Those partitions are joined
+ * one by one after the left child is exhausted, like a grace hash join.
+ *
+ * When the right side is a pipeline over a sequential scan and the query has several workers, every worker partitions
+ * the morsels it scans on its own, and merges its partitions into the shared ones whenever it holds its share of the
+ * budget. The tables of the partitions are then built in parallel too.
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -37,6 +49,8 @@ class HashJoinExecutor : public AbstractExecutor {
   HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                    std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child);
 
+  ~HashJoinExecutor() override;
+
   /** Initialize the join */
   void Init() override;
 
@@ -48,12 +62,109 @@ class HashJoinExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the join.
+   * @param[out] batch The next tuples produced by the join
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /** The build side is read a tuple at a time to keep its tuples serialized, only the probe side is vectorized */
+  auto IsVectorized() const -> bool override { return left_child_->IsVectorized(); }
+
   /** @return The output schema for the join */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
  private:
-  /** The NestedLoopJoin plan node to be executed. */
+  /** A slot of a partition's hash table, pointing at one of its tuples. */
+  struct Slot {
+    hash_t hash_;
+    uint32_t tuple_idx_;
+  };
+
+  /** The build tuples whose join keys hash to one partition. */
+  struct Partition {
+    std::vector<Tuple> tuples_;
+    std::vector<Value> keys_;
+    std::vector<hash_t> hashes_;
+    /** The open-addressing table over tuples_, empty slots have a tuple_idx_ of EMPTY_SLOT */
+    std::vector<Slot> slots_;
+    /** The bytes tuples_ and keys_ are charged against HASH_JOIN_BUDGET */
+    size_t bytes_{0};
+    bool spilled_{false};
+    /** The pages the spilled build and left tuples of the partition were written to, and the pages being written */
+    std::vector<page_id_t> build_pages_;
+    std::vector<page_id_t> probe_pages_;
+    TmpTuplePage *build_page_{nullptr};
+    TmpTuplePage *probe_page_{nullptr};
+  };
+
+  static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+  /** @return the hash of a non-null join key, with its bits mixed well enough to pick a partition and a slot */
+  static auto HashKey(const Value &key) -> hash_t;
+  static auto PartitionOf(hash_t hash) -> size_t { return hash & ((1 << HASH_JOIN_PARTITION_BITS) - 1); }
+
+  /** Adds a build tuple to the partition its key hashes to, spilling partitions while over the budget */
+  void AddBuildTuple(const Tuple &tuple, Value key, hash_t hash);
+  /** Partitions the right side on the workers of the query */
+  void ParallelBuild();
+  /** Moves the build tuples a worker partitioned into partitions_, leaving the worker's partitions empty */
+  void MergeBuildTuples(std::vector<Partition> *local);
+  /** Writes the in-memory tuples of a partition out and sends the ones that follow to disk as well */
+  void Spill(Partition *partition);
+  /** Appends a tuple to a list of spill pages, starting a new page when the last one is full */
+  void WriteSpilled(const Tuple &tuple, std::vector<page_id_t> *pages, TmpTuplePage **page);
+  /** Unpins the spill page being written, if any */
+  void FinishSpilled(TmpTuplePage **page);
+  /** Reads the tuples of a spill page and deletes it */
+  void ReadSpilled(page_id_t page_id, std::vector<Tuple> *tuples);
+  /** Builds the hash table over the in-memory tuples of a partition */
+  void BuildTable(Partition *partition);
+  /** Loads the next spilled partition into memory */
+  auto LoadSpilledPartition() -> bool;
+  /** @return whether left_batch_ was filled with the next left tuples, from the left child then the spilled ones */
+  auto NextLeftBatch() -> bool;
+  /** Starts probing with row left_row_ of left_batch_, or spills it with the other left tuples of its partition */
+  void StartProbe();
+  /** @return the next build tuple matching the left row being probed, nullptr if there are no more */
+  auto NextMatch() -> const Tuple *;
+  /** Unpins and deletes the spill pages that are left, and drops the partitions */
+  void ReleasePartitions();
+
+  /** Appends the left row being probed joined with right_tuple, or with NULLs if it is nullptr */
+  void AppendJoined(TupleBatch *batch, const Tuple *right_tuple) const;
+
+  /** The HashJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> left_child_;
+  std::unique_ptr<AbstractExecutor> right_child_;
+
+  std::vector<Partition> partitions_;
+  size_t bytes_{0};
+
+  /** Whether the left child is exhausted, then the spilled partition being joined and the next one to look at */
+  bool left_done_{false};
+  Partition *loaded_{nullptr};
+  size_t spilled_idx_{0};
+
+  /** The left tuples being probed with, their join keys, and the row being probed */
+  TupleBatch left_batch_;
+  const ColumnVector *left_keys_{nullptr};
+  ColumnVector left_keys_scratch_;
+  size_t left_row_{0};
+
+  /** The partition the left row probes and the next slot to look at */
+  const Partition *probe_partition_{nullptr};
+  hash_t probe_hash_{0};
+  Value probe_key_;
+  size_t probe_slot_{0};
+  bool probing_{false};
+  bool matched_{false};
+
+  /** The batch Next() hands out tuples from */
+  TupleBatch out_batch_;
+  size_t out_idx_{0};
 };
 
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <functional>
 #include <vector>
 
 #include "common/rid.h"
@@ -42,13 +43,16 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Start scanning index between the plan bounds if it is a B+ tree on KeySize byte keys. @return false if not */
+  template <size_t KeySize>
+  auto ScanTree(Index *index) -> bool;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
 
   IndexInfo *checking_index_;
   TableInfo *checking_table_;
-  BPlusTreeIndexForOneIntegerColumn *tree_;
-  BPlusTreeIndexIteratorForOneIntegerColumn iter_;
-  
+  /** Moves the scan to the next entry of the index and returns its RID, false at the end. */
+  std::function<bool(RID *)> next_rid_;
 };
 }  // namespace bustub
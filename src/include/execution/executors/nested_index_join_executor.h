@@ -52,11 +52,21 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   auto InnerJoin(Tuple *left_tuple, Tuple *right_tuple) -> Tuple;
 
  private:
+  /** Read the next batch of outer tuples and look all of them up in the index. @return false if there are none */
+  auto FillOuterBatch() -> bool;
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_;
   const IndexInfo *index_info_;
   const TableInfo *table_info_;
-  BPlusTreeIndexForOneIntegerColumn *tree_;
+  /** Outer tuples read ahead, so that the index is probed for up to INDEX_JOIN_BATCH_SIZE keys at once. */
+  std::vector<Tuple> outer_batch_;
+  /** The inner RIDs matching every tuple of outer_batch_. */
+  std::vector<std::vector<RID>> inner_rids_;
+  /** The next tuple of outer_batch_ to join. */
+  size_t cursor_{0};
+  /** The next of the inner RIDs matching the tuple at cursor_, a hash index may hold several for a key. */
+  size_t match_{0};
 };
 }  // namespace bustub
@@ -17,6 +17,7 @@
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/compiled_expression.h"
 #include "execution/plans/nested_loop_join_plan.h"
 #include "storage/table/tuple.h"
 
@@ -63,6 +64,8 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
   const NestedLoopJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> lchild_;
   std::unique_ptr<AbstractExecutor> rchild_;
+  /** The join predicate, compiled against the schemas of both children */
+  CompiledExpression predicate_;
   Tuple left_tuple_;
   std::vector<Tuple> right_tuples_;
   std::vector<Tuple>::iterator iter_;
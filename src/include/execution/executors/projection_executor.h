@@ -17,6 +17,7 @@
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/compiled_expression.h"
 #include "execution/plans/projection_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "storage/table/tuple.h"
@@ -47,6 +48,15 @@ class ProjectionExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the projection.
+   * @param[out] batch The next tuples produced by the projection
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  auto IsVectorized() const -> bool override { return child_executor_->IsVectorized(); }
+
   /** @return The output schema for the projection plan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
@@ -56,5 +66,11 @@ class ProjectionExecutor : public AbstractExecutor {
 
   /** The child executor from which tuples are obtained */
   std::unique_ptr<AbstractExecutor> child_executor_;
+
+  /** The expressions, compiled against the schema of the child */
+  std::vector<CompiledExpression> exprs_;
+
+  /** The batch of child tuples being projected */
+  TupleBatch child_batch_;
 };
 }  // namespace bustub
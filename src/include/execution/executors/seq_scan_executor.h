@@ -16,6 +16,7 @@
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/morsel_queue.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "storage/table/tuple.h"
 
@@ -30,8 +31,9 @@ class SeqScanExecutor : public AbstractExecutor {
    * Construct a new SeqScanExecutor instance.
    * @param exec_ctx The executor context
    * @param plan The sequential scan plan to be executed
+   * @param morsels The morsels of the table shared by the workers of a parallel scan, nullptr to scan the whole table
    */
-  SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan);
+  SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan, MorselQueue *morsels = nullptr);
 
   /** Initialize the sequential scan */
   void Init() override;
@@ -44,6 +46,15 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the sequential scan.
+   * @param[out] batch The next tuples produced by the sequential scan
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  auto IsVectorized() const -> bool override { return true; }
+
   /** @return The output schema for the sequential scan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
@@ -52,5 +63,13 @@ class SeqScanExecutor : public AbstractExecutor {
   const SeqScanPlanNode *plan_;
   TableIterator iter_ = {nullptr, RID(), nullptr};
   TableInfo *checking_table_;
+  /** The morsels of a parallel scan, the one being read, and the tuples of its page being read */
+  MorselQueue *morsels_;
+  Morsel morsel_;
+  std::vector<Tuple> page_tuples_;
+  size_t page_idx_{0};
+
+  /** @return whether page_tuples_ was filled with the next page of the morsels, which may have no tuple */
+  auto NextMorselPage() -> bool;
 };
 }  // namespace bustub
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "fmt/format.h"
 #include "storage/table/tuple.h"
 
@@ -65,6 +66,32 @@ class AbstractExpression {
   virtual auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
                             const Schema &right_schema) const -> Value = 0;
 
+  /**
+   * Evaluates the expression on every row of a batch. The default implementation evaluates each row as a tuple,
+   * expressions override it to work on whole columns.
+   * @param batch The rows, laid out by the schema Evaluate() would be given
+   * @param[out] out The value of the expression on each row
+   */
+  virtual void EvaluateBatch(const TupleBatch &batch, ColumnVector *out) const {
+    out->Reset(GetReturnType());
+    for (size_t row = 0; row < batch.Size(); row++) {
+      auto tuple = batch.GetTuple(row);
+      out->Append(Evaluate(&tuple, *batch.GetSchema()));
+    }
+  }
+
+  /**
+   * Evaluates the expression on every row of a batch, for callers that only read the result. An expression that is
+   * a column of the batch returns that column, where EvaluateBatch() would copy it.
+   * @param batch The rows, laid out by the schema Evaluate() would be given
+   * @param scratch Holds the value of the expression if it has to be computed
+   * @return the value of the expression on each row, either scratch or a column of batch
+   */
+  virtual auto EvaluateBatchRef(const TupleBatch &batch, ColumnVector *scratch) const -> const ColumnVector & {
+    EvaluateBatch(batch, scratch);
+    return *scratch;
+  }
+
   /** @return the child_idx'th child of this expression */
   auto GetChildAt(uint32_t child_idx) const -> const AbstractExpressionRef & { return children_[child_idx]; }
 
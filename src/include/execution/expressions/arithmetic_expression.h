@@ -23,6 +23,7 @@
 #include "execution/expressions/abstract_expression.h"
 #include "fmt/format.h"
 #include "storage/table/tuple.h"
+#include "type/limits.h"
 #include "type/type_id.h"
 #include "type/value_factory.h"
 
@@ -65,6 +66,26 @@ class ArithmeticExpression : public AbstractExpression {
     return ValueFactory::GetIntegerValue(*res);
   }
 
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *out) const override {
+    ColumnVector lhs_scratch;
+    ColumnVector rhs_scratch;
+    const auto &lhs = GetChildAt(0)->EvaluateBatchRef(batch, &lhs_scratch);
+    const auto &rhs = GetChildAt(1)->EvaluateBatchRef(batch, &rhs_scratch);
+    out->Reset(TypeId::INTEGER);
+    for (size_t row = 0; row < batch.Size(); row++) {
+      if (lhs.IsNull(row) || rhs.IsNull(row)) {
+        out->AppendNull();
+        continue;
+      }
+      auto res = Compute(static_cast<int32_t>(lhs.GetInteger(row)), static_cast<int32_t>(rhs.GetInteger(row)));
+      if (res == std::nullopt) {
+        out->AppendNull();
+      } else {
+        out->AppendInteger(*res);
+      }
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), compute_type_, *GetChildAt(1));
@@ -79,14 +100,31 @@ class ArithmeticExpression : public AbstractExpression {
     if (lhs.IsNull() || rhs.IsNull()) {
       return std::nullopt;
     }
+    return Compute(lhs.GetAs<int32_t>(), rhs.GetAs<int32_t>());
+  }
+
+  /**
+   * Integers wrap around like they do in the compiled expressions, see CompiledExpression. A result that wraps onto
+   * the NULL integer is NULL.
+   */
+  auto Compute(int32_t lhs, int32_t rhs) const -> std::optional<int32_t> {
+    auto l = static_cast<uint32_t>(lhs);
+    auto r = static_cast<uint32_t>(rhs);
+    int32_t res;
     switch (compute_type_) {
       case ArithmeticType::Plus:
-        return lhs.GetAs<int32_t>() + rhs.GetAs<int32_t>();
+        res = static_cast<int32_t>(l + r);
+        break;
       case ArithmeticType::Minus:
-        return lhs.GetAs<int32_t>() - rhs.GetAs<int32_t>();
+        res = static_cast<int32_t>(l - r);
+        break;
       default:
         UNREACHABLE("Unsupported arithmetic type.");
     }
+    if (res == BUSTUB_INT32_NULL) {
+      return std::nullopt;
+    }
+    return res;
   }
 };
 }  // namespace bustub
@@ -45,6 +45,12 @@ class ColumnValueExpression : public AbstractExpression {
                            : right_tuple->GetValue(&right_schema, col_idx_);
   }
 
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *out) const override { *out = batch.GetColumn(col_idx_); }
+
+  auto EvaluateBatchRef(const TupleBatch &batch, ColumnVector * /* scratch */) const -> const ColumnVector & override {
+    return batch.GetColumn(col_idx_);
+  }
+
   auto GetTupleIdx() const -> uint32_t { return tuple_idx_; }
   auto GetColIdx() const -> uint32_t { return col_idx_; }
 
@@ -49,6 +49,33 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *out) const override {
+    ColumnVector lhs_scratch;
+    ColumnVector rhs_scratch;
+    const auto &lhs = GetChildAt(0)->EvaluateBatchRef(batch, &lhs_scratch);
+    const auto &rhs = GetChildAt(1)->EvaluateBatchRef(batch, &rhs_scratch);
+    out->Reset(TypeId::BOOLEAN);
+    // integers of any width compare as int64_t, without a Value for each row
+    if (ColumnVector::IsIntegral(lhs.GetType()) && ColumnVector::IsIntegral(rhs.GetType())) {
+      for (size_t row = 0; row < batch.Size(); row++) {
+        if (lhs.IsNull(row) || rhs.IsNull(row)) {
+          out->AppendNull();
+        } else {
+          out->AppendInteger(static_cast<int64_t>(CompareIntegers(lhs.GetInteger(row), rhs.GetInteger(row))));
+        }
+      }
+      return;
+    }
+    for (size_t row = 0; row < batch.Size(); row++) {
+      auto result = PerformComparison(lhs.GetValue(row), rhs.GetValue(row));
+      if (result == CmpBool::CmpNull) {
+        out->AppendNull();
+      } else {
+        out->AppendInteger(static_cast<int64_t>(result == CmpBool::CmpTrue));
+      }
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), comp_type_, *GetChildAt(1));
@@ -59,6 +86,25 @@ class ComparisonExpression : public AbstractExpression {
   ComparisonType comp_type_;
 
  private:
+  auto CompareIntegers(int64_t lhs, int64_t rhs) const -> bool {
+    switch (comp_type_) {
+      case ComparisonType::Equal:
+        return lhs == rhs;
+      case ComparisonType::NotEqual:
+        return lhs != rhs;
+      case ComparisonType::LessThan:
+        return lhs < rhs;
+      case ComparisonType::LessThanOrEqual:
+        return lhs <= rhs;
+      case ComparisonType::GreaterThan:
+        return lhs > rhs;
+      case ComparisonType::GreaterThanOrEqual:
+        return lhs >= rhs;
+      default:
+        UNREACHABLE("Unsupported comparison type.");
+    }
+  }
+
   auto PerformComparison(const Value &lhs, const Value &rhs) const -> CmpBool {
     switch (comp_type_) {
       case ComparisonType::Equal:
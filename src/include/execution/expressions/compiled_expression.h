@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression.h
+//
+// Identification: src/include/execution/expressions/compiled_expression.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * CompiledExpression flattens an expression tree over integer and boolean columns into a straight-line program over
+ * int64_t registers. Columns are read at offsets resolved against the schema when the expression is compiled, without
+ * building a Value for every node and row.
+ *
+ * An expression with VARCHAR or DECIMAL operands, or more nodes than there are registers, is not compiled, and is
+ * evaluated through the expression tree instead.
+ */
+class CompiledExpression {
+ public:
+  CompiledExpression() = default;
+
+  /**
+   * Compiles an expression.
+   * @param expr The expression
+   * @param schema The schema of the tuples it is evaluated on, or of the left tuple of a join
+   * @param right_schema The schema of the right tuple of a join, nullptr if the expression is not a join predicate
+   */
+  CompiledExpression(AbstractExpressionRef expr, const Schema &schema, const Schema *right_schema = nullptr);
+
+  /** @return whether the expression was compiled, rather than left to be evaluated through its tree */
+  auto IsCompiled() const -> bool { return !program_.empty(); }
+
+  /** @return The value of the expression on a tuple */
+  auto Evaluate(const Tuple *tuple) const -> Value;
+
+  /** @return The value of the expression on a pair of tuples of a join */
+  auto EvaluateJoin(const Tuple *left_tuple, const Tuple *right_tuple) const -> Value;
+
+  /** @return whether a predicate is true, rather than false or NULL, on a tuple */
+  auto EvaluatePredicate(const Tuple *tuple) const -> bool;
+
+  /** @return whether a join predicate is true, rather than false or NULL, on a pair of tuples */
+  auto EvaluateJoinPredicate(const Tuple *left_tuple, const Tuple *right_tuple) const -> bool;
+
+  /** Evaluates the expression on every row of a batch, see AbstractExpression::EvaluateBatch() */
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *out) const;
+
+ private:
+  enum class OpCode : uint8_t {
+    LoadColumn,
+    LoadConstant,
+    Equal,
+    NotEqual,
+    LessThan,
+    LessThanOrEqual,
+    GreaterThan,
+    GreaterThanOrEqual,
+    And,
+    Or,
+    Plus,
+    Minus,
+  };
+
+  /** An instruction computes register dst_ from registers lhs_ and rhs_, a column or a constant */
+  struct Instruction {
+    OpCode op_;
+    uint8_t dst_;
+    uint8_t lhs_;
+    uint8_t rhs_;
+    /** LoadColumn: the tuple, column, type and byte offset of the column read */
+    uint32_t tuple_idx_;
+    uint32_t col_idx_;
+    TypeId type_;
+    uint32_t offset_;
+    /** LoadConstant: the constant loaded */
+    int64_t constant_;
+    bool null_;
+  };
+
+  /** A register holds an integer or boolean value, or NULL */
+  struct Register {
+    int64_t value_;
+    bool null_;
+  };
+
+  static constexpr size_t MAX_REGISTERS = 16;
+
+  /** @return the register holding the value of expr, or -1 if it cannot be compiled */
+  auto Compile(const AbstractExpression &expr, const Schema &schema, const Schema *right_schema) -> int;
+
+  /** Runs the program, loading each column with load(instruction), and @return the register holding the result */
+  template <typename Loader>
+  auto Run(Loader &&load) const -> Register;
+
+  /** @return the column an instruction loads from a serialized tuple */
+  static auto LoadFromTuple(const Instruction &instr, const Tuple *tuple) -> Register;
+
+  auto ToValue(const Register &reg) const -> Value;
+
+  AbstractExpressionRef expr_;
+  const Schema *schema_{nullptr};
+  const Schema *right_schema_{nullptr};
+  std::vector<Instruction> program_;
+};
+
+}  // namespace bustub
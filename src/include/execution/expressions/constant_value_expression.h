@@ -34,6 +34,13 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *out) const override {
+    out->Reset(GetReturnType());
+    for (size_t row = 0; row < batch.Size(); row++) {
+      out->Append(val_);
+    }
+  }
+
   /** @return the string representation of the plan node and its children */
   auto ToString() const -> std::string override { return val_.ToString(); }
 
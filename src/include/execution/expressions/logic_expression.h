@@ -57,6 +57,22 @@ class LogicExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComputation(lhs, rhs));
   }
 
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *out) const override {
+    ColumnVector lhs_scratch;
+    ColumnVector rhs_scratch;
+    const auto &lhs = GetChildAt(0)->EvaluateBatchRef(batch, &lhs_scratch);
+    const auto &rhs = GetChildAt(1)->EvaluateBatchRef(batch, &rhs_scratch);
+    out->Reset(TypeId::BOOLEAN);
+    for (size_t row = 0; row < batch.Size(); row++) {
+      auto result = PerformLogic(GetBoolAsCmpBool(lhs, row), GetBoolAsCmpBool(rhs, row));
+      if (result == CmpBool::CmpNull) {
+        out->AppendNull();
+      } else {
+        out->AppendInteger(static_cast<int64_t>(result == CmpBool::CmpTrue));
+      }
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), logic_type_, *GetChildAt(1));
@@ -77,9 +93,18 @@ class LogicExpression : public AbstractExpression {
     return CmpBool::CmpFalse;
   }
 
+  auto GetBoolAsCmpBool(const ColumnVector &vec, size_t row) const -> CmpBool {
+    if (vec.IsNull(row)) {
+      return CmpBool::CmpNull;
+    }
+    return vec.GetInteger(row) != 0 ? CmpBool::CmpTrue : CmpBool::CmpFalse;
+  }
+
   auto PerformComputation(const Value &lhs, const Value &rhs) const -> CmpBool {
-    auto l = GetBoolAsCmpBool(lhs);
-    auto r = GetBoolAsCmpBool(rhs);
+    return PerformLogic(GetBoolAsCmpBool(lhs), GetBoolAsCmpBool(rhs));
+  }
+
+  auto PerformLogic(CmpBool l, CmpBool r) const -> CmpBool {
     switch (logic_type_) {
       case LogicType::And:
         if (l == CmpBool::CmpFalse || r == CmpBool::CmpFalse) {
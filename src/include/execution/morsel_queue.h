@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_queue.h
+//
+// Identification: src/include/execution/morsel_queue.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/** A morsel is a run of consecutive pages of a table heap, what a worker of a parallel scan reads at a time */
+struct Morsel {
+  const page_id_t *page_ids_{nullptr};
+  size_t page_count_{0};
+};
+
+/**
+ * MorselQueue hands out the pages of a table heap as morsels to the workers of a parallel scan. A worker takes the
+ * next morsel whenever it is done with the last one, so a worker held up by a slow morsel is not waited on by the rest.
+ *
+ * The pages of a heap are a linked list, so the queue lists them once when it is built, from the free space map of the
+ * heap, and a morsel is then just a range of that list. Taking one is a single atomic add, and every page is read once.
+ */
+class MorselQueue {
+ public:
+  /**
+   * @param table_heap The table heap to scan
+   * @param bpm The buffer pool manager the table heap lives in
+   * @param txn The transaction scanning the table
+   * @param pages_per_morsel The number of pages in a morsel
+   */
+  MorselQueue(TableHeap *table_heap, BufferPoolManager *bpm, Transaction *txn,
+              size_t pages_per_morsel = MORSEL_PAGES);
+
+  /**
+   * Takes the next morsel.
+   * @param[out] morsel The morsel
+   * @return `false` once every page of the table was handed out
+   */
+  auto Next(Morsel *morsel) -> bool;
+
+  /**
+   * Reads the tuples of one page of a morsel.
+   * @param page_id The page
+   * @param[out] tuples The tuples of the page, replacing what it held
+   */
+  void ReadPage(page_id_t page_id, std::vector<Tuple> *tuples);
+
+ private:
+  TableHeap *table_heap_;
+  BufferPoolManager *bpm_;
+  Transaction *txn_;
+  size_t pages_per_morsel_;
+
+  /** The pages of the table, in chain order */
+  std::vector<page_id_t> page_ids_;
+  /** The index in page_ids_ of the first page of the next morsel */
+  std::atomic<size_t> next_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_pipeline.h
+//
+// Identification: src/include/execution/parallel_pipeline.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/morsel_queue.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * ParallelPipeline runs a pipeline of filters and projections over a sequential scan on the workers of the executor
+ * context. Every worker pulls from an executor tree of its own, whose scan reads the morsels it takes from a
+ * MorselQueue shared by all of them, and hands the tuples to a sink that collects them into thread-local state. The
+ * executor consuming the pipeline merges that state once every worker is done, at the pipeline breaker.
+ */
+class ParallelPipeline {
+ public:
+  /** @return whether plan can run in parallel, that is the query has more than one worker and plan is a pipeline */
+  static auto CanRun(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan) -> bool;
+
+  /**
+   * Runs the pipeline until every worker is out of morsels.
+   * @param exec_ctx The executor context
+   * @param plan The pipeline, which CanRun() accepts
+   * @param sink Called on each worker with its index and its initialized executor tree, pulls the tuples out of it
+   */
+  static void Run(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan,
+                  const std::function<void(size_t, AbstractExecutor *)> &sink);
+
+ private:
+  /** @return an executor tree for the pipeline, whose scan reads morsels from the queue */
+  static auto CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan, MorselQueue *morsels)
+      -> std::unique_ptr<AbstractExecutor>;
+
+  /** @return the sequential scan at the bottom of a pipeline, nullptr if plan is not one */
+  static auto GetScan(const AbstractPlanNodeRef &plan) -> const AbstractPlanNode *;
+};
+
+}  // namespace bustub
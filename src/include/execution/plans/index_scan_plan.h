@@ -14,6 +14,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
@@ -21,7 +22,9 @@
 
 namespace bustub {
 /**
- * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ * IndexScanPlanNode identifies a table that should be scanned with an optional predicate. The scan may be bounded by a
+ * lower and an upper key, each holding one value per key column, where an empty bound leaves that end of the index
+ * unbounded.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
@@ -29,9 +32,19 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_oid the identifier of table to be scanned
+   * @param lower_bound the key to start scanning at, empty to start at the first key
+   * @param lower_inclusive whether the scan includes keys equal to lower_bound
+   * @param upper_bound the key to stop scanning at, empty to scan to the last key
+   * @param upper_inclusive whether the scan includes keys equal to upper_bound
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, std::vector<Value> lower_bound = {},
+                    bool lower_inclusive = true, std::vector<Value> upper_bound = {}, bool upper_inclusive = true)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        lower_bound_(std::move(lower_bound)),
+        lower_inclusive_(lower_inclusive),
+        upper_bound_(std::move(upper_bound)),
+        upper_inclusive_(upper_inclusive) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
@@ -43,11 +56,33 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /** The key the scan starts at, empty if it starts at the first key of the index. */
+  std::vector<Value> lower_bound_;
+  bool lower_inclusive_;
+  /** The key the scan stops at, empty if it runs to the last key of the index. */
+  std::vector<Value> upper_bound_;
+  bool upper_inclusive_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    if (lower_bound_.empty() && upper_bound_.empty()) {
+      return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    }
+    return fmt::format("IndexScan {{ index_oid={}, range={}{}, {}{} }}", index_oid_, lower_inclusive_ ? '[' : '(',
+                       BoundToString(lower_bound_), BoundToString(upper_bound_), upper_inclusive_ ? ']' : ')');
+  }
+
+ private:
+  static auto BoundToString(const std::vector<Value> &bound) -> std::string {
+    if (bound.empty()) {
+      return "-";
+    }
+    std::vector<std::string> values;
+    values.reserve(bound.size());
+    for (const auto &value : bound) {
+      values.push_back(value.ToString());
+    }
+    return bound.size() == 1 ? values[0] : fmt::format("({})", fmt::join(values, ", "));
   }
 };
 
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * ColumnVector holds the values of one column for the rows of a batch, in a typed array plus a null bitmap.
+ * The integer types, BOOLEAN and TIMESTAMP are widened into an array of int64_t, DECIMAL goes into an array of double
+ * and VARCHAR into an array of std::string. A NULL row keeps a placeholder in the array.
+ */
+class ColumnVector {
+ public:
+  explicit ColumnVector(TypeId type = TypeId::INVALID) : type_(type) {}
+
+  /** @return whether values of type are held in the int64_t array */
+  static auto IsIntegral(TypeId type) -> bool {
+    return type == TypeId::BOOLEAN || type == TypeId::TINYINT || type == TypeId::SMALLINT ||
+           type == TypeId::INTEGER || type == TypeId::BIGINT || type == TypeId::TIMESTAMP;
+  }
+
+  /** Drops all the rows, and makes the vector hold values of type from now on */
+  void Reset(TypeId type);
+
+  auto GetType() const -> TypeId { return type_; }
+  auto Size() const -> size_t { return size_; }
+
+  auto IsNull(size_t row) const -> bool { return ((nulls_[row / 64] >> (row % 64)) & 1) != 0; }
+  auto GetInteger(size_t row) const -> int64_t { return integers_[row]; }
+  auto GetDecimal(size_t row) const -> double { return decimals_[row]; }
+  auto GetVarchar(size_t row) const -> const std::string & { return varchars_[row]; }
+
+  /** @return the value of a row as a Value of the type of the vector */
+  auto GetValue(size_t row) const -> Value;
+
+  void AppendNull();
+  void AppendInteger(int64_t value) {
+    integers_.push_back(value);
+    AppendNotNull();
+  }
+  void AppendDecimal(double value) {
+    decimals_.push_back(value);
+    AppendNotNull();
+  }
+  void AppendVarchar(std::string value) {
+    varchars_.push_back(std::move(value));
+    AppendNotNull();
+  }
+  /** Appends a value of the type of the vector */
+  void Append(const Value &value);
+  /** Appends a row of another vector of the same type */
+  void AppendFrom(const ColumnVector &other, size_t row);
+
+ private:
+  void AppendNotNull() {
+    if (size_ % 64 == 0) {
+      nulls_.push_back(0);
+    }
+    size_++;
+  }
+
+  TypeId type_;
+  size_t size_{0};
+  /** Bit i of the bitmap is set if row i is NULL */
+  std::vector<uint64_t> nulls_;
+  std::vector<int64_t> integers_;
+  std::vector<double> decimals_;
+  std::vector<std::string> varchars_;
+};
+
+/**
+ * TupleBatch holds up to VECTOR_BATCH_SIZE rows column by column, one ColumnVector for each column of a schema,
+ * along with the RID of each row. It is what NextBatch() passes between executors.
+ */
+class TupleBatch {
+ public:
+  TupleBatch() = default;
+
+  /** Drops all the rows, and lays the batch out for rows of schema from now on */
+  void Reset(const Schema *schema);
+
+  auto GetSchema() const -> const Schema * { return schema_; }
+  auto Size() const -> size_t { return rids_.size(); }
+  auto IsFull() const -> bool { return Size() >= static_cast<size_t>(VECTOR_BATCH_SIZE); }
+
+  auto GetColumn(uint32_t col_idx) -> ColumnVector & { return columns_[col_idx]; }
+  auto GetColumn(uint32_t col_idx) const -> const ColumnVector & { return columns_[col_idx]; }
+  auto GetRid(size_t row) const -> const RID & { return rids_[row]; }
+
+  /** Appends a tuple of the schema of the batch, deserializing every column */
+  void AppendTuple(const Tuple &tuple, const RID &rid);
+  /** Appends a row of another batch of the same schema */
+  void AppendRow(const TupleBatch &other, size_t row);
+  /** Ends a row whose value was appended to every column one at a time */
+  void EndRow(const RID &rid = RID{}) { rids_.push_back(rid); }
+  /** Ends as many rows as other has, with the same RIDs, after every column was filled with a value for each */
+  void CopyRids(const TupleBatch &other) { rids_ = other.rids_; }
+
+  /** @return a row of the batch serialized as a tuple */
+  auto GetTuple(size_t row) const -> Tuple;
+
+ private:
+  const Schema *schema_{nullptr};
+  std::vector<ColumnVector> columns_;
+  std::vector<RID> rids_;
+};
+
+}  // namespace bustub
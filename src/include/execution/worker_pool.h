@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// worker_pool.h
+//
+// Identification: src/include/execution/worker_pool.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * WorkerPool keeps a fixed set of threads around to run the workers of parallel queries, so that a query does not pay
+ * for starting threads. Threads are started the first time a query asks for that many workers, and kept until the
+ * pool is destroyed.
+ */
+class WorkerPool {
+ public:
+  WorkerPool() = default;
+
+  /** Waits for the tasks that are running, and stops the threads */
+  ~WorkerPool();
+
+  DISALLOW_COPY_AND_MOVE(WorkerPool);
+
+  /**
+   * Runs task(0), ..., task(workers - 1) on as many threads at once, and returns once all of them are done.
+   * If tasks throw, the first exception is rethrown here once every task is done.
+   * @param workers The number of tasks
+   * @param task The task, called with the index of its worker
+   */
+  void Run(size_t workers, const std::function<void(size_t)> &task);
+
+ private:
+  void WorkerLoop();
+
+  /** Protects jobs_ and stop_ */
+  std::mutex latch_;
+  /** Notified when a job is queued or the pool is stopped */
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> jobs_;
+  bool stop_{false};
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace bustub
@@ -34,7 +34,7 @@ class DiskManager {
    */
   explicit DiskManager(const std::string &db_file);
 
-  /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
+  /** Used by DiskManagerPosix, and FOR TEST / LEADERBOARD ONLY by DiskManagerMemory */
   DiskManager() = default;
 
   virtual ~DiskManager() = default;
@@ -42,7 +42,13 @@ class DiskManager {
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
+
+  /**
+   * Make all pages written so far durable. Callers invoke this at explicit sync points, e.g. after flushing the buffer
+   * pool, instead of paying for it on every write.
+   */
+  virtual void Sync();
 
   /**
    * Write a page to the database file.
@@ -58,6 +64,23 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Start writing a page to the database file. The page data must stay untouched until the returned future is ready.
+   * The default implementation writes synchronously with WritePage().
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @return a future that becomes true once the page is written, or false if the write failed
+   */
+  virtual auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool>;
+
+  /**
+   * Start reading a page from the database file. The default implementation reads synchronously with ReadPage().
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, filled once the returned future is ready
+   * @return a future that becomes true once the page is read, or false if the read failed
+   */
+  virtual auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool>;
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -94,6 +117,11 @@ class DiskManager {
 
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
+  /**
+   * Derives the log file name from file_name_ and opens (or creates) the log file.
+   * @return false if file_name_ has no extension to derive the log file name from
+   */
+  auto OpenLog() -> bool;
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
@@ -101,7 +129,7 @@ class DiskManager {
   std::fstream db_io_;
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
   // With multiple buffer pool instances, need to protect file access
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_posix.h
+//
+// Identification: src/include/storage/disk/disk_manager_posix.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerPosix reads and writes pages of the database file with positional pread/pwrite on a file descriptor.
+ * Unlike the stream based DiskManager it has no shared file cursor, so page I/O from different threads does not
+ * serialize on a latch. The file size is tracked in memory instead of being looked up on every read, and writes are
+ * only made durable by Sync(). The log file is handled exactly like in DiskManager.
+ */
+class DiskManagerPosix : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param direct_io open the database file with O_DIRECT, bypassing the OS page cache. Falls back to buffered I/O if
+   * the platform or the file system does not support it.
+   */
+  explicit DiskManagerPosix(const std::string &db_file, bool direct_io = false);
+
+  ~DiskManagerPosix() override;
+
+  /**
+   * Sync and close the database file, then close the log file.
+   */
+  void ShutDown() override;
+
+  /**
+   * fdatasync the database file.
+   */
+  void Sync() override;
+
+  /**
+   * Write a page to the database file.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page from the database file. Pages past the end of the file read as zeroes.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** @return true if the database file is opened with O_DIRECT */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
+ protected:
+  /** O_DIRECT needs the buffer, the file offset and the length to be aligned to the logical block size. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+  /** @return a page sized, DIRECT_IO_ALIGNMENT aligned buffer private to the calling thread */
+  static auto BounceBuffer() -> char *;
+
+  /** Grows the tracked file size to at least `end` bytes. */
+  void GrowFileSize(int64_t end) {
+    int64_t size = file_size_.load();
+    while (size < end && !file_size_.compare_exchange_weak(size, end)) {
+    }
+  }
+
+  /** @return true if page_data cannot be handed to the kernel as is */
+  auto NeedsBounce(const char *page_data) const -> bool {
+    return direct_io_ && reinterpret_cast<uintptr_t>(page_data) % DIRECT_IO_ALIGNMENT != 0;
+  }
+
+  int fd_{-1};
+  bool direct_io_;
+  /** Size of the database file in bytes, grown by every write past its end. */
+  std::atomic<int64_t> file_size_{0};
+};
+
+}  // namespace bustub
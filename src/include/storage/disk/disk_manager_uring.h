@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.h
+//
+// Identification: src/include/storage/disk/disk_manager_uring.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager_posix.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bustub {
+
+/**
+ * DiskManagerUring is a DiskManagerPosix whose asynchronous page I/O goes through an io_uring. Requests from all
+ * threads are queued for one ring thread, which submits everything queued so far and reaps all finished requests in a
+ * single io_uring_enter call, so that callers can keep many pages in flight without a thread per request.
+ *
+ * If the kernel has no io_uring (or it is disabled), the asynchronous calls fall back to synchronous pread/pwrite. The
+ * synchronous WritePage/ReadPage never go through the ring.
+ */
+class DiskManagerUring : public DiskManagerPosix {
+ public:
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param direct_io open the database file with O_DIRECT, see DiskManagerPosix
+   * @param queue_depth the maximum number of page requests in flight in the ring
+   */
+  explicit DiskManagerUring(const std::string &db_file, bool direct_io = false,
+                            size_t queue_depth = URING_QUEUE_DEPTH);
+
+  ~DiskManagerUring() override;
+
+  /**
+   * Wait for all queued requests, stop the ring, then sync and close the files.
+   */
+  void ShutDown() override;
+
+  /**
+   * Queue a page write on the ring. Sync() only covers writes whose future is ready.
+   * @param page_id id of the page
+   * @param page_data raw page data, must stay untouched until the returned future is ready
+   * @return a future that becomes true once the page is written, or false if the write failed
+   */
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool> override;
+
+  /**
+   * Queue a page read on the ring. Pages past the end of the file read as zeroes.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, filled once the returned future is ready
+   * @return a future that becomes true once the page is read, or false if the read failed
+   */
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool> override;
+
+  /** @return true if asynchronous I/O goes through io_uring, false if it falls back to synchronous I/O */
+  auto IsUringEnabled() const -> bool { return ring_fd_ >= 0; }
+
+ private:
+  struct IoRequest;
+
+  /** Sets up the ring and its memory mappings. @return false if io_uring is not available */
+  auto SetUpRing(size_t queue_depth) -> bool;
+
+  /** Stops the ring thread once it has finished all queued requests, and tears down the ring. */
+  void TearDownRing();
+
+  /** Hands a request to the ring thread. */
+  auto Enqueue(IoRequest *request) -> std::future<bool>;
+
+  /** @return the next free submission queue entry, or nullptr if the submission queue is full */
+  auto GetSqe() -> io_uring_sqe *;
+
+  /** Fills in a submission queue entry for the part of the request that is not done yet. */
+  void PrepareSqe(io_uring_sqe *sqe, IoRequest *request);
+
+  /**
+   * Accounts for a completion of the request.
+   * @return true if the request is finished, false if the rest of it has to be submitted again
+   */
+  auto CompleteRequest(IoRequest *request, int result) -> bool;
+
+  /** Body of the ring thread. */
+  void RunRing();
+
+  /** io_uring file descriptor, -1 if io_uring is not used. */
+  int ring_fd_{-1};
+  /** Written to wake the ring thread up while it waits for completions. */
+  int event_fd_{-1};
+  size_t queue_depth_{0};
+
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_entries_{nullptr};
+  unsigned *sq_array_{nullptr};
+  /** Submission queue tail including the entries filled in but not submitted yet. */
+  unsigned sq_next_tail_{0};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+
+  /** Requests not yet picked up by the ring thread. */
+  std::vector<IoRequest *> queue_;
+  bool stop_ring_{false};
+  std::mutex queue_latch_;
+  std::thread ring_thread_;
+};
+
+}  // namespace bustub
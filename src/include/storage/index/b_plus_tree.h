@@ -10,6 +10,7 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <vector>
@@ -32,15 +33,18 @@ namespace bustub {
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Optionally store its pages compressed, see CompressedEntries
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool compressed = false);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -50,15 +54,27 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
 
+  // Build this B+ tree, which has to be empty, bottom-up from pairs sorted by key without duplicates. Every node is
+  // filled to fill_factor of its capacity. Returns false if the tree is not empty.
+  auto BulkLoad(const std::vector<MappingType> &items, double fill_factor = BTREE_FILL_FACTOR) -> bool;
+
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
   // return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr) -> bool;
 
+  // return the values associated with every key, results[i] for keys[i]; the keys are probed in sorted order
+  void GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                 Transaction *transaction = nullptr);
+
   // return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
+  // the number of levels and of pages of the tree, for benchmarks and tests; no writer may run meanwhile
+  auto GetHeight() -> int;
+  auto GetPageCount() -> size_t;
+
   // index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
@@ -76,6 +92,12 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
 
+  /*
+   * op 0: read, read latches all the way down; the caller holds root_latch_ in read mode.
+   * op 1 / 2: insert / remove, write latches all the way down and keeps the unsafe pages in the transaction's page set.
+   * op 3: optimistic insert or remove, read latches the internal pages and write latches only the leaf; the caller
+   *       holds root_latch_ in read mode.
+   */
   Page *FindLeafPage(const KeyType &key, bool leftMost, bool rightMost,int op, Transaction *transaction);
  
  
@@ -84,6 +106,33 @@ class BPlusTree {
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
+  bool InsertOptimistic(const KeyType &key, const ValueType &value, bool *inserted);
+
+  bool RemoveOptimistic(const KeyType &key);
+
+  // Descend without latches; the leaf is neither pinned nor latched and is only valid until its version changes
+  Page *FindLeafPageOptimistic(const KeyType &key, bool leftMost, uint64_t *version);
+
+  // Descend with read latch crabbing; the leaf is pinned and read latched, nullptr if the tree is empty
+  Page *FindLeafPageLatched(const KeyType &key, bool leftMost);
+
+  // Whether a node takes any new entry without splitting, so that the latches above it can be released
+  bool IsInsertSafe(BPlusTreePage *node);
+
+  // One level of a tree being bulk loaded: the level has nodes_ nodes sharing entries_ entries evenly, and only the
+  // node being filled is pinned.
+  struct BulkLevel {
+    size_t entries_;
+    size_t nodes_;
+    size_t opened_{0};
+    int target_{0};
+    int filled_{0};
+    Page *page_{nullptr};
+  };
+
+  // Close the node being filled on a level of a bulk load and start the next one, whose first key is first_key
+  void BulkOpenNode(std::vector<BulkLevel> *levels, size_t level, const KeyType &first_key);
+
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
@@ -97,6 +146,14 @@ class BPlusTree {
   bool Coalesce(N *neighbor_node, N *node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent,
                 int index, Transaction *transaction = nullptr);
 
+  // Whether node and its neighbor fit into one page, with the key between them for internal pages
+  template <typename N>
+  bool CanCoalesce(N *neighbor_node, N *node, InternalPage *parent, int index);
+
+  // Whether the parent has room for the key that moves into it when an entry moves over from the neighbor
+  template <typename N>
+  bool CanRedistribute(N *neighbor_node, InternalPage *parent, int index);
+
   template <typename N>
   void Redistribute(N *neighbor_node, N *node, 
                                   BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent,int index);
@@ -113,11 +170,13 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  // atomic, because optimistic readers read it without root_latch_
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool compressed_;
   ReaderWriterLatch root_latch_;
 };
 
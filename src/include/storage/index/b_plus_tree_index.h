@@ -27,20 +27,34 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  /** @param compressed whether the pages of the tree are compressed, see CompressedEntries */
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 bool compressed = false);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
+  /** Sorts the entries and bulk loads them if the index is empty, see BPlusTree::BulkLoad. */
+  void InsertEntries(std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) override;
+
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /** Probes the keys in key order, see BPlusTree::GetValues. */
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  /** The shape of the tree, see BPlusTree::GetHeight and BPlusTree::GetPageCount. */
+  auto GetHeight() -> int { return container_.GetHeight(); }
+
+  auto GetPageCount() -> size_t { return container_.GetPageCount(); }
+
  protected:
   // comparator for key
   KeyComparator comparator_;
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 
 #include "storage/table/tuple.h"
@@ -32,7 +33,8 @@ class GenericKey {
   inline void SetFromKey(const Tuple &tuple) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    // a VARCHAR longer than its column is declared is cut off
+    memcpy(data_, tuple.GetData(), std::min<size_t>(tuple.GetLength(), KeySize));
   }
 
   // NOTE: for test purpose only
@@ -51,6 +53,12 @@ class GenericKey {
     } else {
       int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
       data_ptr = (data_ + offset);
+      uint32_t len = *reinterpret_cast<const uint32_t *>(data_ptr);
+      uint32_t stored = KeySize - offset - sizeof(uint32_t);
+      if (len != BUSTUB_VALUE_NULL && len > stored) {
+        // only the start of the string was copied into the key
+        return {column_type, data_ptr + sizeof(uint32_t), stored, true};
+      }
     }
     return Value::DeserializeFrom(data_ptr, column_type);
   }
@@ -70,6 +78,86 @@ class GenericKey {
   char data_[KeySize];
 };
 
+/** Key schemas whose keys can be compared on their raw bytes. */
+enum class KeyLayout { GENERIC, INTEGER, BIGINT, INTEGER_PAIR, VARCHAR };
+
+/**
+ * Compares two keys of one layout on their raw bytes, without building Values. NULL sorts before every other value,
+ * like in GenericComparator::CompareValues.
+ */
+template <size_t KeySize, KeyLayout Layout>
+struct KeyLayoutComparator;
+
+template <size_t KeySize>
+struct KeyLayoutComparator<KeySize, KeyLayout::INTEGER> {
+  static inline auto Compare(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) -> int {
+    return CompareAt<int32_t>(lhs, rhs, 0);
+  }
+
+  template <typename T>
+  static inline auto CompareAt(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs, size_t offset) -> int {
+    T lhs_value;
+    T rhs_value;
+    memcpy(&lhs_value, lhs.data_ + offset, sizeof(T));
+    memcpy(&rhs_value, rhs.data_ + offset, sizeof(T));
+    return static_cast<int>(lhs_value > rhs_value) - static_cast<int>(lhs_value < rhs_value);
+  }
+};
+
+template <size_t KeySize>
+struct KeyLayoutComparator<KeySize, KeyLayout::BIGINT> {
+  static inline auto Compare(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) -> int {
+    return KeyLayoutComparator<KeySize, KeyLayout::INTEGER>::template CompareAt<int64_t>(lhs, rhs, 0);
+  }
+};
+
+template <size_t KeySize>
+struct KeyLayoutComparator<KeySize, KeyLayout::INTEGER_PAIR> {
+  static inline auto Compare(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) -> int {
+    using Integer = KeyLayoutComparator<KeySize, KeyLayout::INTEGER>;
+    int result = Integer::template CompareAt<int32_t>(lhs, rhs, 0);
+    return result != 0 ? result : Integer::template CompareAt<int32_t>(lhs, rhs, sizeof(int32_t));
+  }
+};
+
+/**
+ * A single VARCHAR column: the key holds the offset of the string, its length including the terminating zero, and as
+ * many of its bytes as fit into the key. Only those bytes are compared, so longer strings compare by their prefix.
+ */
+template <size_t KeySize>
+struct KeyLayoutComparator<KeySize, KeyLayout::VARCHAR> {
+  static inline auto Compare(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) -> int {
+    const char *lhs_str;
+    const char *rhs_str;
+    uint32_t lhs_len = Prefix(lhs, &lhs_str);
+    uint32_t rhs_len = Prefix(rhs, &rhs_str);
+    if (lhs_str == nullptr || rhs_str == nullptr) {
+      return static_cast<int>(lhs_str != nullptr) - static_cast<int>(rhs_str != nullptr);
+    }
+    int result = memcmp(lhs_str, rhs_str, std::min(lhs_len, rhs_len));
+    if (result != 0) {
+      return result;
+    }
+    return static_cast<int>(lhs_len > rhs_len) - static_cast<int>(lhs_len < rhs_len);
+  }
+
+  /** @return the length of the prefix of the string in the key, which *str points to; nullptr for NULL */
+  static inline auto Prefix(const GenericKey<KeySize> &key, const char **str) -> uint32_t {
+    uint32_t offset;
+    uint32_t len;
+    memcpy(&offset, key.data_, sizeof(uint32_t));
+    offset = std::min<uint32_t>(offset, KeySize - sizeof(uint32_t));
+    memcpy(&len, key.data_ + offset, sizeof(uint32_t));
+    if (len == BUSTUB_VALUE_NULL) {
+      *str = nullptr;
+      return 0;
+    }
+    *str = key.data_ + offset + sizeof(uint32_t);
+    uint32_t stored = KeySize - offset - sizeof(uint32_t);
+    return len == 0 ? 0 : std::min(len - 1, stored);
+  }
+};
+
 /**
  * Function object returns true if lhs < rhs, used for trees
  */
@@ -77,12 +165,62 @@ template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    switch (layout_) {
+      case KeyLayout::INTEGER:
+        return KeyLayoutComparator<KeySize, KeyLayout::INTEGER>::Compare(lhs, rhs);
+      case KeyLayout::BIGINT:
+        return KeyLayoutComparator<KeySize, KeyLayout::BIGINT>::Compare(lhs, rhs);
+      case KeyLayout::INTEGER_PAIR:
+        return KeyLayoutComparator<KeySize, KeyLayout::INTEGER_PAIR>::Compare(lhs, rhs);
+      case KeyLayout::VARCHAR:
+        return KeyLayoutComparator<KeySize, KeyLayout::VARCHAR>::Compare(lhs, rhs);
+      case KeyLayout::GENERIC:
+        break;
+    }
+    return CompareValues(lhs, rhs);
+  }
+
+  /** @return the layout of the keys of key_schema that fit into KeySize bytes, GENERIC if there is none */
+  static auto LayoutOf(const Schema *key_schema) -> KeyLayout {
+    const auto &columns = key_schema->GetColumns();
+    if (columns.size() == 1 && columns[0].GetType() == TypeId::INTEGER && KeySize >= sizeof(int32_t)) {
+      return KeyLayout::INTEGER;
+    }
+    if (columns.size() == 1 && columns[0].GetType() == TypeId::BIGINT && KeySize >= sizeof(int64_t)) {
+      return KeyLayout::BIGINT;
+    }
+    if (columns.size() == 2 && columns[0].GetType() == TypeId::INTEGER && columns[1].GetType() == TypeId::INTEGER &&
+        KeySize >= 2 * sizeof(int32_t)) {
+      return KeyLayout::INTEGER_PAIR;
+    }
+    if (columns.size() == 1 && columns[0].GetType() == TypeId::VARCHAR && KeySize >= 2 * sizeof(uint32_t)) {
+      return KeyLayout::VARCHAR;
+    }
+    return KeyLayout::GENERIC;
+  }
+
+  auto GetLayout() const -> KeyLayout { return layout_; }
+
+  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_}, layout_{other.layout_} {}
+
+  // constructor, picks the comparison for the key schema once
+  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema), layout_(LayoutOf(key_schema)) {}
+
+ private:
+  inline auto CompareValues(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
       Value lhs_value = (lhs.ToValue(key_schema_, i));
       Value rhs_value = (rhs.ToValue(key_schema_, i));
 
+      // a comparison with NULL is never true, NULL sorts first so that keys have an order
+      if (lhs_value.IsNull() || rhs_value.IsNull()) {
+        if (lhs_value.IsNull() != rhs_value.IsNull()) {
+          return lhs_value.IsNull() ? -1 : 1;
+        }
+        continue;
+      }
       if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
         return -1;
       }
@@ -94,13 +232,8 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
-
-  // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
-
- private:
   Schema *key_schema_;
+  KeyLayout layout_;
 };
 
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
@@ -139,6 +140,12 @@ class Index {
   /** @return The index key attributes */
   auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetKeyAttrs(); }
 
+  /**
+   * @return whether the index holds every entry inserted into it. An index that keeps a single entry per key turns
+   * the later entries of a key away, and from then on it cannot stand in for a scan of its table.
+   */
+  auto HoldsEveryEntry() const -> bool { return holds_every_entry_; }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -159,6 +166,18 @@ class Index {
    */
   virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
+  /**
+   * Insert many entries at once, e.g. when building the index on a table that already has rows. Like with
+   * InsertEntry, the first entry of a key wins. The default inserts the entries one at a time.
+   * @param entries The index keys and the RIDs associated with them, may be reordered
+   * @param transaction The transaction context
+   */
+  virtual void InsertEntries(std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) {
+    for (const auto &[key, rid] : *entries) {
+      InsertEntry(key, rid, transaction);
+    }
+  }
+
   /**
    * Delete an index entry by key.
    * @param key The index key
@@ -175,9 +194,29 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Search the index for many keys at once. The default searches for the keys one at a time.
+   * @param keys The index keys
+   * @param results Set to one collection of RIDs per key, results[i] for keys[i]
+   * @param transaction The transaction context
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->assign(keys.size(), {});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
+ protected:
+  /** Records that an entry was turned away, see HoldsEveryEntry. */
+  void TurnedEntryAway() { holds_every_entry_ = false; }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
+  /** False once an entry was turned away */
+  std::atomic<bool> holds_every_entry_{true};
 };
 
 }  // namespace bustub
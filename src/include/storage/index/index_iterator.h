@@ -13,19 +13,31 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * The iterator works on a copy of the current leaf, so it holds no pin or latch between calls. Leaves are read like
+ * point lookups, without writing to any latch when they are in memory. When the iterator moves on to the next leaf,
+ * it checks that the current leaf did not change in the meantime, i.e. that the next page id it copied is still right.
+ * Otherwise it descends the tree again to the first key after the last one it returned.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  friend class BPlusTree<KeyType, ValueType, KeyComparator>;
+
  public:
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
-  // you may define your own constructor based on your member variables
-  // IndexIterator();
-  IndexIterator(BufferPoolManager *bpm, Page *page,int index = 0);
+  // Creates an iterator that is at the end, tree may be nullptr
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm);
   ~IndexIterator();  // NOLINT
 
   auto IsEnd() -> bool;
@@ -39,11 +51,27 @@ class IndexIterator {
   auto operator!=(const IndexIterator &itr) const -> bool;
 
  private:
-  // add your own private member variables here
+  // Position the iterator at the first key >= key, or at the first key of the tree if leftMost
+  void Seek(const KeyType &key, bool leftMost);
+
+  // Copy the leaf key belongs in (or the leftmost leaf) into this iterator
+  void ReadLeaf(const KeyType &key, bool leftMost);
+
+  // Copy the leaf after the current one; false if the current leaf changed since it was copied
+  auto ReadNextLeaf() -> bool;
+
+  // Copy the entries and the next page id of a leaf that is latched or read optimistically
+  void CopyLeaf(Page *page);
+
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_;
   BufferPoolManager *buffer_pool_manager_;
-  Page *page_;
-  LeafPage *leaf_ = nullptr;
-  int index_ = 0; 
+  // the entries of the current leaf
+  std::vector<MappingType> items_;
+  // the frame the current leaf was copied from, not pinned, and its version at that time
+  Page *page_ = nullptr;
+  uint64_t version_ = 0;
+  page_id_t next_page_id_ = INVALID_PAGE_ID;
+  int index_ = 0;
 };
 
 }  // namespace bustub
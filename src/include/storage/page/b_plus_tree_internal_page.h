@@ -11,14 +11,21 @@
 #pragma once
 
 #include <queue>
+#include <vector>
 
 #include "storage/page/b_plus_tree_page.h"
+#include "storage/page/compressed_entries.h"
+#include "storage/page/integer_key_search.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
 #define INTERNAL_PAGE_HEADER_SIZE 24
 #define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_AREA_SIZE (BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE)
+// Like COMPRESSED_LEAF_PAGE_SIZE, twice what fits without compression
+#define COMPRESSED_INTERNAL_PAGE_SIZE \
+  (2 * (CompressedEntries<std::pair<KeyType, page_id_t>>::UncompressedCapacity(INTERNAL_PAGE_AREA_SIZE) - 1))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -31,12 +38,16 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * A compressed internal page (COMPRESSED_INTERNAL_PAGE) stores the same
+ * entries with CompressedEntries after the header instead.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            bool compressed = false);
 
   auto KeyAt(int index) const -> KeyType;
   void SetKeyAt(int index, const KeyType &key);
@@ -50,6 +61,21 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void Remove(int index);
   auto RemoveAndReturnOnlyChild() -> ValueType;
 
+  // Bulk loading: append a child that is larger than every child in the page
+  void Append(const KeyType &key, const ValueType &value);
+  // Whether the pair can be inserted without splitting the page
+  bool HasRoomFor(const KeyType &key, const ValueType &value) const;
+  // Whether any pair can be inserted without splitting the page
+  bool HasRoomForAny() const;
+  // Whether the key at index can be replaced by key
+  bool CanSetKeyAt(int index, const KeyType &key) const;
+  // Whether the entries of other, whose first key becomes middle_key, fit into this page as well
+  bool CanMergeWith(const BPlusTreeInternalPage *other, const KeyType &middle_key) const;
+
+  // For readers without a latch: the child key belongs in, and nothing outside of the page is read.
+  // INVALID_PAGE_ID if the page cannot be a valid internal page.
+  auto LookupChildOptimistic(const KeyType &key, bool leftMost, const KeyComparator &comparator) const -> ValueType;
+
   // Split and Merge utility methods
   void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
   void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
@@ -59,9 +85,12 @@ class BPlusTreeInternalPage : public BPlusTreePage {
                          BufferPoolManager *buffer_pool_manager);
 
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+  void CopyNFrom(const MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+  // All the entries of a compressed page, and writing them back
+  auto DecodeEntries() const -> std::vector<MappingType>;
+  void EncodeEntries(const std::vector<MappingType> &items);
   // Flexible array member for page data.
   MappingType array_[1];
 };
@@ -15,12 +15,18 @@
 #include <algorithm>
 
 #include "storage/page/b_plus_tree_page.h"
+#include "storage/page/compressed_entries.h"
+#include "storage/page/integer_key_search.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
 #define LEAF_PAGE_HEADER_SIZE 28
 #define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_AREA_SIZE (BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE)
+// Twice what fits without compression, so that both halves of a split take any entry, see BPlusTree::InsertIntoLeaf
+#define COMPRESSED_LEAF_PAGE_SIZE \
+  (2 * (CompressedEntries<MappingType>::UncompressedCapacity(LEAF_PAGE_AREA_SIZE) - 1))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -39,23 +45,41 @@ namespace bustub {
  *  -----------------------------------------------
  * | ParentPageId (4) | PageId (4) | NextPageId (4)
  *  -----------------------------------------------
+ *
+ * A compressed leaf page (COMPRESSED_LEAF_PAGE) stores the same entries with
+ * CompressedEntries after the header instead, so it holds more of them when
+ * the keys of the page share bytes.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE,
+            bool compressed = false);
   // helper methods
   auto GetNextPageId() -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
   auto KeyAt(int index) const -> KeyType;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  auto GetItem(int index) const -> MappingType;
+  // Whether the pair can be inserted without splitting the page
+  bool HasRoomFor(const KeyType &key, const ValueType &value) const;
+  // Whether any pair can be inserted without splitting the page
+  bool HasRoomForAny() const;
+  // Whether the entries of other fit into this page as well
+  bool CanMergeWith(const BPlusTreeLeafPage *other) const;
   auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int;
   bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
 
+  // For readers without a latch: the page may change meanwhile, so nothing outside of it is read
+  bool LookupOptimistic(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
+  void CopyItemsOptimistic(std::vector<MappingType> *items) const;
+
+  // Bulk loading: append items that are sorted and larger than every key in the page
+  void AppendSorted(const MappingType *items, int size);
+
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
@@ -66,8 +90,11 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   page_id_t next_page_id_;
   // Flexible array member for page data.
   MappingType array_[1];
-  void CopyNFrom(MappingType *items, int size);
+  void CopyNFrom(const MappingType *items, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
+  // All the entries of a compressed page, and writing them back
+  auto DecodeEntries() const -> std::vector<MappingType>;
+  void EncodeEntries(const std::vector<MappingType> &items);
 };
 }  // namespace bustub
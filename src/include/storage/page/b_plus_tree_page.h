@@ -25,7 +25,14 @@ namespace bustub {
 #define INDEX_TEMPLATE_ARGUMENTS template <typename KeyType, typename ValueType, typename KeyComparator>
 
 // define page type enum
-enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
+// compressed pages store their entries with CompressedEntries, see storage/page/compressed_entries.h
+enum class IndexPageType {
+  INVALID_INDEX_PAGE = 0,
+  LEAF_PAGE,
+  INTERNAL_PAGE,
+  COMPRESSED_LEAF_PAGE,
+  COMPRESSED_INTERNAL_PAGE
+};
 
 /**
  * Both internal and leaf page are inherited from this page.
@@ -44,6 +51,7 @@ class BPlusTreePage {
  public:
   auto IsLeafPage() const -> bool;
   auto IsRootPage() const -> bool;
+  auto IsCompressed() const -> bool;
   void SetPageType(IndexPageType page_type);
   IndexPageType GetPageType();
 
@@ -71,7 +79,6 @@ class BPlusTreePage {
   int max_size_ ;
   page_id_t parent_page_id_ ;
   page_id_t page_id_ ;
-  ReaderWriterLatch root_latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_entries.h
+//
+// Identification: src/include/storage/page/compressed_entries.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * The entries of a compressed B+ tree page. Keys are stored as the raw bytes of a GenericKey, where integers are little
+ * endian and short keys are padded with zeros, so the keys of a page usually share their trailing bytes as well as
+ * their leading ones, and so do the record ids or child page ids next to them. Every byte position that holds the same
+ * byte in all the entries of a page is therefore stored once, in a template entry, and every entry only keeps the
+ * bytes at the other positions.
+ *
+ * Layout of the entry area of a page:
+ *  ---------------------------------------------------------------------------------------------
+ * | MASK (ceil(W / 8)) | TEMPLATE (W) | VARYING BYTES(0) | VARYING BYTES(1) | ... | VARYING BYTES(n) |
+ *  ---------------------------------------------------------------------------------------------
+ * where W is the size of an entry, and bit b of MASK is set if byte b differs between the entries.
+ *
+ * Readers that do not latch the page may see any bytes in the area, so no entry is read from outside of it.
+ */
+template <typename Entry>
+class CompressedEntries {
+ public:
+  static constexpr size_t ENTRY_SIZE = sizeof(Entry);
+  static constexpr size_t MASK_SIZE = (ENTRY_SIZE + 7) / 8;
+  static constexpr size_t HEADER_SIZE = MASK_SIZE + ENTRY_SIZE;
+
+  /** Reads entries of one page, the mask is only read once. */
+  class Reader {
+   public:
+    /** The entries encoded in the area_size bytes at data. */
+    Reader(const char *data, size_t area_size) : data_(data) {
+      auto varying = ReadMask(data);
+      std::memcpy(static_cast<void *>(&template_), data + MASK_SIZE, ENTRY_SIZE);
+      for (size_t b = 0; b < ENTRY_SIZE; b++) {
+        if (varying[b]) {
+          positions_[width_++] = static_cast<uint8_t>(b);
+        }
+      }
+      slots_ = width_ == 0 ? 1 : (area_size - HEADER_SIZE) / width_;
+    }
+
+    /** @return entry index; an index past the area, which only a reader without a latch can ask for, is clamped */
+    auto Get(int index) const -> Entry {
+      Entry entry = template_;
+      size_t slot = std::min(static_cast<size_t>(std::max(index, 0)), slots_ - 1);
+      const char *in = data_ + HEADER_SIZE + slot * width_;
+      auto *bytes = reinterpret_cast<char *>(&entry);
+      for (size_t i = 0; i < width_; i++) {
+        bytes[positions_[i]] = in[i];
+      }
+      return entry;
+    }
+
+   private:
+    const char *data_;
+    Entry template_;
+    std::array<uint8_t, ENTRY_SIZE> positions_{};
+    size_t width_{0};
+    size_t slots_;
+  };
+
+  /** @return the number of entries an area of area_size bytes holds when no byte is shared */
+  static constexpr auto UncompressedCapacity(size_t area_size) -> int {
+    return static_cast<int>((area_size - HEADER_SIZE) / ENTRY_SIZE);
+  }
+
+  /** @return the number of bytes the entries need */
+  static auto EncodedSize(const Entry *entries, int size) -> size_t {
+    std::bitset<ENTRY_SIZE> varying;
+    for (int i = 1; i < size; i++) {
+      varying |= Diff(entries[0], entries[i]);
+    }
+    return HEADER_SIZE + size * varying.count();
+  }
+
+  /** @return the number of bytes the size encoded entries in data need once entry is added */
+  static auto EncodedSizeWith(const char *data, int size, const Entry &entry) -> size_t {
+    if (size == 0) {
+      return HEADER_SIZE;
+    }
+    Entry first;
+    std::memcpy(static_cast<void *>(&first), data + MASK_SIZE, ENTRY_SIZE);
+    auto varying = ReadMask(data) | Diff(first, entry);
+    return HEADER_SIZE + (size + 1) * varying.count();
+  }
+
+  /** @return how many of the first max_count entries fit into budget bytes, at least one */
+  static auto FitCount(const Entry *entries, int max_count, size_t budget) -> int {
+    std::bitset<ENTRY_SIZE> varying;
+    for (int i = 1; i < max_count; i++) {
+      auto with_next = varying | Diff(entries[0], entries[i]);
+      if (HEADER_SIZE + (i + 1) * with_next.count() > budget) {
+        return i;
+      }
+      varying = with_next;
+    }
+    return max_count;
+  }
+
+  /** Encode the entries into data, which has to have EncodedSize(entries, size) bytes. */
+  static void Encode(const Entry *entries, int size, char *data) {
+    std::bitset<ENTRY_SIZE> varying;
+    for (int i = 1; i < size; i++) {
+      varying |= Diff(entries[0], entries[i]);
+    }
+    std::memset(data, 0, MASK_SIZE);
+    for (size_t b = 0; b < ENTRY_SIZE; b++) {
+      if (varying[b]) {
+        data[b / 8] = static_cast<char>(data[b / 8] | (1 << (b % 8)));
+      }
+    }
+    if (size == 0) {
+      std::memset(data + MASK_SIZE, 0, ENTRY_SIZE);
+      return;
+    }
+    std::memcpy(data + MASK_SIZE, &entries[0], ENTRY_SIZE);
+    char *out = data + HEADER_SIZE;
+    for (int i = 0; i < size; i++) {
+      const auto *bytes = reinterpret_cast<const char *>(&entries[i]);
+      for (size_t b = 0; b < ENTRY_SIZE; b++) {
+        if (varying[b]) {
+          *out++ = bytes[b];
+        }
+      }
+    }
+  }
+
+  /** @return entry index of the entries encoded in the area_size bytes at data */
+  static auto Decode(const char *data, size_t area_size, int index) -> Entry {
+    return Reader(data, area_size).Get(index);
+  }
+
+  /** @return all the size entries encoded in the area_size bytes at data */
+  static auto DecodeAll(const char *data, size_t area_size, int size) -> std::vector<Entry> {
+    Reader reader(data, area_size);
+    std::vector<Entry> entries;
+    entries.reserve(size);
+    for (int i = 0; i < size; i++) {
+      entries.push_back(reader.Get(i));
+    }
+    return entries;
+  }
+
+ private:
+  static auto ReadMask(const char *data) -> std::bitset<ENTRY_SIZE> {
+    std::bitset<ENTRY_SIZE> varying;
+    for (size_t b = 0; b < ENTRY_SIZE; b++) {
+      varying[b] = ((static_cast<unsigned char>(data[b / 8]) >> (b % 8)) & 1) != 0;
+    }
+    return varying;
+  }
+
+  static auto Diff(const Entry &a, const Entry &b) -> std::bitset<ENTRY_SIZE> {
+    const auto *a_bytes = reinterpret_cast<const char *>(&a);
+    const auto *b_bytes = reinterpret_cast<const char *>(&b);
+    std::bitset<ENTRY_SIZE> diff;
+    for (size_t b_idx = 0; b_idx < ENTRY_SIZE; b_idx++) {
+      diff[b_idx] = a_bytes[b_idx] != b_bytes[b_idx];
+    }
+    return diff;
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * One page of the free space map of a table heap. The pages of a map form a singly linked list, and every table page
+ * has one entry in it, in the order the pages were added to the table.
+ *
+ *  Format (size in bytes):
+ *  -------------------------------------------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | NextPageId (4) | EntryCount (4) | TablePageId_1 (4) | FreeSpace_1 (4) | ... |
+ *  -------------------------------------------------------------------------------------------------
+ *
+ * FreeSpace is the size of the largest tuple the table page could take when the entry was last updated. Entries are
+ * not logged, so after a crash they may be off; the table heap only uses them as hints.
+ */
+class FreeSpaceMapPage : public Page {
+ public:
+  /** Maximum number of entries in one page. */
+  static constexpr uint32_t CAPACITY = (BUSTUB_PAGE_SIZE - 16) / 8;
+
+  /** Initialize an empty free space map page. */
+  void Init(page_id_t page_id) {
+    memcpy(GetData(), &page_id, sizeof(page_id_t));
+    SetNextPageId(INVALID_PAGE_ID);
+    SetEntryCount(0);
+  }
+
+  /** @return the page ID of the next free space map page */
+  auto GetNextPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the next free space map page. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of entries in this page */
+  auto GetEntryCount() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_ENTRY_COUNT); }
+
+  /** @return the table page of entry i */
+  auto GetTablePageId(uint32_t i) -> page_id_t {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_ENTRIES + SIZE_ENTRY * i);
+  }
+
+  /** @return the recorded free space of entry i */
+  auto GetFreeSpace(uint32_t i) -> uint32_t {
+    return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_ENTRIES + SIZE_ENTRY * i + sizeof(page_id_t));
+  }
+
+  /** Set the recorded free space of entry i. */
+  void SetFreeSpace(uint32_t i, uint32_t free_space) {
+    memcpy(GetData() + OFFSET_ENTRIES + SIZE_ENTRY * i + sizeof(page_id_t), &free_space, sizeof(uint32_t));
+  }
+
+  /**
+   * Add an entry at the end of this page.
+   * @return the index of the new entry, or -1 if the page is full
+   */
+  auto Append(page_id_t table_page_id, uint32_t free_space) -> int {
+    uint32_t i = GetEntryCount();
+    if (i == CAPACITY) {
+      return -1;
+    }
+    memcpy(GetData() + OFFSET_ENTRIES + SIZE_ENTRY * i, &table_page_id, sizeof(page_id_t));
+    SetFreeSpace(i, free_space);
+    SetEntryCount(i + 1);
+    return static_cast<int>(i);
+  }
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_ENTRY_COUNT = 12;
+  static constexpr size_t OFFSET_ENTRIES = 16;
+  static constexpr size_t SIZE_ENTRY = 8;
+
+  void SetEntryCount(uint32_t count) { memcpy(GetData() + OFFSET_ENTRY_COUNT, &count, sizeof(uint32_t)); }
+};
+
+}  // namespace bustub
@@ -30,9 +30,10 @@ namespace bustub {
  *  ----------------------------------------------------------------
  *
  *  Here '+' means concatenation.
- *  The above format omits the space required for the occupied_ and
- *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
+ *  The above format omits the space required for the overflow page id and the
+ *  occupied_ and readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
  *
+ *  A bucket whose entries cannot be split apart links to overflow pages, which are bucket pages too.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -40,6 +41,23 @@ class HashTableBucketPage {
   // Delete all constructor / destructor to ensure memory safety
   HashTableBucketPage() = delete;
 
+  /**
+   * Initializes a new bucket page, which has no overflow page. The rest of a new page is zeroed already.
+   */
+  void Init();
+
+  /**
+   * @return the next page of the bucket's overflow chain, INVALID_PAGE_ID if there is none
+   */
+  auto GetOverflowPageId() const -> page_id_t;
+
+  /**
+   * Sets the next page of the bucket's overflow chain.
+   *
+   * @param overflow_page_id the overflow page, INVALID_PAGE_ID for none
+   */
+  void SetOverflowPageId(page_id_t overflow_page_id);
+
   /**
    * Scan the bucket and collect values that have the matching key
    *
@@ -138,6 +156,7 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  page_id_t overflow_page_id_;
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// integer_key_search.h
+//
+// Identification: src/include/storage/page/integer_key_search.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "storage/index/generic_key.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BUSTUB_AVX2_KEY_SEARCH
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+/**
+ * Search over the sorted entries of a B+ tree page whose keys are a single INTEGER or BIGINT column, that is an integer
+ * at the start of every entry. A branchless binary search narrows the entries down to one vector of keys, which are
+ * gathered from their entries and compared at once with AVX2 if the CPU has it, and one by one otherwise.
+ */
+template <typename Int>
+class IntegerKeySearch {
+ public:
+  /** Number of keys compared at once, at the end of a search. */
+  static constexpr int WINDOW = 32 / sizeof(Int);
+
+  /**
+   * @return the number of the size entries at base, stride bytes apart, whose key is less than key, or not greater
+   * than key if inclusive
+   */
+  static auto CountBelow(const char *base, size_t stride, int size, Int key, bool inclusive) -> int {
+    int low = 0;
+    int n = size;
+    while (n > WINDOW) {
+      int half = n / 2;
+      Int mid = KeyAt(base, stride, low + half);
+      low = (mid < key || (inclusive && mid == key)) ? low + half : low;
+      n -= half;
+    }
+#ifdef BUSTUB_AVX2_KEY_SEARCH
+    if (HasAvx2()) {
+      return low + CountWindowAvx2(base + low * stride, stride, n, key, inclusive);
+    }
+#endif
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+      Int k = KeyAt(base, stride, low + i);
+      count += static_cast<int>(k < key || (inclusive && k == key));
+    }
+    return low + count;
+  }
+
+  /** @return the integer stored at the start of key */
+  template <typename Key>
+  static auto KeyOf(const Key &key) -> Int {
+    Int value;
+    memcpy(&value, reinterpret_cast<const char *>(&key), sizeof(Int));
+    return value;
+  }
+
+ private:
+  static auto KeyAt(const char *base, size_t stride, int index) -> Int {
+    Int value;
+    memcpy(&value, base + index * stride, sizeof(Int));
+    return value;
+  }
+
+#ifdef BUSTUB_AVX2_KEY_SEARCH
+  static auto HasAvx2() -> bool {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2") != 0;
+    return has_avx2;
+  }
+
+  /** Only the first n lanes are gathered, the entries after them may be past the end of the page. */
+  __attribute__((target("avx2"))) static auto CountWindowAvx2(const char *base, size_t stride, int n, Int key,
+                                                               bool inclusive) -> int {
+    int offsets[WINDOW];
+    for (int i = 0; i < WINDOW; i++) {
+      offsets[i] = static_cast<int>(i * stride);
+    }
+    int lanes = (1 << n) - 1;
+    int hits;
+    if constexpr (sizeof(Int) == sizeof(int32_t)) {
+      __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(offsets));
+      __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(n), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+      __m256i keys = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), reinterpret_cast<const int *>(base), index,
+                                                 mask, 1);
+      __m256i target = _mm256_set1_epi32(static_cast<int32_t>(key));
+      __m256i cmp = inclusive ? _mm256_cmpgt_epi32(keys, target) : _mm256_cmpgt_epi32(target, keys);
+      hits = _mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+    } else {
+      __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i *>(offsets));
+      __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(n), _mm256_setr_epi64x(0, 1, 2, 3));
+      __m256i keys = _mm256_mask_i32gather_epi64(_mm256_setzero_si256(), reinterpret_cast<const long long *>(base),
+                                                 index, mask, 1);
+      __m256i target = _mm256_set1_epi64x(static_cast<int64_t>(key));
+      __m256i cmp = inclusive ? _mm256_cmpgt_epi64(keys, target) : _mm256_cmpgt_epi64(target, keys);
+      hits = _mm256_movemask_pd(_mm256_castsi256_pd(cmp));
+    }
+    // if inclusive, the lanes that are set hold the keys greater than key
+    int matched = __builtin_popcount(hits & lanes);
+    return inclusive ? n - matched : matched;
+  }
+#endif
+};
+
+/**
+ * @return the number of the size entries whose key is less than key, or not greater than key if inclusive, or -1 if
+ * the keys of comparator are not a single integer
+ */
+template <typename Entry, typename Key, typename Comparator>
+auto IntegerKeyCountBelow(const Entry *entries, int size, const Key &key, const Comparator &comparator,
+                          bool inclusive) -> int {
+  const auto *base = reinterpret_cast<const char *>(entries);
+  switch (comparator.GetLayout()) {
+    case KeyLayout::INTEGER:
+      return IntegerKeySearch<int32_t>::CountBelow(base, sizeof(Entry), size,
+                                                   IntegerKeySearch<int32_t>::KeyOf(key), inclusive);
+    case KeyLayout::BIGINT:
+      return IntegerKeySearch<int64_t>::CountBelow(base, sizeof(Entry), size,
+                                                   IntegerKeySearch<int64_t>::KeyOf(key), inclusive);
+    default:
+      return -1;
+  }
+}
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -43,23 +44,51 @@ class Page {
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
   /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  inline auto GetPinCount() -> int {
+    int pin_count = pin_count_;
+    return pin_count < 0 ? 0 : pin_count;
+  }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
   /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    BeginWrite();
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    EndWrite();
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Acquire the page read latch if nobody holds or waits for the write latch. @return true if it was acquired */
+  inline auto TryRLatch() -> bool { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * @return the version of the page. It is odd while the page is write latched or its frame is being reused, and
+   * changes every time either happens. Optimistic readers read a page without any latch between GetVersion and
+   * ValidateVersion.
+   */
+  inline auto GetVersion() const -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * @param version a version returned by GetVersion
+   * @return true if nobody wrote to the page since GetVersion returned version, i.e. everything read since is valid
+   */
+  inline auto ValidateVersion(uint64_t version) const -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -75,19 +104,33 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /** Make the version odd before changing the page without its write latch, see GetVersion. */
+  inline void BeginWrite() {
+    version_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /** Make the version even again, once the page is consistent. */
+  inline void EndWrite() { version_.fetch_add(1, std::memory_order_release); }
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
 
   /** The actual data that is stored within a page. */
   char data_[BUSTUB_PAGE_SIZE]{};
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /**
+   * The pin count of this page. The buffer pool pins and unpins pages without holding its latch, and sets this to -1
+   * while the frame holds no page or is being reclaimed, so that no one can pin it.
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Version for optimistic readers, see GetVersion. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
@@ -72,6 +72,22 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
+  /**
+   * The first page of a table has no previous page, so its PrevPageId slot holds the first page of the table's free
+   * space map instead. Tables written before the free space map existed have INVALID_PAGE_ID there.
+   * @return the page ID of the free space map, only meaningful on the first page of a table
+   */
+  auto GetFreeSpaceMapPageId() -> page_id_t { return GetPrevPageId(); }
+
+  /** Set the page id of the table's free space map, only on the first page of a table. */
+  void SetFreeSpaceMapPageId(page_id_t free_space_map_page_id) { SetPrevPageId(free_space_map_page_id); }
+
+  /** @return the size of the largest tuple InsertTuple can take right now */
+  auto GetMaxInsertSize() -> uint32_t {
+    uint32_t free_space = GetFreeSpaceRemaining();
+    return free_space > SIZE_TUPLE ? free_space - SIZE_TUPLE : 0;
+  }
+
   /**
    * Insert a tuple into the table.
    * @param tuple tuple to insert
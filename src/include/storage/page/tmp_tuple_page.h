@@ -22,15 +22,53 @@ class TmpTuplePage : public Page {
  public:
   void Init(page_id_t page_id, uint32_t page_size) {
     memcpy(GetData(), &page_id, sizeof(page_id_t));
-    memcpy(GetData() + sizeof(page_id_t), &page_size, sizeof(uint32_t));
+    SetFreeSpacePointer(page_size);
   }
 
-  auto GetTablePageId() -> page_id_t { return INVALID_PAGE_ID; }
+  auto GetTablePageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData()); }
 
-  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool { return false; }
+  /**
+   * Inserts a tuple at the end of the free space.
+   * @param tuple the tuple to insert
+   * @param[out] out where the tuple was stored
+   * @return false if the page has no room for the tuple
+   */
+  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool {
+    uint32_t size = sizeof(uint32_t) + tuple.GetLength();
+    if (GetFreeSpacePointer() < SIZE_TMP_TUPLE_PAGE_HEADER + size) {
+      return false;
+    }
+    uint32_t offset = GetFreeSpacePointer() - size;
+    tuple.SerializeTo(GetData() + offset);
+    SetFreeSpacePointer(offset);
+    *out = TmpTuple(GetTablePageId(), offset);
+    return true;
+  }
+
+  /** @return the offset of the tuple inserted last, or the page size if the page is empty */
+  auto GetFreeSpacePointer() -> uint32_t {
+    return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE);
+  }
+
+  /**
+   * Reads a tuple back. Walking from the free space pointer up to the page size visits every tuple, latest first.
+   * @param offset the offset the tuple was stored at
+   * @param[out] tuple the tuple stored there
+   * @return the offset of the tuple inserted before it
+   */
+  auto Get(uint32_t offset, Tuple *tuple) -> uint32_t {
+    tuple->DeserializeFrom(GetData() + offset);
+    return offset + sizeof(uint32_t) + tuple->GetLength();
+  }
 
  private:
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
+
   static_assert(sizeof(page_id_t) == 4);
+  static constexpr size_t OFFSET_FREE_SPACE = sizeof(page_id_t) + sizeof(lsn_t);
+  static constexpr size_t SIZE_TMP_TUPLE_PAGE_HEADER = OFFSET_FREE_SPACE + sizeof(uint32_t);
 };
 
 }  // namespace bustub
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap records roughly how large a tuple every page of a table heap can still take, so that an insert can go
+ * straight to a page with room instead of walking the table. The map is kept in FreeSpaceMapPages, so that it survives
+ * the table being closed and opened again. When the map is opened, its pages are read once to build an in-memory index
+ * from table pages to entries, and an upper bound of the free space in every map page, so that a search only reads the
+ * map pages that can have a match.
+ *
+ * All operations are serialized by one latch, which also protects the map pages.
+ */
+class FreeSpaceMap {
+ public:
+  /**
+   * Create a new, empty free space map.
+   * @param buffer_pool_manager the buffer pool manager
+   */
+  explicit FreeSpaceMap(BufferPoolManager *buffer_pool_manager);
+
+  /**
+   * Open an existing free space map.
+   * @param buffer_pool_manager the buffer pool manager
+   * @param first_page_id the id of the first page of the map
+   */
+  FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id);
+
+  /** @return the id of the first page of the map */
+  auto GetFirstPageId() const -> page_id_t { return map_page_ids_.front(); }
+
+  /** @return the last table page added to the map, or INVALID_PAGE_ID if the map is empty */
+  auto GetLastTablePageId() -> page_id_t;
+
+  /**
+   * Find a table page that can take a tuple of the given size, according to the map.
+   * @param size the size of the tuple
+   * @return the id of the table page, or INVALID_PAGE_ID if no page has enough room
+   */
+  auto FindPage(uint32_t size) -> page_id_t;
+
+  /**
+   * Add a table page to the map.
+   * @param table_page_id the new table page
+   * @param free_space the size of the largest tuple the page can take
+   * @return false if the map could not grow
+   */
+  auto Add(page_id_t table_page_id, uint32_t free_space) -> bool;
+
+  /**
+   * Record the free space of a table page. Pages that are not in the map are ignored.
+   * @param table_page_id the table page
+   * @param free_space the size of the largest tuple the page can take
+   */
+  void Update(page_id_t table_page_id, uint32_t free_space);
+
+  /**
+   * List the table pages in the map, in the order they were added, which is their order in the table heap.
+   * @param[out] table_page_ids the table pages
+   * @return false if the map misses pages, because it could not grow, or its pages could not be read
+   */
+  auto GetTablePageIds(std::vector<page_id_t> *table_page_ids) -> bool;
+
+ private:
+  /** Where the entry of a table page is. */
+  struct Location {
+    size_t map_page_;
+    uint32_t slot_;
+  };
+
+  BufferPoolManager *buffer_pool_manager_;
+  /** The pages of the map, in list order. */
+  std::vector<page_id_t> map_page_ids_;
+  /** For every map page, an upper bound of the free space of its entries. */
+  std::vector<uint32_t> max_free_space_;
+  std::unordered_map<page_id_t, Location> locations_;
+  page_id_t last_table_page_id_{INVALID_PAGE_ID};
+  /** False once a table page could not be added */
+  bool complete_{true};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -12,9 +12,14 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
@@ -22,7 +27,7 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages, plus a FreeSpaceMap that tells inserts which pages have room.
  */
 class TableHeap {
   friend class TableIterator;
@@ -31,7 +36,8 @@ class TableHeap {
   ~TableHeap() = default;
 
   /**
-   * Create a table heap without a transaction. (open table)
+   * Create a table heap without a transaction. (open table) Tables written before the free space map existed get one
+   * built from their pages.
    * @param buffer_pool_manager the buffer pool manager
    * @param lock_manager the lock manager
    * @param log_manager the log manager
@@ -51,7 +57,8 @@ class TableHeap {
             Transaction *txn);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false. The tuple goes to a page
+   * the free space map says has room, or to the last page of the table, which is extended if needed.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
@@ -95,9 +102,12 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param acquire_read_lock false if the caller already holds the read latch of the page
+   * @param access_type the buffer pool access hint for the page, AccessType::Scan when called by a TableIterator
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
+  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true,
+                AccessType access_type = AccessType::Unknown) -> bool;
 
   /** @return the begin iterator of this table */
   auto Begin(Transaction *txn) -> TableIterator;
@@ -108,11 +118,29 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /**
+   * List the pages of this table in order, from the free space map, which takes reading one map page for hundreds of
+   * table pages. Only if the map misses pages are the table pages walked instead.
+   * @param[out] page_ids the pages of the table
+   */
+  void GetPageIds(std::vector<page_id_t> *page_ids);
+
  private:
+  /**
+   * Insert into the last page of the table, or into a new page appended to the table if the last page is full.
+   * @return false if no new page could be created
+   */
+  auto InsertIntoLastPage(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  std::unique_ptr<FreeSpaceMap> free_space_map_;
+  /** The last page of the table. Protected by extend_latch_. */
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+  /** Serializes appending pages to the table. */
+  std::mutex extend_latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,271 @@
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "catalog/schema.h"
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+#include "type/type.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** The bounds the conjuncts of a filter put on one column, and which conjuncts they came from. */
+struct ColumnBounds {
+  std::optional<Value> lower_;
+  bool lower_inclusive_{true};
+  std::optional<Value> upper_;
+  bool upper_inclusive_{true};
+  bool equal_{false};
+  std::vector<size_t> conjuncts_;
+};
+
+void SplitConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get());
+  if (logic_expr != nullptr && logic_expr->logic_type_ == LogicType::And) {
+    SplitConjuncts(logic_expr->GetChildAt(0), conjuncts);
+    SplitConjuncts(logic_expr->GetChildAt(1), conjuncts);
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+/** @return the comparison that holds with its sides swapped, e.g. `a < b` for `b > a` */
+auto FlipComparison(ComparisonType type) -> ComparisonType {
+  switch (type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return type;
+  }
+}
+
+/** Adds the bound that conjunct puts on a column to bounds, if it compares a column with a constant of its type. */
+void AddBound(const AbstractExpressionRef &conjunct, size_t conjunct_idx, std::map<uint32_t, ColumnBounds> *bounds) {
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(conjunct.get());
+  if (comparison == nullptr || comparison->comp_type_ == ComparisonType::NotEqual) {
+    return;
+  }
+  auto type = comparison->comp_type_;
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0).get());
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1).get());
+  if (column == nullptr || constant == nullptr) {
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1).get());
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0).get());
+    type = FlipComparison(type);
+  }
+  if (column == nullptr || constant == nullptr || column->GetTupleIdx() != 0 || constant->val_.IsNull() ||
+      constant->val_.GetTypeId() != column->GetReturnType()) {
+    return;
+  }
+
+  // only the first bound on each end of a column is used, later ones stay in the filter
+  auto &column_bounds = (*bounds)[column->GetColIdx()];
+  bool is_lower = type == ComparisonType::GreaterThan || type == ComparisonType::GreaterThanOrEqual;
+  bool is_upper = type == ComparisonType::LessThan || type == ComparisonType::LessThanOrEqual;
+  if (type == ComparisonType::Equal && !column_bounds.lower_.has_value() && !column_bounds.upper_.has_value()) {
+    column_bounds.lower_ = column_bounds.upper_ = constant->val_;
+    column_bounds.equal_ = true;
+  } else if (is_lower && !column_bounds.lower_.has_value()) {
+    column_bounds.lower_ = constant->val_;
+    column_bounds.lower_inclusive_ = type == ComparisonType::GreaterThanOrEqual;
+  } else if (is_upper && !column_bounds.upper_.has_value()) {
+    column_bounds.upper_ = constant->val_;
+    column_bounds.upper_inclusive_ = type == ComparisonType::LessThanOrEqual;
+  } else {
+    return;
+  }
+  column_bounds.conjuncts_.push_back(conjunct_idx);
+}
+
+/** @return whether a column of type has a least and a greatest value to close the open ends of a range with */
+auto HasValueRange(TypeId type) -> bool {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+/**
+ * @return the number of leading columns of key_attrs that bound a scan of the index, 0 if it cannot. The columns
+ * after them, and an open end of the range on the last of them if the key has other columns, have to be closed with
+ * the least and greatest values of their type.
+ */
+auto BoundedPrefix(const std::vector<uint32_t> &key_attrs, const std::map<uint32_t, ColumnBounds> &bounds,
+                   const Schema &schema) -> size_t {
+  size_t prefix = 0;
+  while (prefix < key_attrs.size()) {
+    auto it = bounds.find(key_attrs[prefix]);
+    if (it == bounds.end()) {
+      break;
+    }
+    prefix++;
+    if (!it->second.equal_) {
+      break;
+    }
+  }
+  if (prefix == 0) {
+    return 0;
+  }
+  for (size_t i = prefix; i < key_attrs.size(); i++) {
+    if (!HasValueRange(schema.GetColumn(key_attrs[i]).GetType())) {
+      return 0;
+    }
+  }
+  const auto &last_bounds = bounds.at(key_attrs[prefix - 1]);
+  if (key_attrs.size() > 1 && !(last_bounds.lower_.has_value() && last_bounds.upper_.has_value()) &&
+      !HasValueRange(schema.GetColumn(key_attrs[prefix - 1]).GetType())) {
+    return 0;
+  }
+  return prefix;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterAsIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Filter) {
+    return optimized_plan;
+  }
+  const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
+  BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Filter with multiple children?? Impossible!");
+  const auto &child_plan = optimized_plan->children_[0];
+  if (child_plan->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
+  if (seq_scan.filter_predicate_ != nullptr) {
+    return optimized_plan;
+  }
+
+  std::vector<AbstractExpressionRef> conjuncts;
+  SplitConjuncts(filter_plan.GetPredicate(), &conjuncts);
+  std::map<uint32_t, ColumnBounds> bounds;
+  for (size_t i = 0; i < conjuncts.size(); i++) {
+    AddBound(conjuncts[i], i, &bounds);
+  }
+  if (bounds.empty()) {
+    return optimized_plan;
+  }
+
+  // An index can bound the scan if a leading column of its key is bounded. Every bounded column but the last has to
+  // be equal to a constant. Among those indexes, the one bounding the most columns leaves the fewest tuples to scan,
+  // and a hash index finds them with a single probe. A B+ tree keeps one entry per key, so once it turned away the
+  // entry of a row whose key it held already, it misses rows.
+  const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
+  const IndexInfo *best_index = nullptr;
+  size_t best_prefix = 0;
+  for (const auto *index : catalog_.GetTableIndexes(table_info->name_)) {
+    if (!index->index_->HoldsEveryEntry()) {
+      continue;
+    }
+    const auto &key_attrs = index->index_->GetKeyAttrs();
+    auto prefix = BoundedPrefix(key_attrs, bounds, table_info->schema_);
+    // a hash index only finds keys whose every column is equal to a constant
+    if (index->index_type_ == IndexType::HashTableIndex &&
+        (prefix < key_attrs.size() || !bounds.at(key_attrs.back()).equal_)) {
+      continue;
+    }
+    if (prefix > best_prefix ||
+        (prefix > 0 && prefix == best_prefix && index->index_type_ == IndexType::HashTableIndex)) {
+      best_index = index;
+      best_prefix = prefix;
+    }
+  }
+  if (best_index == nullptr) {
+    return optimized_plan;
+  }
+
+  // A missing end of the range on the last bounded column is closed with the least or greatest value of the column,
+  // which both exclude NULL. Columns without those leave that end of the scan open, which may reach NULL keys, so
+  // their predicates are still checked by the filter.
+  const auto &key_attrs = best_index->index_->GetKeyAttrs();
+  const auto &last_bounds = bounds[key_attrs[best_prefix - 1]];
+  auto last_type = table_info->schema_.GetColumn(key_attrs[best_prefix - 1]).GetType();
+  bool closed = (last_bounds.lower_.has_value() && last_bounds.upper_.has_value()) || HasValueRange(last_type);
+  std::vector<Value> lower_bound;
+  std::vector<Value> upper_bound;
+  std::vector<bool> consumed(conjuncts.size(), false);
+  for (size_t i = 0; i < best_prefix; i++) {
+    const auto &column_bounds = bounds[key_attrs[i]];
+    if (i + 1 < best_prefix || closed) {
+      for (auto conjunct_idx : column_bounds.conjuncts_) {
+        consumed[conjunct_idx] = true;
+      }
+    }
+    if (i + 1 < best_prefix) {
+      lower_bound.push_back(*column_bounds.lower_);
+      upper_bound.push_back(*column_bounds.upper_);
+    }
+  }
+  bool lower_inclusive = last_bounds.lower_inclusive_;
+  bool upper_inclusive = last_bounds.upper_inclusive_;
+  if (last_bounds.lower_.has_value()) {
+    lower_bound.push_back(*last_bounds.lower_);
+  } else if (closed) {
+    lower_bound.push_back(Type::GetMinValue(last_type));
+    lower_inclusive = true;
+  } else {
+    lower_bound.clear();
+  }
+  if (last_bounds.upper_.has_value()) {
+    upper_bound.push_back(*last_bounds.upper_);
+  } else if (closed) {
+    upper_bound.push_back(Type::GetMaxValue(last_type));
+    upper_inclusive = true;
+  } else {
+    upper_bound.clear();
+  }
+
+  // The columns after the bounded ones may hold any value, NULL being the least of them. An inclusive bound pads them
+  // to reach all those keys, an exclusive one to skip them all.
+  for (size_t i = best_prefix; i < key_attrs.size(); i++) {
+    auto type = table_info->schema_.GetColumn(key_attrs[i]).GetType();
+    if (!lower_bound.empty()) {
+      lower_bound.push_back(lower_inclusive ? ValueFactory::GetNullValueByType(type) : Type::GetMaxValue(type));
+    }
+    if (!upper_bound.empty()) {
+      upper_bound.push_back(upper_inclusive ? Type::GetMaxValue(type) : ValueFactory::GetNullValueByType(type));
+    }
+  }
+
+  AbstractPlanNodeRef index_scan =
+      std::make_shared<IndexScanPlanNode>(filter_plan.output_schema_, best_index->index_oid_, std::move(lower_bound),
+                                          lower_inclusive, std::move(upper_bound), upper_inclusive);
+
+  // The conjuncts the bounds did not come from are still checked on every tuple of the scan
+  AbstractExpressionRef remaining;
+  for (size_t i = 0; i < conjuncts.size(); i++) {
+    if (consumed[i]) {
+      continue;
+    }
+    remaining = remaining == nullptr ? conjuncts[i]
+                                     : std::make_shared<LogicExpression>(remaining, conjuncts[i], LogicType::And);
+  }
+  if (remaining == nullptr) {
+    return index_scan;
+  }
+  return std::make_shared<FilterPlanNode>(filter_plan.output_schema_, remaining, index_scan);
+}
+
+}  // namespace bustub
@@ -34,8 +34,9 @@ auto Optimizer::OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> Abstra
       if (expr->comp_type_ == ComparisonType::Equal) {
         if (const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[0].get());
             left_expr != nullptr) {
+          // Keys of different types may compare equal but hash differently
           if (const auto *right_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[1].get());
-              right_expr != nullptr) {
+              right_expr != nullptr && right_expr->GetReturnType() == left_expr->GetReturnType()) {
             // Ensure both exprs have tuple_id == 0
             auto left_expr_tuple_0 =
                 std::make_shared<ColumnValueExpression>(0, left_expr->GetColIdx(), left_expr->GetReturnType());
@@ -31,10 +31,31 @@ static char *buffer_used;
  * @input db_file: database file name
  */
 DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+  if (!OpenLog()) {
+    return;
+  }
+
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  // directory or file does not exist
+  if (!db_io_.is_open()) {
+    db_io_.clear();
+    // create a new file
+    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
+    if (!db_io_.is_open()) {
+      throw Exception("can't open db file");
+    }
+  }
+}
+
+/**
+ * Open/create the log file that belongs to file_name_
+ */
+auto DiskManager::OpenLog() -> bool {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
-    return;
+    return false;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
@@ -48,19 +69,8 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
       throw Exception("can't open dblog file");
     }
   }
-
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
-    }
-  }
   buffer_used = nullptr;
+  return true;
 }
 
 /**
@@ -74,6 +84,14 @@ void DiskManager::ShutDown() {
   log_io_.close();
 }
 
+/**
+ * Push the page writes buffered in the stream to the OS
+ */
+void DiskManager::Sync() {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  db_io_.flush();
+}
+
 /**
  * Write the contents of the specified page into disk file
  */
@@ -122,6 +140,26 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   }
 }
 
+/**
+ * Write the page synchronously, the future is ready on return
+ */
+auto DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool> {
+  std::promise<bool> done;
+  WritePage(page_id, page_data);
+  done.set_value(true);
+  return done.get_future();
+}
+
+/**
+ * Read the page synchronously, the future is ready on return
+ */
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool> {
+  std::promise<bool> done;
+  ReadPage(page_id, page_data);
+  done.set_value(true);
+  return done.get_future();
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_posix.cpp
+//
+// Identification: src/storage/disk/disk_manager_posix.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "storage/disk/disk_manager_posix.h"
+
+namespace bustub {
+
+DiskManagerPosix::DiskManagerPosix(const std::string &db_file, bool direct_io) : direct_io_(direct_io) {
+  file_name_ = db_file;
+  if (!OpenLog()) {
+    return;
+  }
+
+  int flags = O_RDWR | O_CREAT;
+#ifdef O_DIRECT
+  if (direct_io_) {
+    fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);
+    if (fd_ < 0 && errno == EINVAL) {
+      // e.g. tmpfs, which has no O_DIRECT
+      LOG_WARN("O_DIRECT not supported for %s, falling back to buffered I/O", db_file.c_str());
+      direct_io_ = false;
+    }
+  }
+#else
+  if (direct_io_) {
+    LOG_WARN("O_DIRECT not supported on this platform, falling back to buffered I/O");
+    direct_io_ = false;
+  }
+#endif
+  if (fd_ < 0) {
+    fd_ = open(db_file.c_str(), flags, 0644);
+  }
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+
+  struct stat stat_buf;
+  if (fstat(fd_, &stat_buf) == 0) {
+    file_size_ = stat_buf.st_size;
+  }
+}
+
+DiskManagerPosix::~DiskManagerPosix() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+void DiskManagerPosix::ShutDown() {
+  if (fd_ >= 0) {
+    Sync();
+    close(fd_);
+    fd_ = -1;
+  }
+  log_io_.close();
+}
+
+void DiskManagerPosix::Sync() {
+#ifdef __APPLE__
+  int rc = fsync(fd_);
+#else
+  int rc = fdatasync(fd_);
+#endif
+  if (rc != 0) {
+    LOG_DEBUG("I/O error while syncing: %s", strerror(errno));
+  }
+}
+
+auto DiskManagerPosix::BounceBuffer() -> char * {
+  thread_local std::unique_ptr<char, decltype(&free)> buffer(
+      static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, BUSTUB_PAGE_SIZE)), &free);
+  return buffer.get();
+}
+
+void DiskManagerPosix::WritePage(page_id_t page_id, const char *page_data) {
+  auto offset = static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE;
+  const char *buf = page_data;
+  if (NeedsBounce(page_data)) {
+    char *bounce = BounceBuffer();
+    memcpy(bounce, page_data, BUSTUB_PAGE_SIZE);
+    buf = bounce;
+  }
+
+  num_writes_ += 1;
+  size_t written = 0;
+  while (written < BUSTUB_PAGE_SIZE) {
+    ssize_t rc = pwrite(fd_, buf + written, BUSTUB_PAGE_SIZE - written, offset + written);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing: %s", strerror(errno));
+      return;
+    }
+    written += rc;
+  }
+
+  GrowFileSize(offset + BUSTUB_PAGE_SIZE);
+}
+
+void DiskManagerPosix::ReadPage(page_id_t page_id, char *page_data) {
+  auto offset = static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE;
+  // check if read beyond file length
+  if (offset >= file_size_) {
+    LOG_DEBUG("I/O error reading past end of file");
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+
+  char *buf = NeedsBounce(page_data) ? BounceBuffer() : page_data;
+  size_t read_count = 0;
+  while (read_count < BUSTUB_PAGE_SIZE) {
+    ssize_t rc = pread(fd_, buf + read_count, BUSTUB_PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading: %s", strerror(errno));
+      return;
+    }
+    if (rc == 0) {
+      // if file ends before reading BUSTUB_PAGE_SIZE
+      LOG_DEBUG("Read less than a page");
+      memset(buf + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+      break;
+    }
+    read_count += rc;
+  }
+  if (buf != page_data) {
+    memcpy(page_data, buf, BUSTUB_PAGE_SIZE);
+  }
+}
+
+}  // namespace bustub
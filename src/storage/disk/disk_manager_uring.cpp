@@ -0,0 +1,337 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.cpp
+//
+// Identification: src/storage/disk/disk_manager_uring.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+// IORING_OP_READ/WRITE are enum values; this feature flag comes with the same kernel release (5.6).
+#ifdef IORING_FEAT_RW_CUR_POS
+#define BUSTUB_HAS_IO_URING
+#endif
+#endif
+
+#include "common/logger.h"
+#include "storage/disk/disk_manager_uring.h"
+
+namespace bustub {
+
+/** A page read or write handed to the ring thread. */
+struct DiskManagerUring::IoRequest {
+  IoRequest(bool write, page_id_t page_id, char *buf) : write_(write), page_id_(page_id), buf_(buf) {}
+
+  bool write_;
+  page_id_t page_id_;
+  /** The buffer the kernel reads from or writes to. */
+  char *buf_;
+  /** The caller's buffer, if buf_ is an aligned copy of it for O_DIRECT. */
+  char *user_buf_{nullptr};
+  std::unique_ptr<char, decltype(&free)> bounce_{nullptr, &free};
+  /** Bytes transferred so far. */
+  size_t done_{0};
+  std::promise<bool> promise_;
+};
+
+DiskManagerUring::DiskManagerUring(const std::string &db_file, bool direct_io, size_t queue_depth)
+    : DiskManagerPosix(db_file, direct_io) {
+  if (fd_ < 0) {
+    return;
+  }
+  if (!SetUpRing(queue_depth)) {
+    LOG_WARN("io_uring is not available, asynchronous page I/O falls back to synchronous I/O");
+    return;
+  }
+  ring_thread_ = std::thread(&DiskManagerUring::RunRing, this);
+}
+
+DiskManagerUring::~DiskManagerUring() { TearDownRing(); }
+
+void DiskManagerUring::ShutDown() {
+  TearDownRing();
+  DiskManagerPosix::ShutDown();
+}
+
+auto DiskManagerUring::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool> {
+  if (!IsUringEnabled()) {
+    return DiskManagerPosix::WritePageAsync(page_id, page_data);
+  }
+  auto *request = new IoRequest(true, page_id, const_cast<char *>(page_data));
+  if (NeedsBounce(page_data)) {
+    request->bounce_.reset(static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, BUSTUB_PAGE_SIZE)));
+    memcpy(request->bounce_.get(), page_data, BUSTUB_PAGE_SIZE);
+    request->buf_ = request->bounce_.get();
+  }
+  num_writes_ += 1;
+  return Enqueue(request);
+}
+
+auto DiskManagerUring::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool> {
+  if (!IsUringEnabled() || static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE >= file_size_) {
+    // Reads past the end of the file need no I/O.
+    return DiskManagerPosix::ReadPageAsync(page_id, page_data);
+  }
+  auto *request = new IoRequest(false, page_id, page_data);
+  if (NeedsBounce(page_data)) {
+    request->bounce_.reset(static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, BUSTUB_PAGE_SIZE)));
+    request->buf_ = request->bounce_.get();
+    request->user_buf_ = page_data;
+  }
+  return Enqueue(request);
+}
+
+auto DiskManagerUring::Enqueue(IoRequest *request) -> std::future<bool> {
+  auto future = request->promise_.get_future();
+  {
+    std::scoped_lock lock(queue_latch_);
+    if (stop_ring_) {
+      LOG_DEBUG("I/O error: page request after shutdown");
+      request->promise_.set_value(false);
+      delete request;
+      return future;
+    }
+    queue_.push_back(request);
+  }
+  uint64_t one = 1;
+  if (write(event_fd_, &one, sizeof(one)) < 0) {
+    LOG_DEBUG("cannot wake up the ring thread: %s", strerror(errno));
+  }
+  return future;
+}
+
+#ifdef BUSTUB_HAS_IO_URING
+
+/** user_data of the poll request on event_fd_, which no IoRequest can have. */
+static constexpr uint64_t WAKE_UP_USER_DATA = 0;
+
+auto DiskManagerUring::SetUpRing(size_t queue_depth) -> bool {
+  // One entry more for the poll on event_fd_.
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth + 1, &params));
+  if (ring_fd < 0) {
+    return false;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes == MAP_FAILED || event_fd_ < 0) {
+    if (sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (cq_ring_ != MAP_FAILED) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sqes != MAP_FAILED) {
+      munmap(sqes, sqes_size_);
+    }
+    if (event_fd_ >= 0) {
+      close(event_fd_);
+    }
+    close(ring_fd);
+    sq_ring_ = cq_ring_ = nullptr;
+    event_fd_ = -1;
+    return false;
+  }
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_entries_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_entries);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+  // Submission queue entry i always sits in slot i of the array.
+  for (unsigned i = 0; i < *sq_entries_; i++) {
+    sq_array_[i] = i;
+  }
+  sq_next_tail_ = *sq_tail_;
+  queue_depth_ = queue_depth;
+  ring_fd_ = ring_fd;
+  return true;
+}
+
+void DiskManagerUring::TearDownRing() {
+  if (!IsUringEnabled()) {
+    return;
+  }
+  {
+    std::scoped_lock lock(queue_latch_);
+    stop_ring_ = true;
+  }
+  uint64_t one = 1;
+  if (write(event_fd_, &one, sizeof(one)) < 0) {
+    LOG_DEBUG("cannot wake up the ring thread: %s", strerror(errno));
+  }
+  ring_thread_.join();
+
+  munmap(sqes_, sqes_size_);
+  munmap(cq_ring_, cq_ring_size_);
+  munmap(sq_ring_, sq_ring_size_);
+  close(event_fd_);
+  close(ring_fd_);
+  event_fd_ = -1;
+  ring_fd_ = -1;
+}
+
+auto DiskManagerUring::GetSqe() -> io_uring_sqe * {
+  // Only the ring thread moves the tail; the kernel moves the head as it consumes entries. The new tail is published
+  // right before submitting, once the entries are filled in.
+  if (sq_next_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == *sq_entries_) {
+    return nullptr;
+  }
+  io_uring_sqe *sqe = &sqes_[sq_next_tail_ & *sq_mask_];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_next_tail_++;
+  return sqe;
+}
+
+void DiskManagerUring::PrepareSqe(io_uring_sqe *sqe, IoRequest *request) {
+  sqe->opcode = request->write_ ? IORING_OP_WRITE : IORING_OP_READ;
+  sqe->fd = fd_;
+  sqe->off = static_cast<uint64_t>(request->page_id_) * BUSTUB_PAGE_SIZE + request->done_;
+  sqe->addr = reinterpret_cast<uint64_t>(request->buf_ + request->done_);
+  sqe->len = BUSTUB_PAGE_SIZE - request->done_;
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+}
+
+auto DiskManagerUring::CompleteRequest(IoRequest *request, int result) -> bool {
+  if (result == -EINTR || result == -EAGAIN) {
+    return false;
+  }
+  bool ok = true;
+  if (result < 0) {
+    LOG_DEBUG("I/O error while %s page %d: %s", request->write_ ? "writing" : "reading", request->page_id_,
+              strerror(-result));
+    ok = false;
+  } else if (result == 0 && request->write_) {
+    LOG_DEBUG("I/O error while writing page %d: no progress", request->page_id_);
+    ok = false;
+  } else if (result == 0) {
+    // if file ends before reading BUSTUB_PAGE_SIZE
+    memset(request->buf_ + request->done_, 0, BUSTUB_PAGE_SIZE - request->done_);
+    request->done_ = BUSTUB_PAGE_SIZE;
+  } else {
+    request->done_ += result;
+    if (request->done_ < BUSTUB_PAGE_SIZE) {
+      return false;
+    }
+  }
+
+  if (ok && request->write_) {
+    GrowFileSize(static_cast<int64_t>(request->page_id_ + 1) * BUSTUB_PAGE_SIZE);
+  }
+  if (ok && request->user_buf_ != nullptr) {
+    memcpy(request->user_buf_, request->buf_, BUSTUB_PAGE_SIZE);
+  }
+  request->promise_.set_value(ok);
+  delete request;
+  return true;
+}
+
+void DiskManagerUring::RunRing() {
+  std::deque<IoRequest *> pending;
+  size_t in_flight = 0;
+  bool wake_up_armed = false;
+
+  while (true) {
+    {
+      std::scoped_lock lock(queue_latch_);
+      pending.insert(pending.end(), queue_.begin(), queue_.end());
+      queue_.clear();
+      if (stop_ring_ && pending.empty() && in_flight == 0) {
+        return;
+      }
+    }
+
+    // Keep a poll on event_fd_ in the ring, so that new requests wake us up while we wait for completions.
+    io_uring_sqe *sqe;
+    if (!wake_up_armed && (sqe = GetSqe()) != nullptr) {
+      sqe->opcode = IORING_OP_POLL_ADD;
+      sqe->fd = event_fd_;
+      sqe->poll32_events = POLLIN;
+      sqe->user_data = WAKE_UP_USER_DATA;
+      wake_up_armed = true;
+    }
+    while (!pending.empty() && in_flight < queue_depth_ && (sqe = GetSqe()) != nullptr) {
+      PrepareSqe(sqe, pending.front());
+      pending.pop_front();
+      in_flight++;
+    }
+
+    // Submit everything queued so far, and wait for at least one completion.
+    __atomic_store_n(sq_tail_, sq_next_tail_, __ATOMIC_RELEASE);
+    unsigned to_submit = sq_next_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    int rc = static_cast<int>(
+        syscall(__NR_io_uring_enter, ring_fd_, to_submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+    if (rc < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      LOG_ERROR("io_uring_enter failed: %s", strerror(errno));
+    }
+
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+      io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+      if (cqe->user_data == WAKE_UP_USER_DATA) {
+        uint64_t count;
+        if (read(event_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+          LOG_DEBUG("cannot reset the wake up event: %s", strerror(errno));
+        }
+        wake_up_armed = false;
+        continue;
+      }
+      auto *request = reinterpret_cast<IoRequest *>(cqe->user_data);
+      in_flight--;
+      if (!CompleteRequest(request, cqe->res)) {
+        pending.push_front(request);
+      }
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+}
+
+#else
+
+auto DiskManagerUring::SetUpRing(size_t queue_depth) -> bool { return false; }
+
+void DiskManagerUring::TearDownRing() {}
+
+auto DiskManagerUring::GetSqe() -> io_uring_sqe * { return nullptr; }
+
+void DiskManagerUring::PrepareSqe(io_uring_sqe *sqe, IoRequest *request) {}
+
+auto DiskManagerUring::CompleteRequest(IoRequest *request, int result) -> bool { return true; }
+
+void DiskManagerUring::RunRing() {}
+
+#endif
+
+}  // namespace bustub
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 
 #include "common/exception.h"
@@ -9,13 +10,15 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool compressed)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
-      leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      leaf_max_size_(compressed ? std::min<int>(leaf_max_size, COMPRESSED_LEAF_PAGE_SIZE) : leaf_max_size),
+      internal_max_size_(compressed ? std::min<int>(internal_max_size, COMPRESSED_INTERNAL_PAGE_SIZE)
+                                    : internal_max_size),
+      compressed_(compressed) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -32,9 +35,26 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_P
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  root_latch_.RLock();
-  // LOG_DEBUG("root latch rlocked");
-  auto page = FindLeafPage(key,false,false,0,transaction);
+  // Read without writing to any latch, as long as the path is in memory and no writer gets in the way.
+  for(int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES; attempt++){
+    uint64_t version;
+    auto *page = FindLeafPageOptimistic(key,false,&version);
+    if(page == nullptr){
+      break;
+    }
+    ValueType value;
+    auto in = reinterpret_cast<LeafPage *>(page->GetData())->LookupOptimistic(key,&value,comparator_);
+    if(page->ValidateVersion(version)){
+      if(in){
+        result->push_back(value);
+      }
+      return in;
+    }
+  }
+  auto page = FindLeafPageLatched(key,false);
+  if(page == nullptr){
+    return false;
+  }
   auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
   ValueType value;
   auto in = leaf->Lookup(key,&value,comparator_);
@@ -49,6 +69,54 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   }
   return false;
 }
+/*
+ * Look up many keys at once, e.g. for the outer tuples of an index join.
+ * The keys are probed in key order, and a key that falls into the leaf of the
+ * key before it is looked up there without descending from the root again,
+ * so clustered keys share their page fetches.
+ * results[i] gets the values of keys[i].
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *transaction) {
+  results->assign(keys.size(), {});
+  std::vector<size_t> order(keys.size());
+  for(size_t i = 0; i < keys.size(); i++){
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(),
+            [this, &keys](size_t a, size_t b) { return comparator_(keys[a], keys[b]) < 0; });
+
+  Page *page = nullptr;
+  LeafPage *leaf = nullptr;
+  for(auto i : order){
+    const auto &key = keys[i];
+    // The keys before this one all went to this leaf or further left, so the leaf covers the key unless it is larger
+    // than every key in the leaf and there are leaves right of it.
+    if(page != nullptr && leaf->GetNextPageId() != INVALID_PAGE_ID &&
+       (leaf->GetSize() == 0 || comparator_(key, leaf->KeyAt(leaf->GetSize() - 1)) > 0)){
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPgImp(page->GetPageId(), false);
+      page = nullptr;
+    }
+    if(page == nullptr){
+      page = FindLeafPageLatched(key,false);
+      if(page == nullptr){
+        return;
+      }
+      leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    }
+    int index = leaf->KeyIndex(key,comparator_);
+    if(index < leaf->GetSize() && comparator_(leaf->KeyAt(index),key) == 0){
+      (*results)[i].push_back(leaf->GetItem(index).second);
+    }
+  }
+  if(page != nullptr){
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPgImp(page->GetPageId(), false);
+  }
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -63,6 +131,10 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
   // LOG_DEBUG("Insert in B Plus Tree");
   // LOG_DEBUG("Before insertion, the shape of the tree is");
+  bool inserted;
+  if(InsertOptimistic(key,value,&inserted)){
+    return inserted;
+  }
   // Because we got root latch, so add to page set a nullptr to represent root
   root_latch_.WLock();
   // LOG_DEBUG("root latch wlocked");
@@ -99,15 +171,51 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   if(page == nullptr){
     throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
   }
-  root_page_id_ = page_id;
   // LOG_DEBUG("Init leaf node and insert k&v");
   auto *node = reinterpret_cast<LeafPage *>(page->GetData());
-  node->Init(page_id,INVALID_PAGE_ID,leaf_max_size_);
+  node->Init(page_id,INVALID_PAGE_ID,leaf_max_size_,compressed_);
   node->Insert(key,value,comparator_);
+  // Publish the root only once it is complete, optimistic readers follow root_page_id_ without any latch.
+  root_page_id_ = page_id;
   buffer_pool_manager_->UnpinPgImp(page_id,true);
   // LOG_DEBUG("quit StartNewTree function");
 }
 
+/*
+ * Insert with read latches on the internal pages and a write latch on the leaf
+ * only, so that concurrent writers do not queue up on the root. Most inserts
+ * fit into their leaf, only a split needs the pessimistic protocol.
+ * @return: false if the tree is empty or the leaf would split, nothing is
+ * changed then and the caller has to insert pessimistically.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertOptimistic(const KeyType &key, const ValueType &value, bool *inserted) {
+  root_latch_.RLock();
+  if(IsEmpty()){
+    root_latch_.RUnlock();
+    return false;
+  }
+  auto *page = FindLeafPage(key,false,false,3,nullptr);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType temp;
+  if(leaf->Lookup(key,&temp,comparator_)){
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPgImp(page->GetPageId(),false);
+    *inserted = false;
+    return true;
+  }
+  if(!leaf->HasRoomFor(key,value)){
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPgImp(page->GetPageId(),false);
+    return false;
+  }
+  leaf->Insert(key,value,comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPgImp(page->GetPageId(),true);
+  *inserted = true;
+  return true;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
   // LOG_DEBUG("Insert into leaf function");
@@ -122,6 +230,23 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
     buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
     return false;
   }
+  if(leaf->IsCompressed() && !leaf->HasRoomFor(key,value)){
+    // The key may take more room in the leaf than the keys in it, so split first. Either half has room for any key
+    // then, as a compressed page holds at most twice what fits without compression.
+    auto new_leaf = Split(leaf);
+    new_leaf->SetNextPageId(leaf->GetNextPageId());
+    leaf->SetNextPageId(new_leaf->GetPageId());
+    if(comparator_(key,new_leaf->KeyAt(0)) < 0){
+      leaf->Insert(key,value,comparator_);
+    } else {
+      new_leaf->Insert(key,value,comparator_);
+    }
+    InsertIntoParent(leaf,new_leaf->KeyAt(0),new_leaf,transaction);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPgImp(leaf->GetPageId(),true);
+    buffer_pool_manager_->UnpinPgImp(new_leaf->GetPageId(),true);
+    return true;
+  }
   // auto size = leaf->GetSize();
   // LOG_DEBUG("Before insertion, the leaf is");
   // ToString(reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPgImp(leaf->GetPageId())),buffer_pool_manager_);
@@ -169,7 +294,7 @@ N *BPLUSTREE_TYPE::Split(N *node) {
     auto *lpage = reinterpret_cast<LeafPage *>(node);
     // LOG_DEBUG("New leaf page init");
     auto *new_lpage = reinterpret_cast<LeafPage *>(new_node);
-    new_lpage->Init(new_page->GetPageId(),node->GetParentPageId(), leaf_max_size_);
+    new_lpage->Init(new_page->GetPageId(),node->GetParentPageId(), leaf_max_size_, compressed_);
     // LOG_DEBUG("Get ready to enter move half");
     lpage->MoveHalfTo(new_lpage);
   } else {
@@ -177,7 +302,7 @@ N *BPLUSTREE_TYPE::Split(N *node) {
     auto *ipage = reinterpret_cast<InternalPage *>(node);
     // LOG_DEBUG("New internal page init");
     auto *new_ipage = reinterpret_cast<InternalPage *>(new_node);
-    new_ipage->Init(new_page->GetPageId(),node->GetParentPageId(),internal_max_size_);
+    new_ipage->Init(new_page->GetPageId(),node->GetParentPageId(),internal_max_size_,compressed_);
     ipage->MoveHalfTo(new_ipage,buffer_pool_manager_);
   }
   // for(int i = 0;i < node->GetSize();i++){
@@ -197,18 +322,19 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
   // LOG_DEBUG("InsertIntoParent function");
   if(old_node->IsRootPage()){
     // LOG_DEBUG("old node is root page");
-    // page_id_t page_id;
-    auto page = buffer_pool_manager_->NewPgImp(&root_page_id_);
+    page_id_t page_id;
+    auto page = buffer_pool_manager_->NewPgImp(&page_id);
     if(page == nullptr){
       throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
     }
     auto *new_root = reinterpret_cast<InternalPage *>(page->GetData());
-    // root_page_id_ = page_id;
     // std::cout << page_id << std::endl;
-    new_root->Init(root_page_id_,INVALID_PAGE_ID,internal_max_size_);
+    new_root->Init(page_id,INVALID_PAGE_ID,internal_max_size_,compressed_);
     new_root->PopulateNewRoot(old_node->GetPageId(),key,new_node->GetPageId());
     old_node->SetParentPageId(new_root->GetPageId());
     new_node->SetParentPageId(new_root->GetPageId());
+    // Like in StartNewTree, the new root is complete before readers can find it.
+    root_page_id_ = page_id;
     // TopDownRelease(transaction);
     buffer_pool_manager_->UnpinPgImp(page->GetPageId(),true);
     UpdateRootPageId(0);
@@ -220,14 +346,14 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
     page_id_t parent_pid = old_node->GetParentPageId();
     auto *parent_pg = buffer_pool_manager_->FetchPgImp(parent_pid);
     auto *parent_node = reinterpret_cast<InternalPage *>(parent_pg->GetData());
-    if(parent_node->GetSize() < internal_max_size_){
+    if(parent_node->HasRoomFor(key,new_node->GetPageId())){
       // LOG_DEBUG("The internal parent page is not full need not split so we can release latch");
       parent_node->InsertNodeAfter(old_node->GetPageId(),key,new_node->GetPageId());
       TopDownRelease(transaction);
       buffer_pool_manager_->UnpinPgImp(parent_pid,true);
       // // ToString(parent_node,buffer_pool_manager_);
       return;
-    } else if(parent_node->GetSize() == internal_max_size_){
+    } else {
       // LOG_DEBUG("The internal parent page is full");
       // Here needs a special split that split from the place where old node exists
       auto new_inode = Split(parent_node);
@@ -256,6 +382,110 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
 }
 
 
+/*
+ * Build the tree bottom-up from sorted pairs, for creating an index on a
+ * table that already has rows. The shape of every level follows from the
+ * number of pairs, so the leaves are filled left to right and every inner
+ * node is opened when its first child is, which writes every page once and
+ * keeps only one page per level pinned. Compressed leaves take as many pairs
+ * as fit into fill_factor of their bytes, and compressed internal pages only
+ * as many children as fit without compression.
+ * @return: false if the tree is not empty, nothing is changed then.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(const std::vector<MappingType> &items, double fill_factor) -> bool {
+  root_latch_.WLock();
+  if(!IsEmpty()){
+    root_latch_.WUnlock();
+    return false;
+  }
+  if(items.empty()){
+    root_latch_.WUnlock();
+    return true;
+  }
+  // A leaf splits once it reaches its max size, an internal page once it has more children than that
+  std::vector<BulkLevel> levels;
+  size_t entries = items.size();
+  int capacity = leaf_max_size_ - 1;
+  int min_size = std::max(leaf_max_size_ / 2, 1);
+  std::vector<int> leaf_sizes;
+  if(compressed_){
+    int per_node = std::clamp(static_cast<int>(capacity * fill_factor), std::min(min_size, capacity), capacity);
+    auto budget = static_cast<size_t>(LEAF_PAGE_AREA_SIZE * fill_factor);
+    for(size_t i = 0; i < items.size(); i += leaf_sizes.back()){
+      auto count = static_cast<int>(std::min<size_t>(per_node, items.size() - i));
+      leaf_sizes.push_back(CompressedEntries<MappingType>::FitCount(&items[i], count, budget));
+    }
+  }
+  while(true){
+    int per_node = std::clamp(static_cast<int>(capacity * fill_factor), std::min(min_size, capacity), capacity);
+    size_t nodes = levels.empty() && compressed_ ? leaf_sizes.size() : (entries + per_node - 1) / per_node;
+    levels.push_back({entries, nodes});
+    if(nodes == 1){
+      break;
+    }
+    entries = nodes;
+    capacity = internal_max_size_;
+    if(compressed_){
+      capacity = std::min(capacity, CompressedEntries<std::pair<KeyType, page_id_t>>::UncompressedCapacity(
+                                        INTERNAL_PAGE_AREA_SIZE));
+    }
+    min_size = std::max((internal_max_size_ + 1) / 2, 2);
+  }
+
+  for(size_t i = 0, count = 0; i < items.size(); i += count){
+    BulkOpenNode(&levels, 0, items[i].first);
+    count = compressed_ ? leaf_sizes[levels[0].opened_ - 1] : levels[0].target_;
+    auto *leaf = reinterpret_cast<LeafPage *>(levels[0].page_->GetData());
+    leaf->AppendSorted(&items[i], count);
+  }
+  for(auto &level : levels){
+    buffer_pool_manager_->UnpinPgImp(level.page_->GetPageId(), true);
+  }
+  // Like in StartNewTree, readers only find the tree once it is complete.
+  root_page_id_ = levels.back().page_->GetPageId();
+  root_latch_.WUnlock();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkOpenNode(std::vector<BulkLevel> *levels, size_t level, const KeyType &first_key) {
+  auto &current = (*levels)[level];
+  page_id_t page_id;
+  auto *page = buffer_pool_manager_->NewPgImp(&page_id);
+  if(page == nullptr){
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+  }
+  if(current.page_ != nullptr){
+    if(level == 0){
+      reinterpret_cast<LeafPage *>(current.page_->GetData())->SetNextPageId(page_id);
+    }
+    buffer_pool_manager_->UnpinPgImp(current.page_->GetPageId(), true);
+  }
+  page_id_t parent_id = INVALID_PAGE_ID;
+  if(level + 1 < levels->size()){
+    auto &parent = (*levels)[level + 1];
+    if(parent.page_ == nullptr || parent.filled_ == parent.target_){
+      BulkOpenNode(levels, level + 1, first_key);
+    }
+    auto *parent_node = reinterpret_cast<InternalPage *>(parent.page_->GetData());
+    parent_node->Append(first_key, page_id);
+    parent.filled_++;
+    parent_id = parent.page_->GetPageId();
+  }
+  if(level == 0){
+    reinterpret_cast<LeafPage *>(page->GetData())->Init(page_id, parent_id, leaf_max_size_, compressed_);
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())->Init(page_id, parent_id, internal_max_size_, compressed_);
+  }
+  // The entries of a level are spread evenly, so that the last node is not left almost empty
+  current.target_ = static_cast<int>(current.entries_ / current.nodes_ +
+                                     (current.opened_ < current.entries_ % current.nodes_ ? 1 : 0));
+  current.filled_ = 0;
+  current.opened_++;
+  current.page_ = page;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -271,6 +501,9 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   // LOG_DEBUG("Remove function");
   // LOG_DEBUG("Before deletion, the shape of the tree is");
   // ToString(reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPgImp(root_page_id_)),buffer_pool_manager_);
+  if(RemoveOptimistic(key)){
+    return;
+  }
   root_latch_.WLock();
   // LOG_DEBUG("root latch wlocked");
   transaction->AddIntoPageSet(nullptr);
@@ -311,6 +544,39 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   // ToString(reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPgImp(root_page_id_)),buffer_pool_manager_);
 }
 
+/*
+ * Remove with read latches on the internal pages and a write latch on the leaf
+ * only, like InsertOptimistic.
+ * @return: false if the leaf would underflow, nothing is changed then and the
+ * caller has to remove pessimistically.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveOptimistic(const KeyType &key) {
+  root_latch_.RLock();
+  if(IsEmpty()){
+    root_latch_.RUnlock();
+    return true;
+  }
+  auto *page = FindLeafPage(key,false,false,3,nullptr);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType temp;
+  if(!leaf->Lookup(key,&temp,comparator_)){
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPgImp(page->GetPageId(),false);
+    return true;
+  }
+  // A root leaf only changes the tree when it becomes empty.
+  if(leaf->IsRootPage() ? leaf->GetSize() <= 1 : leaf->GetSize() <= leaf->GetMinSize()){
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPgImp(page->GetPageId(),false);
+    return false;
+  }
+  leaf->RemoveAndDeleteRecord(key,comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPgImp(page->GetPageId(),true);
+  return true;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
@@ -330,13 +596,15 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
   auto index = parent_node->ValueIndex(node->GetPageId());
   if(index == 0){
     if(index == parent_node->GetSize() - 1){
+      TopDownRelease(transaction);
+      buffer_pool_manager_->UnpinPgImp(parent_node->GetPageId(),false);
       return false;
     }
     // LOG_DEBUG("The node is first child with no prev sibling");
     auto *sibling_page = buffer_pool_manager_->FetchPgImp(parent_node->ValueAt(index + 1));
     sibling_page->WLatch();
-    auto *sibling = reinterpret_cast<N *>(sibling_page);
-    if(node->GetSize() + sibling->GetSize() <= node->GetMaxSize()){
+    auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+    if(CanCoalesce(sibling,node,parent_node,index)){
       // LOG_DEBUG("Can coalesce");
       auto rm_index = parent_node->ValueIndex(node->GetPageId());
       bool parent_delete = Coalesce(sibling,node,parent_node,rm_index,transaction);
@@ -351,7 +619,10 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
     } else {
       // LOG_DEBUG("Can't coalesce and ready to redistribute");
       auto rm_index = parent_node->ValueIndex(node->GetPageId());
-      Redistribute(sibling,node,parent_node,rm_index);
+      // Otherwise the node stays below its min size until the next remove from it.
+      if(CanRedistribute(sibling,parent_node,rm_index)){
+        Redistribute(sibling,node,parent_node,rm_index);
+      }
       TopDownRelease(transaction);
       buffer_pool_manager_->UnpinPgImp(parent_node->GetPageId(),true);
       sibling_page->WUnlatch();
@@ -363,7 +634,7 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
     auto *sibling_page = buffer_pool_manager_->FetchPgImp(parent_node->ValueAt(index - 1));
     sibling_page->WLatch();
     auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
-    if(node->GetSize() + sibling->GetSize() <= node->GetMaxSize()){
+    if(CanCoalesce(sibling,node,parent_node,index)){
       // LOG_DEBUG("Can coalesce");
       auto rm_index = parent_node->ValueIndex(node->GetPageId());
       bool parent_delete = Coalesce(sibling,node,parent_node,rm_index,transaction);
@@ -377,7 +648,10 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
     } else {
       // LOG_DEBUG("Can't coalesce and ready to redistribute");
       auto rm_index = parent_node->ValueIndex(node->GetPageId());
-      Redistribute(sibling,node,parent_node,rm_index);
+      // Otherwise the node stays below its min size until the next remove from it.
+      if(CanRedistribute(sibling,parent_node,rm_index)){
+        Redistribute(sibling,node,parent_node,rm_index);
+      }
       TopDownRelease(transaction);
       buffer_pool_manager_->UnpinPgImp(parent_node->GetPageId(),true);
       sibling_page->WUnlatch();
@@ -400,12 +674,14 @@ bool BPLUSTREE_TYPE::Coalesce(N *neighbor_node, N *node,
     // LOG_DEBUG("Leaf page");
     auto *leaf = reinterpret_cast<LeafPage *>(node);
     auto *sibling = reinterpret_cast<LeafPage *>(neighbor_node);
-    auto next_pid = sibling->GetNextPageId();
-    leaf->MoveAllTo(sibling);
+    // Like the internal pages, the right one of the two moves into the left one, which keeps the keys in order
     if(index == 0){
-      sibling->SetNextPageId(next_pid);
+      sibling->MoveAllTo(leaf);
+      parent->Remove(index + 1);
+    } else {
+      leaf->MoveAllTo(sibling);
+      parent->Remove(index);
     }
-    parent->Remove(index);
   } else {
     // LOG_DEBUG("internal page");
     auto *internal = reinterpret_cast<InternalPage *>(node);
@@ -425,6 +701,37 @@ bool BPLUSTREE_TYPE::Coalesce(N *neighbor_node, N *node,
   return CoalesceOrRedistribute(parent, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+bool BPLUSTREE_TYPE::CanCoalesce(N *neighbor_node, N *node, InternalPage *parent, int index) {
+  if(node->GetSize() + neighbor_node->GetSize() > node->GetMaxSize()){
+    return false;
+  }
+  // The right one of the two moves into the left one, and for internal pages the key between them comes down from the
+  // parent
+  if(node->IsLeafPage()){
+    auto *left = reinterpret_cast<LeafPage *>(index == 0 ? node : neighbor_node);
+    auto *right = reinterpret_cast<LeafPage *>(index == 0 ? neighbor_node : node);
+    return left->CanMergeWith(right);
+  }
+  auto *left = reinterpret_cast<InternalPage *>(index == 0 ? node : neighbor_node);
+  auto *right = reinterpret_cast<InternalPage *>(index == 0 ? neighbor_node : node);
+  return left->CanMergeWith(right,parent->KeyAt(index == 0 ? 1 : index));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+bool BPLUSTREE_TYPE::CanRedistribute(N *neighbor_node, InternalPage *parent, int index) {
+  if(neighbor_node->GetSize() < 2){
+    return false;
+  }
+  // See Redistribute for the key that becomes the parent's separator
+  if(index == 0){
+    return parent->CanSetKeyAt(index + 1,neighbor_node->KeyAt(1));
+  }
+  return parent->CanSetKeyAt(index,neighbor_node->KeyAt(neighbor_node->GetSize() - 1));
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, 
@@ -468,8 +775,8 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
     auto *root = reinterpret_cast<InternalPage *>(old_root_node);
     auto *page = buffer_pool_manager_->FetchPgImp(root->ValueAt(0));
     auto *newroot = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    newroot->SetParentPageId(INVALID_PAGE_ID);
     root_page_id_=  page->GetPageId();
-    newroot->SetPageId(INVALID_PAGE_ID);
     buffer_pool_manager_->UnpinPgImp(root_page_id_,true);
     UpdateRootPageId(0);
     return true;
@@ -483,25 +790,31 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
 
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost,bool rightMost,int op, Transaction *transaction) {
-  // For op, 0 represents search; 1 represents insert; 2 represents delete
+  // For op, 0 represents search; 1 represents insert; 2 represents delete; 3 represents optimistic insert or delete
   // LOG_DEBUG("FindLeafPage function");
-  assert(op == 0 ? !(leftMost && rightMost) : transaction != nullptr);
+  assert(op == 0 ? !(leftMost && rightMost) : op == 3 || transaction != nullptr);
   assert(root_page_id_ != INVALID_PAGE_ID);
   auto root = buffer_pool_manager_->FetchPgImp(root_page_id_);
   auto *node = reinterpret_cast<BPlusTreePage *>(root->GetData());
   if(op == 0){
+    // Latch the root before letting go of root_latch_, so that it is still the root.
+    root->RLatch();
     root_latch_.RUnlock();
     // LOG_DEBUG("root latch runlocked");
-    root->RLatch();
+  } else if(op == 3){
+    // A page never changes its type while it is in the tree, so the type can be read before latching.
+    if(node->IsLeafPage()){
+      root->WLatch();
+    } else {
+      root->RLatch();
+    }
+    root_latch_.RUnlock();
   } else {
     root->WLatch();
     if(op == 2 && node->GetSize() > 2){
       TopDownRelease(transaction);
     }
-    if(op == 1 && node->IsLeafPage() && node->GetSize() < node->GetMaxSize() - 1){
-      TopDownRelease(transaction);
-    }
-    if(op == 1 && !node->IsLeafPage() && node->GetSize() < node->GetMaxSize()){
+    if(op == 1 && IsInsertSafe(node)){
       TopDownRelease(transaction);
     }
   }
@@ -528,11 +841,7 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost,bool rightM
       new_page->WLatch();
       transaction->AddIntoPageSet(root);
 
-      if(new_node->IsLeafPage() && new_node->GetSize() < new_node->GetMaxSize() - 1){
-        // LOG_DEBUG("Safe and release top down");
-        TopDownRelease(transaction);
-      }
-      if(!new_node->IsLeafPage() && new_node->GetSize() < new_node->GetMaxSize()){
+      if(IsInsertSafe(new_node)){
         // LOG_DEBUG("Safe and release top down");
         TopDownRelease(transaction);
       }
@@ -544,6 +853,14 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost,bool rightM
         // LOG_DEBUG("Safe and release top down");
         TopDownRelease(transaction);
       }
+    } else if(op == 3){
+      if(new_node->IsLeafPage()){
+        new_page->WLatch();
+      } else {
+        new_page->RLatch();
+      }
+      root->RUnlatch();
+      buffer_pool_manager_->UnpinPgImp(root->GetPageId(), false);
     }
     // buffer_pool_manager_->UnpinPgImp(node->GetPageId(),false);
     // node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPgImp(page_id));
@@ -556,6 +873,63 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost,bool rightM
   return root;
 }
 
+/*
+ * Optimistic lock coupling: descend without latching or pinning anything. A
+ * page is only trusted once its version still matches after reading it, and
+ * the version of a child is taken before validating its parent, so that the
+ * child really was the parent's child at that point.
+ * @return: the leaf and its version, which the caller validates after reading
+ * the leaf; nullptr if the tree is empty, a page on the way is not in memory or
+ * a writer got in the way.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key, bool leftMost, uint64_t *version) {
+  page_id_t root_id = root_page_id_;
+  if(root_id == INVALID_PAGE_ID){
+    return nullptr;
+  }
+  auto *page = buffer_pool_manager_->FetchPageOptimistic(root_id,version);
+  // A root that split before its version was taken is not the root anymore.
+  if(page == nullptr || root_page_id_ != root_id){
+    return nullptr;
+  }
+  while(true){
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if(node->IsLeafPage()){
+      return page;
+    }
+    auto child_id = reinterpret_cast<InternalPage *>(node)->LookupChildOptimistic(key,leftMost,comparator_);
+    if(child_id == INVALID_PAGE_ID){
+      return nullptr;
+    }
+    uint64_t child_version;
+    auto *child = buffer_pool_manager_->FetchPageOptimistic(child_id,&child_version);
+    if(child == nullptr || !page->ValidateVersion(*version)){
+      return nullptr;
+    }
+    page = child;
+    *version = child_version;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageLatched(const KeyType &key, bool leftMost) {
+  root_latch_.RLock();
+  if(IsEmpty()){
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  return FindLeafPage(key,leftMost,false,0,nullptr);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsInsertSafe(BPlusTreePage *node) {
+  if(node->IsLeafPage()){
+    return reinterpret_cast<LeafPage *>(node)->HasRoomForAny();
+  }
+  return reinterpret_cast<InternalPage *>(node)->HasRoomForAny();
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::TopDownRelease(Transaction * transaction) {
   // LOG_DEBUG("Top down release the latches that this transaction holds");
@@ -587,19 +961,10 @@ void BPLUSTREE_TYPE::TopDownRelease(Transaction * transaction) {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { 
-  // LOG_DEBUG("Iteration begin with no key");
-  if (root_page_id_ == INVALID_PAGE_ID) {
-    // LOG_DEBUG("Empty tree got no iterators");
-    return INDEXITERATOR_TYPE(nullptr, nullptr);
-  }
-  root_latch_.RLock();
-  // LOG_DEBUG("root latch rlocked");
-  auto *leaf_page = FindLeafPage(KeyType(),true,false,0,nullptr);
-  // LOG_DEBUG("Is the leaf the left most?");
-  // std::cout << "The page id of the leaf is " << leaf_page->GetPageId() << std::endl;
-  // ToString(reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPgImp(root_page_id_)),buffer_pool_manager_);
-  return INDEXITERATOR_TYPE(buffer_pool_manager_, leaf_page, 0);
+auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
+  INDEXITERATOR_TYPE iterator(this, buffer_pool_manager_);
+  iterator.Seek(KeyType(), true);
+  return iterator;
 }
 
 /*
@@ -608,21 +973,10 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { 
-  // LOG_DEBUG("Iteration begin with a key");
-  // std::cout << "The key is " << key << std::endl;
-  if (root_page_id_ == INVALID_PAGE_ID) {
-    // LOG_DEBUG("Empty tree got no iterators");
-    return INDEXITERATOR_TYPE(nullptr, nullptr);
-  }
-  root_latch_.RLock();
-  // LOG_DEBUG("root latch rlocked");
-  auto *leaf_page = FindLeafPage(key,false,false,0,nullptr);
-  auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
-  auto index = leaf->KeyIndex(key,comparator_);
-  // ToString(reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPgImp(root_page_id_)),buffer_pool_manager_);
-  // LOG_DEBUG("The index is %d",index);
-  return INDEXITERATOR_TYPE(buffer_pool_manager_, leaf_page, index);
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  INDEXITERATOR_TYPE iterator(this, buffer_pool_manager_);
+  iterator.Seek(key, false);
+  return iterator;
 }
 
 /*
@@ -631,24 +985,7 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { 
-  // LOG_DEBUG("Iteration end with no key");
-  if (root_page_id_ == INVALID_PAGE_ID) {
-    // LOG_DEBUG("Empty tree got no iterators");
-    return INDEXITERATOR_TYPE(nullptr, nullptr);
-  }
-  root_latch_.RLock();
-  // LOG_DEBUG("root latch rocked");
-  auto *leaf_page = FindLeafPage(KeyType(),false,true,0,nullptr);
-  // LOG_DEBUG("Is the leaf the right most?");
-  // std::cout << "The page id of the leaf is " << leaf_page->GetPageId() << std::endl;
-  // ToString(reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPgImp(root_page_id_)),buffer_pool_manager_);
-  auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
-  auto index = leaf->GetSize();
-  // ToString(reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPgImp(root_page_id_)),buffer_pool_manager_);
-  // LOG_DEBUG("The index is %d",index);
-  return INDEXITERATOR_TYPE(buffer_pool_manager_, leaf_page, index);
-}
+auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(this, buffer_pool_manager_); }
 
 /**
  * @return Page id of the root of this tree
@@ -660,6 +997,51 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
   return root_page_id_; 
 }
 
+/*
+ * Number of levels, 0 for an empty tree
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetHeight() -> int {
+  int height = 0;
+  page_id_t page_id = root_page_id_;
+  while(page_id != INVALID_PAGE_ID){
+    auto *page = buffer_pool_manager_->FetchPgImp(page_id);
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    page_id = node->IsLeafPage() ? INVALID_PAGE_ID : reinterpret_cast<InternalPage *>(node)->ValueAt(0);
+    buffer_pool_manager_->UnpinPgImp(page->GetPageId(),false);
+    height++;
+  }
+  return height;
+}
+
+/*
+ * Number of pages, level by level; the leaves are counted from their parents
+ * without reading them
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetPageCount() -> size_t {
+  int height = GetHeight();
+  size_t count = 0;
+  std::vector<page_id_t> level{root_page_id_};
+  for(int depth = 1; depth <= height; depth++){
+    count += level.size();
+    if(depth == height){
+      break;
+    }
+    std::vector<page_id_t> children;
+    for(auto page_id : level){
+      auto *page = buffer_pool_manager_->FetchPgImp(page_id);
+      auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+      for(int i = 0; i < internal->GetSize(); i++){
+        children.push_back(internal->ValueAt(i));
+      }
+      buffer_pool_manager_->UnpinPgImp(page_id,false);
+    }
+    level = std::move(children);
+  }
+  return count;
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
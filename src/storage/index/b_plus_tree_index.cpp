@@ -9,6 +9,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
@@ -16,10 +18,13 @@ namespace bustub {
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     bool compressed)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_,
+                 compressed ? COMPRESSED_LEAF_PAGE_SIZE : static_cast<int>(LEAF_PAGE_SIZE),
+                 compressed ? COMPRESSED_INTERNAL_PAGE_SIZE : static_cast<int>(INTERNAL_PAGE_SIZE), compressed) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
@@ -27,7 +32,40 @@ void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *t
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Insert(index_key, rid, transaction);
+  if (!container_.Insert(index_key, rid, transaction)) {
+    TurnedEntryAway();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntries(std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) {
+  std::vector<MappingType> items;
+  items.reserve(entries->size());
+  for (const auto &[key, rid] : *entries) {
+    KeyType index_key;
+    index_key.SetFromKey(key);
+    items.emplace_back(index_key, rid);
+  }
+  // stable, so that the first entry of a key is the one kept
+  std::stable_sort(items.begin(), items.end(),
+                   [this](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+  items.erase(std::unique(items.begin(), items.end(),
+                          [this](const MappingType &a, const MappingType &b) {
+                            return comparator_(a.first, b.first) == 0;
+                          }),
+              items.end());
+  if (items.size() < entries->size()) {
+    TurnedEntryAway();
+  }
+
+  if (container_.BulkLoad(items)) {
+    return;
+  }
+  for (const auto &[key, rid] : items) {
+    if (!container_.Insert(key, rid, transaction)) {
+      TurnedEntryAway();
+    }
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -48,6 +86,17 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i]);
+  }
+
+  container_.GetValues(index_keys, results, transaction);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
 
@@ -20,6 +20,7 @@ void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *
   KeyType index_key;
   index_key.SetFromKey(key);
 
+  // keys with more entries than a bucket holds overflow, so the only pair turned away is one the table holds already
   container_.Insert(transaction, index_key, rid);
 }
 
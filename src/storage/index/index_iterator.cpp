@@ -1,70 +1,158 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, Page *page,int index) : buffer_pool_manager_(bpm), page_(page), index_(index) {
-    if(page != nullptr){
-        leaf_ = reinterpret_cast<LeafPage *>(page->GetData());
-    } else {
-        leaf_ = nullptr;
-    }
+INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm)
+    : tree_(tree), buffer_pool_manager_(bpm) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() = default;
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::IsEnd() -> bool {
+    return index_ >= static_cast<int>(items_.size()) && next_page_id_ == INVALID_PAGE_ID;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() {
-    if(page_ != nullptr){
-        page_->RUnlatch();
-        buffer_pool_manager_->UnpinPgImp(page_->GetPageId(),false);
-    }
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+    return items_[index_];
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool { 
-    return leaf_->GetNextPageId() == INVALID_PAGE_ID && index_ == leaf_->GetSize();
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+    index_++;
+    if(index_ < static_cast<int>(items_.size()) || items_.empty()){
+        return *this;
+    }
+    KeyType last_key = items_.back().first;
+    while(index_ >= static_cast<int>(items_.size()) && next_page_id_ != INVALID_PAGE_ID){
+        if(!ReadNextLeaf()){
+            ReadLeaf(last_key, false);
+        }
+        auto &comparator = tree_->comparator_;
+        index_ = std::upper_bound(items_.begin(), items_.end(), last_key, [&comparator](auto k, const auto &pair) {
+                   return comparator(k, pair.first) < 0;
+                 }) - items_.begin();
+    }
+    return *this;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { 
-    return leaf_->GetItem(index_);
+auto INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const -> bool {
+    auto is_end = index_ >= static_cast<int>(items_.size()) && next_page_id_ == INVALID_PAGE_ID;
+    auto itr_is_end = itr.index_ >= static_cast<int>(itr.items_.size()) && itr.next_page_id_ == INVALID_PAGE_ID;
+    if(is_end || itr_is_end){
+        return is_end && itr_is_end;
+    }
+    return page_ == itr.page_ && index_ == itr.index_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & { 
-    if(leaf_->GetNextPageId() != INVALID_PAGE_ID){
-        if(index_ == leaf_->GetSize() - 1){
-            auto next_pid = leaf_->GetNextPageId();
-            auto next_page = buffer_pool_manager_->FetchPgImp(next_pid);
-            next_page->RLatch();
-            page_->RUnlatch();
-            buffer_pool_manager_->UnpinPgImp(page_->GetPageId(),false);
-            page_ = next_page;
-            leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+auto INDEXITERATOR_TYPE::operator!=(const IndexIterator &itr) const -> bool { return !this->operator==(itr); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Seek(const KeyType &key, bool leftMost) {
+    auto &comparator = tree_->comparator_;
+    auto lower_bound = [&]() -> int {
+        if(leftMost){
+            return 0;
+        }
+        return std::lower_bound(items_.begin(), items_.end(), key, [&comparator](const auto &pair, auto k) {
+                   return comparator(pair.first, k) < 0;
+                 }) - items_.begin();
+    };
+    ReadLeaf(key, leftMost);
+    index_ = lower_bound();
+    // The first key >= key may be at the start of the next leaf.
+    while(index_ >= static_cast<int>(items_.size()) && next_page_id_ != INVALID_PAGE_ID){
+        if(ReadNextLeaf()){
             index_ = 0;
-            // buffer_pool_manager_->UnpinPgImp(page_->GetPageId(),false);
+        } else {
+            ReadLeaf(key, leftMost);
+            index_ = lower_bound();
         }
-    } else {
-        index_++;
     }
-    return *this;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const -> bool { 
-    return (leaf_ == nullptr && itr.leaf_ == nullptr) || (leaf_->GetPageId() == itr.leaf_->GetPageId() && index_ == itr.index_);
+void INDEXITERATOR_TYPE::ReadLeaf(const KeyType &key, bool leftMost) {
+    for(int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES; attempt++){
+        uint64_t version;
+        auto *page = tree_->FindLeafPageOptimistic(key, leftMost, &version);
+        if(page == nullptr){
+            break;
+        }
+        CopyLeaf(page);
+        if(page->ValidateVersion(version)){
+            page_ = page;
+            version_ = version;
+            return;
+        }
+    }
+    // Some page on the way is not in memory, or writers keep changing it: crab down with read latches.
+    auto *page = tree_->FindLeafPageLatched(key, leftMost);
+    if(page == nullptr){
+        items_.clear();
+        page_ = nullptr;
+        next_page_id_ = INVALID_PAGE_ID;
+        return;
+    }
+    CopyLeaf(page);
+    page_ = page;
+    version_ = page->GetVersion();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPgImp(page->GetPageId(), false);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator!=(const IndexIterator &itr) const -> bool { return !this->operator==(itr); }
+auto INDEXITERATOR_TYPE::ReadNextLeaf() -> bool {
+    auto next_pid = next_page_id_;
+    uint64_t version;
+    auto *next_page = buffer_pool_manager_->FetchPageOptimistic(next_pid, &version);
+    if(next_page != nullptr){
+        CopyLeaf(next_page);
+        if(!next_page->ValidateVersion(version) || !page_->ValidateVersion(version_)){
+            return false;
+        }
+    } else {
+        next_page = buffer_pool_manager_->FetchPgImp(next_pid, AccessType::Index);
+        if(next_page == nullptr){
+            return false;
+        }
+        next_page->RLatch();
+        CopyLeaf(next_page);
+        version = next_page->GetVersion();
+        auto valid = page_->ValidateVersion(version_);
+        next_page->RUnlatch();
+        buffer_pool_manager_->UnpinPgImp(next_pid, false);
+        if(!valid){
+            return false;
+        }
+    }
+    page_ = next_page;
+    version_ = version;
+    buffer_pool_manager_->PrefetchChain(
+        next_page_id_, READ_AHEAD_PAGES,
+        [](Page *page) { return reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId(); },
+        AccessType::Index);
+    return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::CopyLeaf(Page *page) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    // An optimistic reader may see a page that is being reused, so keep the copy inside the page.
+    leaf->CopyItemsOptimistic(&items_);
+    next_page_id_ = leaf->GetNextPageId();
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
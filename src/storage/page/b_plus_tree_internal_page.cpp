@@ -9,6 +9,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -26,8 +27,8 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
-  SetPageType(IndexPageType::INTERNAL_PAGE);
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool compressed) {
+  SetPageType(compressed ? IndexPageType::COMPRESSED_INTERNAL_PAGE : IndexPageType::INTERNAL_PAGE);
   SetSize(0);
   SetPageId(page_id);
   SetParentPageId(parent_id);
@@ -41,16 +42,32 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
   // replace with your own code
+  if(IsCompressed()){
+    return CompressedEntries<MappingType>::Decode(reinterpret_cast<const char *>(array_), INTERNAL_PAGE_AREA_SIZE,
+                                                  index).first;
+  }
   return array_[index].first;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items[index].first = key;
+    EncodeEntries(items);
+    return;
+  }
   array_[index].first = key;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items[index].second = value;
+    EncodeEntries(items);
+    return;
+  }
   array_[index].second = value;
 }
 
@@ -60,12 +77,27 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &valu
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index].second; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  if(IsCompressed()){
+    return CompressedEntries<MappingType>::Decode(reinterpret_cast<const char *>(array_), INTERNAL_PAGE_AREA_SIZE,
+                                                  index).second;
+  }
+  return array_[index].second;
+}
 
 
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const { 
   // LOG_DEBUG("ValueIndex function in b plus tree internal page");
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    for(int i = 0;i < GetSize();i++){
+      if(value == items[i].second){
+        return i;
+      }
+    }
+    return GetSize();
+  }
   for(int i = 0;i < GetSize();i++){
     if(value == array_[i].second){
       // LOG_DEBUG("Found value at index %d",i);
@@ -79,6 +111,14 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
 
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) {
+  if(IsCompressed()){
+    return LookupChildOptimistic(key,false,comparator);
+  }
+  // the separators start at index 1, the child is the last one whose separator is <= key
+  int count = IntegerKeyCountBelow(array_ + 1, GetSize() - 1, key, comparator, true);
+  if(count >= 0){
+    return array_[count].second;
+  }
   auto target = std::lower_bound(array_ + 1, array_ + GetSize(), key,
                                  [&comparator](const auto &pair, auto k) { return comparator(pair.first, k) < 0; });
   if (target == array_ + GetSize()) {
@@ -95,6 +135,11 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) {
+  if(IsCompressed()){
+    // The first key is never looked at, the same key as the second one compresses best.
+    EncodeEntries({MappingType(new_key, old_value), MappingType(new_key, new_value)});
+    return;
+  }
   SetKeyAt(1, new_key);
   SetValueAt(0, old_value);
   SetValueAt(1, new_value);
@@ -107,6 +152,12 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
                                                     const ValueType &new_value) -> int {
   // LOG_DEBUG("InsertNodeAfter function in b plus tree internal page");
   int index = ValueIndex(old_value);
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items.insert(items.begin() + index + 1, MappingType(new_key, new_value));
+    EncodeEntries(items);
+    return GetSize();
+  }
   std::move_backward(array_ + index + 1, array_ + GetSize(), array_ + GetSize() + 1);
   array_[index + 1].first = new_key;
   array_[index + 1].second = new_value;
@@ -119,6 +170,15 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
                                                 BufferPoolManager *buffer_pool_manager) {
   // LOG_DEBUG("Move half to function in b plus tree internal page");
+  if(IsCompressed()){
+    // Like for leaves, a compressed page splits when its entries run out of room, whatever their number.
+    auto items = DecodeEntries();
+    int keep = (GetSize() + 1) / 2;
+    recipient->CopyNFrom(items.data() + keep, GetSize() - keep, buffer_pool_manager);
+    items.resize(keep);
+    EncodeEntries(items);
+    return;
+  }
   int min_size = GetMinSize();
   int size = GetSize();
   recipient->CopyNFrom(array_ + min_size, size - min_size, buffer_pool_manager);
@@ -128,23 +188,36 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient
 
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(const MappingType *items, int size,
+                                               BufferPoolManager *buffer_pool_manager) {
   // LOG_DEBUG("Enter CopyNFrom function in b plus tree internal page");
-  std::copy(items,items + size, array_ + GetSize());
+  if(IsCompressed()){
+    auto all = DecodeEntries();
+    all.insert(all.end(), items, items + size);
+    EncodeEntries(all);
+  } else {
+    std::copy(items,items + size, array_ + GetSize());
+    IncreaseSize(size);
+  }
   for(int i = 0;i < size;i++){
-    auto page = buffer_pool_manager->FetchPgImp(ValueAt(i + GetSize()));
+    auto page = buffer_pool_manager->FetchPgImp(items[i].second);
     // LOG_DEBUG("This page id %d",page->GetPageId());
     auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
     node->SetParentPageId(GetPageId());
     buffer_pool_manager->UnpinPage(page->GetPageId(), true);
   }
-  IncreaseSize(size);
   // LOG_DEBUG("Now the size is %d",GetSize());
 }
 
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items.erase(items.begin() + index);
+    EncodeEntries(items);
+    return;
+  }
   std::move(array_ + index + 1, array_ + GetSize(), array_ + index);
   IncreaseSize(-1);
 }
@@ -162,6 +235,13 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                BufferPoolManager *buffer_pool_manager) {
   // LOG_DEBUG("MoveAllTo function in b plus tree internal page");
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items[0].first = middle_key;
+    recipient->CopyNFrom(items.data(), items.size(), buffer_pool_manager);
+    SetSize(0);
+    return;
+  }
   SetKeyAt(0,middle_key);
   recipient->CopyNFrom(array_, GetSize(), buffer_pool_manager);
   SetSize(0);
@@ -172,6 +252,14 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                       BufferPoolManager *buffer_pool_manager) {
   // LOG_DEBUG("MoveFirstToEndOf function in b plus tree internal page");
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    auto item = MappingType(middle_key, items[0].second);
+    items.erase(items.begin());
+    EncodeEntries(items);
+    recipient->CopyLastFrom(item, buffer_pool_manager);
+    return;
+  }
   SetKeyAt(0,middle_key);
   auto item = array_[0];
   recipient->CopyLastFrom(item, buffer_pool_manager);
@@ -183,8 +271,14 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *rec
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
   // LOG_DEBUG("CopyLastFrom function in b plus tree internal page");
-  *(array_ + GetSize()) = pair;
-  IncreaseSize(1);
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items.push_back(pair);
+    EncodeEntries(items);
+  } else {
+    *(array_ + GetSize()) = pair;
+    IncreaseSize(1);
+  }
   auto page = buffer_pool_manager->FetchPgImp(pair.second);
   auto *tpage = reinterpret_cast<BPlusTreePage *>(page->GetData());
   tpage->SetParentPageId(GetPageId());
@@ -196,6 +290,17 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                        BufferPoolManager *buffer_pool_manager) {
   // LOG_DEBUG("MoveLastToFrontOf function in b plus tree internal page");
+  if(IsCompressed()){
+    // The last child moves over with its key, which goes up to the parent, and middle_key comes down in front of
+    // the first child of recipient.
+    auto items = DecodeEntries();
+    auto item = items.back();
+    items.pop_back();
+    EncodeEntries(items);
+    recipient->SetKeyAt(0, middle_key);
+    recipient->CopyFirstFrom(item, buffer_pool_manager);
+    return;
+  }
   SetKeyAt(GetSize() - 1,middle_key);
   auto item = array_[GetSize() - 1];
   recipient->CopyFirstFrom(item, buffer_pool_manager);
@@ -206,8 +311,14 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *re
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
   // LOG_DEBUG("CopyFirstFrom function in b plus tree internal page");
-  std::move(array_, array_ + GetSize(), array_ + 1);
-  IncreaseSize(1);
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items.insert(items.begin(), pair);
+    EncodeEntries(items);
+  } else {
+    std::move(array_, array_ + GetSize(), array_ + 1);
+    IncreaseSize(1);
+  }
   // SetValueAt(0,pair);
   auto page = buffer_pool_manager->FetchPgImp(pair.second);
   auto *tpage = reinterpret_cast<BPlusTreePage *>(page->GetData());
@@ -215,9 +326,119 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, Buff
   buffer_pool_manager->UnpinPage(page->GetPageId(), true);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Append(const KeyType &key, const ValueType &value) {
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items.emplace_back(key, value);
+    EncodeEntries(items);
+    return;
+  }
+  array_[GetSize()] = MappingType(key, value);
+  IncreaseSize(1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasRoomFor(const KeyType &key, const ValueType &value) const {
+  if(GetSize() >= GetMaxSize()){
+    return false;
+  }
+  if(!IsCompressed()){
+    return true;
+  }
+  auto size = CompressedEntries<MappingType>::EncodedSizeWith(reinterpret_cast<const char *>(array_), GetSize(),
+                                                              MappingType(key, value));
+  return size <= INTERNAL_PAGE_AREA_SIZE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasRoomForAny() const {
+  if(GetSize() >= GetMaxSize()){
+    return false;
+  }
+  // No entry can take more room than it does without compression.
+  return !IsCompressed() ||
+         GetSize() + 1 <= CompressedEntries<MappingType>::UncompressedCapacity(INTERNAL_PAGE_AREA_SIZE);
+}
 
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSetKeyAt(int index, const KeyType &key) const {
+  if(!IsCompressed()){
+    return true;
+  }
+  auto items = DecodeEntries();
+  items[index].first = key;
+  return CompressedEntries<MappingType>::EncodedSize(items.data(), items.size()) <= INTERNAL_PAGE_AREA_SIZE;
+}
 
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMergeWith(const BPlusTreeInternalPage *other, const KeyType &middle_key) const {
+  if(!IsCompressed()){
+    return true;
+  }
+  auto items = DecodeEntries();
+  auto other_items = other->DecodeEntries();
+  other_items[0].first = middle_key;
+  items.insert(items.end(), other_items.begin(), other_items.end());
+  return CompressedEntries<MappingType>::EncodedSize(items.data(), items.size()) <= INTERNAL_PAGE_AREA_SIZE;
+}
 
+/*
+ * Child lookup for optimistic readers. The page may change while it is read,
+ * even turn into another kind of page, so its type and size are read once and
+ * no index leaves the page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupChildOptimistic(const KeyType &key, bool leftMost,
+                                                           const KeyComparator &comparator) const -> ValueType {
+  auto search = [&](int capacity, auto &&entry_at) -> ValueType {
+    int size = GetSize();
+    if(size < 1 || size > capacity){
+      return INVALID_PAGE_ID;
+    }
+    if(leftMost){
+      return entry_at(0).second;
+    }
+    // the last child whose separator is <= key
+    int low = 1;
+    int high = size;
+    while(low < high){
+      int mid = low + (high - low) / 2;
+      if(comparator(entry_at(mid).first,key) <= 0){
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return entry_at(low - 1).second;
+  };
+  if(IsCompressed()){
+    typename CompressedEntries<MappingType>::Reader reader(reinterpret_cast<const char *>(array_),
+                                                           INTERNAL_PAGE_AREA_SIZE);
+    return search(COMPRESSED_INTERNAL_PAGE_SIZE, [&](int i) { return reader.Get(i); });
+  }
+  int size = GetSize();
+  if(!leftMost && size >= 1 && size <= static_cast<int>(INTERNAL_PAGE_SIZE)){
+    int count = IntegerKeyCountBelow(array_ + 1, size - 1, key, comparator, true);
+    if(count >= 0){
+      return array_[count].second;
+    }
+  }
+  return search(static_cast<int>(INTERNAL_PAGE_SIZE), [&](int i) { return array_[i]; });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::DecodeEntries() const -> std::vector<MappingType> {
+  return CompressedEntries<MappingType>::DecodeAll(reinterpret_cast<const char *>(array_), INTERNAL_PAGE_AREA_SIZE,
+                                                   GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::EncodeEntries(const std::vector<MappingType> &items) {
+  assert(CompressedEntries<MappingType>::EncodedSize(items.data(), items.size()) <= INTERNAL_PAGE_AREA_SIZE);
+  CompressedEntries<MappingType>::Encode(items.data(), items.size(), reinterpret_cast<char *>(array_));
+  SetSize(items.size());
+}
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
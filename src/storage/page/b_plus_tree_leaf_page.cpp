@@ -28,8 +28,8 @@ namespace bustub {
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
-  SetPageType(IndexPageType::LEAF_PAGE);
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool compressed) {
+  SetPageType(compressed ? IndexPageType::COMPRESSED_LEAF_PAGE : IndexPageType::LEAF_PAGE);
   SetSize(0);
   SetPageId(page_id);
   SetParentPageId(parent_id);
@@ -53,12 +53,33 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_pa
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
   // replace with your own code
+  if(IsCompressed()){
+    return GetItem(index).first;
+  }
   return array_[index].first;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const { 
   // LOG_DEBUG("Enter key index function");
+  if(IsCompressed()){
+    typename CompressedEntries<MappingType>::Reader reader(reinterpret_cast<const char *>(array_), LEAF_PAGE_AREA_SIZE);
+    int low = 0;
+    int high = GetSize();
+    while(low < high){
+      int mid = low + (high - low) / 2;
+      if(comparator(reader.Get(mid).first,key) < 0){
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+  int count = IntegerKeyCountBelow(array_, GetSize(), key, comparator, false);
+  if(count >= 0){
+    return count;
+  }
   auto target = std::lower_bound(array_, array_ + GetSize(), key, [&comparator](const auto &pair, auto k) {
     return comparator(pair.first, k) < 0;
   });
@@ -66,16 +87,59 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const -> MappingType {
+  if(IsCompressed()){
+    return CompressedEntries<MappingType>::Decode(reinterpret_cast<const char *>(array_), LEAF_PAGE_AREA_SIZE, index);
+  }
   return array_[index];
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::HasRoomFor(const KeyType &key, const ValueType &value) const {
+  if(GetSize() + 1 >= GetMaxSize()){
+    return false;
+  }
+  if(!IsCompressed()){
+    return true;
+  }
+  auto size = CompressedEntries<MappingType>::EncodedSizeWith(reinterpret_cast<const char *>(array_), GetSize(),
+                                                              MappingType(key,value));
+  return size <= LEAF_PAGE_AREA_SIZE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::HasRoomForAny() const {
+  if(GetSize() + 1 >= GetMaxSize()){
+    return false;
+  }
+  // No entry can take more room than it does without compression.
+  return !IsCompressed() ||
+         GetSize() + 1 <= CompressedEntries<MappingType>::UncompressedCapacity(LEAF_PAGE_AREA_SIZE);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CanMergeWith(const BPlusTreeLeafPage *other) const {
+  if(!IsCompressed()){
+    return true;
+  }
+  auto items = DecodeEntries();
+  auto other_items = other->DecodeEntries();
+  items.insert(items.end(), other_items.begin(), other_items.end());
+  return CompressedEntries<MappingType>::EncodedSize(items.data(), items.size()) <= LEAF_PAGE_AREA_SIZE;
+}
+
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int {
   // LOG_DEBUG("Enter insert in b plus tree leaf page");
   int idx = KeyIndex(key,comparator); //first larger than key
   assert(idx >= 0);
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items.insert(items.begin() + idx, MappingType(key,value));
+    EncodeEntries(items);
+    return GetSize();
+  }
   IncreaseSize(1);
   int curSize = GetSize();
   for (int i = curSize - 1; i > idx; i--) {
@@ -87,10 +151,24 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &val
   return curSize;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::AppendSorted(const MappingType *items, int size) {
+  CopyNFrom(items, size);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
   // TODO: Implement after Copy function
   // LOG_DEBUG("Enter move half to function in leaf page");
+  if(IsCompressed()){
+    // A compressed page splits when its entries run out of room, whatever their number.
+    auto items = DecodeEntries();
+    int keep = GetSize() / 2;
+    recipient->CopyNFrom(items.data() + keep, GetSize() - keep);
+    items.resize(keep);
+    EncodeEntries(items);
+    return;
+  }
   int start_split_indx = GetMinSize();
   SetSize(start_split_indx);
   recipient->CopyNFrom(array_ + start_split_indx, GetMaxSize() - start_split_indx);
@@ -98,8 +176,14 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const MappingType *items, int size) {
   // LOG_DEBUG("Copy N function from leaf page");
+  if(IsCompressed()){
+    auto all = DecodeEntries();
+    all.insert(all.end(), items, items + size);
+    EncodeEntries(all);
+    return;
+  }
   std::copy(items, items + size, array_ + GetSize());
   IncreaseSize(size);
   // LOG_DEBUG("finish copy N from leaf page");
@@ -108,6 +192,14 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
   // LOG_DEBUG("Enter lookup function in b plus tree leaf page");
+  if(IsCompressed() || comparator.GetLayout() != KeyLayout::GENERIC){
+    int index = KeyIndex(key,comparator);
+    if(index == GetSize() || comparator(KeyAt(index),key) != 0){
+      return false;
+    }
+    *value = GetItem(index).second;
+    return true;
+  }
   for(int i = 0;i < GetSize();i++){
     if(comparator(key,array_[i].first) == 0){
       // LOG_DEBUG("Successfully found with index %d",i);
@@ -125,11 +217,17 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
   int index = KeyIndex(key,comparator);
   // LOG_DEBUG("The index is %d",index);
   // std::cout << "The two params are " << array_[index].first << " and " << key << std::endl;
-  if(index == GetSize() || comparator(array_[index].first, key) != 0){
+  if(index == GetSize() || comparator(KeyAt(index), key) != 0){
     // LOG_DEBUG("Didn't found");
     return GetSize();
   }
   // LOG_DEBUG("Key found");
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items.erase(items.begin() + index);
+    EncodeEntries(items);
+    return GetSize();
+  }
   std::move(array_ + index + 1,array_ + GetSize(),array_ + index);
   IncreaseSize(-1);
   return GetSize();
@@ -137,7 +235,12 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
-  recipient->CopyNFrom(array_, GetSize());
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    recipient->CopyNFrom(items.data(), items.size());
+  } else {
+    recipient->CopyNFrom(array_, GetSize());
+  }
   recipient->SetNextPageId(GetNextPageId());
   SetSize(0);
 }
@@ -146,14 +249,26 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
   auto first_item = GetItem(0);
-  std::move(array_ + 1,array_ + GetSize(),array_);
-  IncreaseSize(-1);
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items.erase(items.begin());
+    EncodeEntries(items);
+  } else {
+    std::move(array_ + 1,array_ + GetSize(),array_);
+    IncreaseSize(-1);
+  }
   recipient->CopyLastFrom(first_item);
 }
 
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items.push_back(item);
+    EncodeEntries(items);
+    return;
+  }
   *(array_ + GetSize()) = item;
   IncreaseSize(1);
 }
@@ -162,18 +277,99 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
   auto last_item = GetItem(GetSize() - 1);
-  IncreaseSize(-1);
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items.pop_back();
+    EncodeEntries(items);
+  } else {
+    IncreaseSize(-1);
+  }
   recipient->CopyFirstFrom(last_item);
 }
 
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
+  if(IsCompressed()){
+    auto items = DecodeEntries();
+    items.insert(items.begin(), item);
+    EncodeEntries(items);
+    return;
+  }
   std::move(array_,array_ + GetSize(), array_ + 1);
   array_[0] = item;
   IncreaseSize(1);
 }
 
+/*
+ * Lookup for optimistic readers. The page may change while it is read, even
+ * turn into another kind of page, so its type and size are read once and no
+ * index leaves the page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::LookupOptimistic(const KeyType &key, ValueType *value,
+                                                  const KeyComparator &comparator) const {
+  auto search = [&](int size, auto &&entry_at) {
+    int low = 0;
+    int high = size;
+    while(low < high){
+      int mid = low + (high - low) / 2;
+      if(comparator(entry_at(mid).first,key) < 0){
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    if(low == size){
+      return false;
+    }
+    auto item = entry_at(low);
+    if(comparator(item.first,key) != 0){
+      return false;
+    }
+    *value = item.second;
+    return true;
+  };
+  if(IsCompressed()){
+    typename CompressedEntries<MappingType>::Reader reader(reinterpret_cast<const char *>(array_), LEAF_PAGE_AREA_SIZE);
+    return search(std::clamp(GetSize(), 0, COMPRESSED_LEAF_PAGE_SIZE), [&](int i) { return reader.Get(i); });
+  }
+  int size = std::clamp(GetSize(), 0, static_cast<int>(LEAF_PAGE_SIZE));
+  int count = IntegerKeyCountBelow(array_, size, key, comparator, false);
+  if(count >= 0){
+    if(count == size || comparator(array_[count].first,key) != 0){
+      return false;
+    }
+    *value = array_[count].second;
+    return true;
+  }
+  return search(size, [&](int i) { return array_[i]; });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyItemsOptimistic(std::vector<MappingType> *items) const {
+  if(!IsCompressed()){
+    int size = std::clamp(GetSize(), 0, static_cast<int>(LEAF_PAGE_SIZE));
+    items->assign(array_, array_ + size);
+    return;
+  }
+  int size = std::clamp(GetSize(), 0, COMPRESSED_LEAF_PAGE_SIZE);
+  *items = CompressedEntries<MappingType>::DecodeAll(reinterpret_cast<const char *>(array_), LEAF_PAGE_AREA_SIZE, size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::DecodeEntries() const -> std::vector<MappingType> {
+  return CompressedEntries<MappingType>::DecodeAll(reinterpret_cast<const char *>(array_), LEAF_PAGE_AREA_SIZE,
+                                                   GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::EncodeEntries(const std::vector<MappingType> &items) {
+  assert(CompressedEntries<MappingType>::EncodedSize(items.data(), items.size()) <= LEAF_PAGE_AREA_SIZE);
+  CompressedEntries<MappingType>::Encode(items.data(), items.size(), reinterpret_cast<char *>(array_));
+  SetSize(items.size());
+}
+
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
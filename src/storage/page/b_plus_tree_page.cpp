@@ -17,8 +17,13 @@ namespace bustub {
  * Helper methods to get/set page type
  * Page type enum class is defined in b_plus_tree_page.h
  */
-auto BPlusTreePage::IsLeafPage() const -> bool { return page_type_ == IndexPageType::LEAF_PAGE; }
+auto BPlusTreePage::IsLeafPage() const -> bool {
+  return page_type_ == IndexPageType::LEAF_PAGE || page_type_ == IndexPageType::COMPRESSED_LEAF_PAGE;
+}
 auto BPlusTreePage::IsRootPage() const -> bool { return parent_page_id_ == INVALID_PAGE_ID; }
+auto BPlusTreePage::IsCompressed() const -> bool {
+  return page_type_ == IndexPageType::COMPRESSED_LEAF_PAGE || page_type_ == IndexPageType::COMPRESSED_INTERNAL_PAGE;
+}
 IndexPageType BPlusTreePage::GetPageType() { return page_type_; }
 void BPlusTreePage::SetPageType(IndexPageType page_type) { page_type_ = page_type; }
 
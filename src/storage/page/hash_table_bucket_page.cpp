@@ -19,63 +19,125 @@
 
 namespace bustub {
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::Init() {
+  overflow_page_id_ = INVALID_PAGE_ID;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::GetOverflowPageId() const -> page_id_t {
+  return overflow_page_id_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::SetOverflowPageId(page_id_t overflow_page_id) {
+  overflow_page_id_ = overflow_page_id;
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
-  return false;
+  bool found = false;
+  // slots are occupied in order, so the first one never occupied ends the bucket
+  for (uint32_t bucket_idx = 0; bucket_idx < BUCKET_ARRAY_SIZE && IsOccupied(bucket_idx); bucket_idx++) {
+    if (IsReadable(bucket_idx) && cmp(key, array_[bucket_idx].first) == 0) {
+      result->push_back(array_[bucket_idx].second);
+      found = true;
+    }
+  }
+  return found;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  int64_t free_idx = -1;
+  uint32_t bucket_idx = 0;
+  for (; bucket_idx < BUCKET_ARRAY_SIZE && IsOccupied(bucket_idx); bucket_idx++) {
+    if (!IsReadable(bucket_idx)) {
+      free_idx = free_idx == -1 ? bucket_idx : free_idx;
+    } else if (cmp(key, array_[bucket_idx].first) == 0 && array_[bucket_idx].second == value) {
+      return false;
+    }
+  }
+  if (free_idx == -1) {
+    if (bucket_idx == BUCKET_ARRAY_SIZE) {
+      return false;
+    }
+    free_idx = bucket_idx;
+  }
+  array_[free_idx] = MappingType(key, value);
+  SetOccupied(free_idx);
+  SetReadable(free_idx);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  for (uint32_t bucket_idx = 0; bucket_idx < BUCKET_ARRAY_SIZE && IsOccupied(bucket_idx); bucket_idx++) {
+    if (IsReadable(bucket_idx) && cmp(key, array_[bucket_idx].first) == 0 && array_[bucket_idx].second == value) {
+      RemoveAt(bucket_idx);
+      return true;
+    }
+  }
   return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
-  return {};
+  return array_[bucket_idx].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (occupied_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  occupied_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (readable_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  return false;
+  return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
-  return 0;
+  uint32_t count = 0;
+  for (auto byte : readable_) {
+    count += __builtin_popcount(static_cast<unsigned char>(byte));
+  }
+  return count;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  return false;
+  for (auto byte : readable_) {
+    if (byte != 0) {
+      return false;
+    }
+  }
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
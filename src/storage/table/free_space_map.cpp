@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "common/logger.h"
+#include "common/macros.h"
+#include "storage/table/free_space_map.h"
+
+namespace bustub {
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {
+  page_id_t page_id;
+  auto page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&page_id));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't create a page for the free space map.");
+  page->Init(page_id);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  map_page_ids_.push_back(page_id);
+  max_free_space_.push_back(0);
+}
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id)
+    : buffer_pool_manager_(buffer_pool_manager) {
+  auto page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the free space map.");
+    uint32_t max_free_space = 0;
+    for (uint32_t i = 0; i < page->GetEntryCount(); i++) {
+      locations_[page->GetTablePageId(i)] = {map_page_ids_.size(), i};
+      max_free_space = std::max(max_free_space, page->GetFreeSpace(i));
+      last_table_page_id_ = page->GetTablePageId(i);
+    }
+    map_page_ids_.push_back(page_id);
+    max_free_space_.push_back(max_free_space);
+    auto next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+auto FreeSpaceMap::GetLastTablePageId() -> page_id_t {
+  std::scoped_lock lock(latch_);
+  return last_table_page_id_;
+}
+
+auto FreeSpaceMap::FindPage(uint32_t size) -> page_id_t {
+  std::scoped_lock lock(latch_);
+  for (size_t i = 0; i < map_page_ids_.size(); i++) {
+    if (max_free_space_[i] < size) {
+      continue;
+    }
+    auto page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_ids_[i]));
+    if (page == nullptr) {
+      return INVALID_PAGE_ID;
+    }
+    uint32_t max_free_space = 0;
+    page_id_t found = INVALID_PAGE_ID;
+    for (uint32_t slot = 0; slot < page->GetEntryCount(); slot++) {
+      if (page->GetFreeSpace(slot) >= size) {
+        found = page->GetTablePageId(slot);
+        break;
+      }
+      max_free_space = std::max(max_free_space, page->GetFreeSpace(slot));
+    }
+    buffer_pool_manager_->UnpinPage(map_page_ids_[i], false);
+    if (found != INVALID_PAGE_ID) {
+      return found;
+    }
+    // The whole page was scanned, so the bound is exact now.
+    max_free_space_[i] = max_free_space;
+  }
+  return INVALID_PAGE_ID;
+}
+
+auto FreeSpaceMap::Add(page_id_t table_page_id, uint32_t free_space) -> bool {
+  std::scoped_lock lock(latch_);
+  auto last_page_id = map_page_ids_.back();
+  auto page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(last_page_id));
+  if (page == nullptr) {
+    complete_ = false;
+    return false;
+  }
+  int slot = page->Append(table_page_id, free_space);
+  if (slot < 0) {
+    // The last map page is full, start a new one.
+    page_id_t new_page_id;
+    auto new_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&new_page_id));
+    if (new_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(last_page_id, false);
+      LOG_DEBUG("Couldn't grow the free space map, page %d is not tracked", table_page_id);
+      complete_ = false;
+      return false;
+    }
+    new_page->Init(new_page_id);
+    page->SetNextPageId(new_page_id);
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+    page = new_page;
+    last_page_id = new_page_id;
+    map_page_ids_.push_back(new_page_id);
+    max_free_space_.push_back(0);
+    slot = page->Append(table_page_id, free_space);
+  }
+  buffer_pool_manager_->UnpinPage(last_page_id, true);
+
+  locations_[table_page_id] = {map_page_ids_.size() - 1, static_cast<uint32_t>(slot)};
+  max_free_space_.back() = std::max(max_free_space_.back(), free_space);
+  last_table_page_id_ = table_page_id;
+  return true;
+}
+
+void FreeSpaceMap::Update(page_id_t table_page_id, uint32_t free_space) {
+  std::scoped_lock lock(latch_);
+  auto it = locations_.find(table_page_id);
+  if (it == locations_.end()) {
+    return;
+  }
+  auto [map_page, slot] = it->second;
+  auto page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_ids_[map_page]));
+  if (page == nullptr) {
+    return;
+  }
+  bool changed = page->GetFreeSpace(slot) != free_space;
+  if (changed) {
+    page->SetFreeSpace(slot, free_space);
+  }
+  buffer_pool_manager_->UnpinPage(map_page_ids_[map_page], changed);
+  max_free_space_[map_page] = std::max(max_free_space_[map_page], free_space);
+}
+
+auto FreeSpaceMap::GetTablePageIds(std::vector<page_id_t> *table_page_ids) -> bool {
+  std::scoped_lock lock(latch_);
+  table_page_ids->clear();
+  if (!complete_) {
+    return false;
+  }
+  for (auto map_page_id : map_page_ids_) {
+    auto page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id));
+    if (page == nullptr) {
+      return false;
+    }
+    for (uint32_t i = 0; i < page->GetEntryCount(); i++) {
+      table_page_ids->push_back(page->GetTablePageId(i));
+    }
+    buffer_pool_manager_->UnpinPage(map_page_id, false);
+  }
+  return true;
+}
+
+}  // namespace bustub
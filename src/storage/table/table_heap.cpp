@@ -23,7 +23,36 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id) {
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch the first page of the table heap.");
+  auto free_space_map_page_id = first_page->GetFreeSpaceMapPageId();
+  if (free_space_map_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(first_page_id_, false);
+    free_space_map_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_, free_space_map_page_id);
+    last_page_id_ = free_space_map_->GetLastTablePageId();
+    return;
+  }
+
+  // The table predates the free space map. Build one from the pages, once.
+  free_space_map_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_);
+  first_page->WLatch();
+  first_page->SetFreeSpaceMapPageId(free_space_map_->GetFirstPageId());
+  first_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+    page->RLatch();
+    free_space_map_->Add(page_id, page->GetMaxInsertSize());
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    last_page_id_ = page_id;
+    page_id = next_page_id;
+  }
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
@@ -33,6 +62,10 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
   BUSTUB_ASSERT(first_page != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
   first_page->Init(first_page_id_, BUSTUB_PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  free_space_map_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_);
+  first_page->SetFreeSpaceMapPageId(free_space_map_->GetFirstPageId());
+  free_space_map_->Add(first_page_id_, first_page->GetMaxInsertSize());
+  last_page_id_ = first_page_id_;
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
@@ -42,55 +75,93 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  // Try the pages the free space map says have enough room. The map is only a hint: if the page filled up in the
+  // meantime, its entry is corrected and the next candidate is tried.
+  page_id_t page_id;
+  bool inserted = false;
+  while (!inserted && (page_id = free_space_map_->FindPage(tuple.size_)) != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page->WLatch();
+    inserted = page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+    auto free_space = page->GetMaxInsertSize();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    free_space_map_->Update(page_id, free_space);
+  }
+
+  if (!inserted && !InsertIntoLastPage(tuple, rid, txn)) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  // Update the transaction's write set.
+  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  return true;
+}
 
+auto TableHeap::InsertIntoLastPage(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
+  std::scoped_lock extend_lock(extend_latch_);
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  if (cur_page == nullptr) {
+    return false;
+  }
   cur_page->WLatch();
+  // Another thread may have appended a page with room since the free space map was searched.
+  if (cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
+    auto free_space = cur_page->GetMaxInsertSize();
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id_, true);
+    free_space_map_->Update(last_page_id_, free_space);
+    return true;
+  }
 
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      next_page->WLatch();
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
-      }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, BUSTUB_PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
-    }
+  // Otherwise we have run out of valid pages. We need to create a new page.
+  page_id_t next_page_id;
+  auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+  // If we could not create a new page,
+  if (new_page == nullptr) {
+    // Then life sucks and we abort the transaction.
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id_, false);
+    return false;
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
+  // Otherwise we were able to create a new page. We initialize it now.
+  new_page->WLatch();
+  cur_page->SetNextPageId(next_page_id);
+  new_page->Init(next_page_id, BUSTUB_PAGE_SIZE, last_page_id_, log_manager_, txn);
   cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-  // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  buffer_pool_manager_->UnpinPage(last_page_id_, true);
+  // A new page takes any tuple that passed the size check.
+  BUSTUB_ENSURE(new_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_), "Tuple must fit a new page.");
+  auto free_space = new_page->GetMaxInsertSize();
+  new_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, true);
+  free_space_map_->Add(next_page_id, free_space);
+  last_page_id_ = next_page_id;
   return true;
 }
 
+void TableHeap::GetPageIds(std::vector<page_id_t> *page_ids) {
+  if (free_space_map_->GetTablePageIds(page_ids)) {
+    return;
+  }
+  page_ids->clear();
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, AccessType::Scan));
+    BUSTUB_ENSURE(page != nullptr, "BPM full");
+    page_ids->push_back(page_id);
+    page->RLatch();
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
 auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
@@ -122,8 +193,12 @@ auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   Tuple old_tuple;
   page->WLatch();
   bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  auto free_space = page->GetMaxInsertSize();
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
+  if (is_updated) {
+    free_space_map_->Update(rid.GetPageId(), free_space);
+  }
   // Update the transaction's write set.
   if (is_updated && txn->GetState() != TransactionState::ABORTED) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
@@ -141,8 +216,11 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   /** Commented out to make compatible with p4; This is called only on commit or delete, which consequently unlocks the
    * tuple; so should be fine */
   // lock_manager_->Unlock(txn, rid);
+  auto free_space = page->GetMaxInsertSize();
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  // The space of the tuple is free now.
+  free_space_map_->Update(rid.GetPageId(), free_space);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
@@ -156,9 +234,10 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
-auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock) -> bool {
+auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock,
+                         AccessType access_type) -> bool {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId(), access_type));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -182,10 +261,16 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, AccessType::Scan));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
+    if (found_tuple) {
+      // Start reading the pages the iterator goes to next.
+      buffer_pool_manager_->PrefetchChain(
+          page->GetNextPageId(), READ_AHEAD_PAGES,
+          [](Page *next) { return static_cast<TablePage *>(next)->GetNextPageId(); }, AccessType::Scan);
+    }
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
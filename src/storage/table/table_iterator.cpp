@@ -21,7 +21,7 @@ namespace bustub {
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
     : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_)) {
+    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, true, AccessType::Scan)) {
       throw bustub::Exception("read non-existing tuple");
     }
   }
@@ -39,7 +39,9 @@ auto TableIterator::operator->() -> Tuple * {
 
 auto TableIterator::operator++() -> TableIterator & {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  // Every page is fetched with the scan hint, so that a large scan only cycles through the buffer pool's scan ring.
+  auto cur_page =
+      static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId(), AccessType::Scan));
   BUSTUB_ENSURE(cur_page != nullptr, "BPM full");  // all pages are pinned
 
   cur_page->RLatch();
@@ -47,11 +49,16 @@ auto TableIterator::operator++() -> TableIterator & {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page =
+          static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId(), AccessType::Scan));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
+      // Keep READ_AHEAD_PAGES pages ahead of the scan on their way into the buffer pool.
+      buffer_pool_manager->PrefetchChain(
+          cur_page->GetNextPageId(), READ_AHEAD_PAGES,
+          [](Page *page) { return static_cast<TablePage *>(page)->GetNextPageId(); }, AccessType::Scan);
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -62,7 +69,7 @@ auto TableIterator::operator++() -> TableIterator & {
   if (*this != table_heap_->End()) {
     // DO NOT ACQUIRE READ LOCK twice in a single thread otherwise it may deadlock.
     // See https://users.rust-lang.org/t/how-bad-is-the-potential-deadlock-mentioned-in-rwlocks-document/67234
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, false)) {
+    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, false, AccessType::Scan)) {
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       throw bustub::Exception("read non-existing tuple");
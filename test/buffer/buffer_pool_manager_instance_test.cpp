@@ -12,9 +12,15 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -145,4 +151,215 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Threads share a pool much smaller than the working set, so most fetches miss and evict dirty pages while other
+// threads are reading the same pages back.
+TEST(BufferPoolManagerInstanceTest, ConcurrentEvictionTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 32;
+  const size_t num_threads = 4;
+  const size_t rounds = 200;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([tid, bpm] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+      for (size_t i = 0; i < rounds; ++i) {
+        page_id_t page_id = page_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          // Every frame is pinned by the other threads at the moment.
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ("page " + std::to_string(page_id), page->GetData());
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, i % 2 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Unpinning a dirty page only sets the dirty bit; the page cleaner writes it back in the background.
+TEST(BufferPoolManagerInstanceTest, PageCleanerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetDirtyPageCount());
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+
+  // Every frame is dirty and unpinned, so the page cleaner has to write them out to have a clean frame ready.
+  for (int i = 0; i < 100 && bpm->GetPagesCleaned() < buffer_pool_size; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(0, bpm->GetDirtyPageCount());
+  EXPECT_EQ(buffer_pool_size, bpm->GetPagesCleaned());
+
+  // Evicting the cleaned pages does not write anything on this thread, and the data is still there.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  EXPECT_EQ(0, bpm->GetSyncWriteEvictions());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(buffer_pool_size + i, false));
+  }
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "page 0"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// A sequential scan only cycles through the scan ring, so the pages everyone else uses stay in the pool.
+TEST(BufferPoolManagerInstanceTest, ScanRingTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t hot_pages = 5;
+  const size_t table_pages = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < hot_pages + table_pages; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  for (size_t i = 0; i < hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i], AccessType::Lookup));
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+
+  // Like a TableIterator, fetch every page of the table a few times in a row.
+  for (size_t i = hot_pages; i < hot_pages + table_pages; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i], AccessType::Scan));
+      EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+    }
+  }
+
+  std::set<page_id_t> resident;
+  for (size_t frame_id = 0; frame_id < buffer_pool_size; ++frame_id) {
+    resident.insert(bpm->GetPages()[frame_id].GetPageId());
+  }
+  for (size_t i = 0; i < hot_pages; ++i) {
+    EXPECT_EQ(1, resident.count(page_ids[i]));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Prefetched pages, and chains of pages, are brought into the pool by the background prefetcher.
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_pages = 30;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Link the pages into a chain: the first bytes of every page hold the id of the next one.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    page_ids.push_back(page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    page_id_t next_page_id = i + 1 < num_pages ? page_ids[i + 1] : INVALID_PAGE_ID;
+    memcpy(page->GetData(), &next_page_id, sizeof(page_id_t));
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], true));
+  }
+
+  auto wait_for_resident = [bpm](const std::vector<page_id_t> &wanted) {
+    for (int i = 0; i < 100; ++i) {
+      std::set<page_id_t> resident;
+      for (size_t frame_id = 0; frame_id < buffer_pool_size; ++frame_id) {
+        resident.insert(bpm->GetPages()[frame_id].GetPageId());
+      }
+      if (std::all_of(wanted.begin(), wanted.end(), [&resident](page_id_t id) { return resident.count(id) > 0; })) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  };
+
+  // The first pages were evicted long ago.
+  std::vector<page_id_t> first_pages(page_ids.begin(), page_ids.begin() + 2);
+  bpm->PrefetchPages(first_pages);
+  EXPECT_TRUE(wait_for_resident(first_pages));
+
+  std::vector<page_id_t> chain(page_ids.begin() + 5, page_ids.begin() + 9);
+  bpm->PrefetchChain(chain[0], chain.size(), [](Page *page) { return *reinterpret_cast<page_id_t *>(page->GetData()); });
+  EXPECT_TRUE(wait_for_resident(chain));
+  EXPECT_LE(first_pages.size() + chain.size(), bpm->GetPagesPrefetched());
+
+  // Prefetched pages hold the right data, and nothing is left pinned.
+  auto *page = bpm->FetchPage(chain[0]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(chain[1], *reinterpret_cast<page_id_t *>(page->GetData()));
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_EQ(true, bpm->UnpinPage(chain[0], false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
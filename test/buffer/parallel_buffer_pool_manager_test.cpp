@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 5;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, k);
+  EXPECT_EQ(buffer_pool_size * num_instances, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until we fill up the buffer pool. Round-robin allocation hands
+  // out consecutive page ids, each one owned by the instance page_id % num_instances.
+  for (size_t i = 1; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+  }
+
+  // Scenario: Once the buffer pool is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: After unpinning pages {0, 1, 2, 3, 4}, one frame is free in every instance, so we can create 5 new
+  // pages regardless of which instance the round robin starts from.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Unpin one page owned by instance 1. New pages can only come from that instance now.
+  EXPECT_EQ(true, bpm->UnpinPage(6, false));
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(1, page_id_temp % static_cast<page_id_t>(num_instances));
+
+  // Scenario: Free a frame in instance 0 and fetch page 0 back; its contents were written to disk on eviction.
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 50;
+  const size_t num_instances = 4;
+  const size_t num_threads = 4;
+  const size_t pages_per_thread = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  std::vector<std::vector<page_id_t>> page_ids(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([tid, bpm, &page_ids] {
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        auto *page = bpm->NewPage(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+        bpm->UnpinPage(page_id, true);
+        page_ids[tid].push_back(page_id);
+      }
+      for (auto page_id : page_ids[tid]) {
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(std::to_string(page_id), page->GetData());
+        bpm->UnpinPage(page_id, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Every page id handed out must be unique across all the instances.
+  std::set<page_id_t> all_page_ids;
+  for (auto &ids : page_ids) {
+    all_page_ids.insert(ids.begin(), ids.end());
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, all_page_ids.size());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -24,7 +25,7 @@ namespace bustub {
 // NOLINTNEXTLINE
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
   DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
@@ -117,4 +118,184 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, SplitMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // enough pairs to split the first bucket many times, inserted by several threads at once
+  const int num_keys = 20000;
+  const int num_threads = 4;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int i = t; i < num_keys; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // removing every pair merges the emptied buckets back, concurrently with lookups of the pairs that remain
+  threads.clear();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int i = t; i < num_keys; i += num_threads) {
+        EXPECT_TRUE(ht.Remove(nullptr, i, i));
+        std::vector<int> res;
+        ht.GetValue(nullptr, num_keys - 1 - i, &res);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ht.VerifyIntegrity();
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, i, &res));
+  }
+  EXPECT_FALSE(ht.Remove(nullptr, 0, 0));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, FullBufferPoolTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(3, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  EXPECT_TRUE(ht.Insert(nullptr, 0, 0));
+
+  // with every frame pinned, nothing can fetch the directory
+  page_id_t pinned[3];
+  for (auto &page_id : pinned) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  std::vector<int> res;
+  EXPECT_THROW(ht.GetValue(nullptr, 0, &res), Exception);
+  EXPECT_THROW(ht.Insert(nullptr, 1, 1), Exception);
+  EXPECT_THROW(ht.Remove(nullptr, 0, 0), Exception);
+
+  // with one frame pinned, inserts fit until a bucket has to split, which needs a third frame for its image
+  bpm->UnpinPage(pinned[0], false);
+  bpm->UnpinPage(pinned[1], false);
+  int inserted = 1;
+  while (true) {
+    try {
+      ASSERT_TRUE(ht.Insert(nullptr, inserted, inserted));
+    } catch (const Exception &) {
+      break;
+    }
+    inserted++;
+  }
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  // the failed operations released their latches and pins
+  bpm->UnpinPage(pinned[2], false);
+  const int num_keys = inserted + 1000;
+  for (int i = inserted; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+  for (int i = 0; i < num_keys; i++) {
+    res.clear();
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, DuplicateKeyTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // pairs of one key fill several pages, splitting cannot tell them apart so the bucket overflows instead
+  const int num_dups = 2000;
+  for (int i = 0; i < num_dups; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, 7, i)) << "Failed to insert " << i;
+  }
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  EXPECT_FALSE(ht.Insert(nullptr, 7, num_dups - 1));
+  std::vector<int> res;
+  ht.GetValue(nullptr, 7, &res);
+  ASSERT_EQ(num_dups, res.size());
+
+  // other keys split the bucket, the overflowing key keeps all of its pairs on one side
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    if (i != 7) {
+      ASSERT_TRUE(ht.Insert(nullptr, i, i));
+    }
+  }
+  ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+  res.clear();
+  ht.GetValue(nullptr, 7, &res);
+  std::sort(res.begin(), res.end());
+  for (int i = 0; i < num_dups; i++) {
+    ASSERT_EQ(i, res[i]);
+  }
+  for (int i = 0; i < num_keys; i++) {
+    if (i != 7) {
+      res.clear();
+      ht.GetValue(nullptr, i, &res);
+      ASSERT_EQ(1, res.size()) << "Failed to keep " << i;
+    }
+  }
+
+  // removes empty the overflow pages, and the pairs left are still found
+  for (int i = 0; i < num_dups; i += 2) {
+    ASSERT_TRUE(ht.Remove(nullptr, 7, i));
+  }
+  EXPECT_FALSE(ht.Remove(nullptr, 7, 0));
+  res.clear();
+  ht.GetValue(nullptr, 7, &res);
+  ASSERT_EQ(num_dups / 2, res.size());
+  for (int i = 1; i < num_dups; i += 2) {
+    ASSERT_TRUE(ht.Insert(nullptr, 7, num_dups + i));
+    ASSERT_TRUE(ht.Remove(nullptr, 7, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    ht.Remove(nullptr, i, i);
+  }
+  res.clear();
+  ht.GetValue(nullptr, 7, &res);
+  ASSERT_EQ(num_dups / 2, res.size());
+  for (int i = 1; i < num_dups; i += 2) {
+    ASSERT_TRUE(ht.Remove(nullptr, 7, num_dups + i));
+  }
+  ht.VerifyIntegrity();
+  res.clear();
+  EXPECT_FALSE(ht.GetValue(nullptr, 7, &res));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -0,0 +1,102 @@
+/**
+ * page_table_test.cpp
+ */
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "container/hash/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  auto table = std::make_unique<PageTable>(8);
+
+  for (int i = 0; i < 8; i++) {
+    table->Insert(i * 3, i);
+  }
+  EXPECT_EQ(8U, table->Size());
+
+  frame_id_t frame_id;
+  for (int i = 0; i < 8; i++) {
+    EXPECT_TRUE(table->Find(i * 3, frame_id));
+    EXPECT_EQ(i, frame_id);
+  }
+  EXPECT_FALSE(table->Find(1, frame_id));
+
+  // Inserting an existing page overwrites its frame.
+  table->Insert(3, 7);
+  EXPECT_TRUE(table->Find(3, frame_id));
+  EXPECT_EQ(7, frame_id);
+  EXPECT_EQ(8U, table->Size());
+
+  EXPECT_TRUE(table->Remove(3));
+  EXPECT_FALSE(table->Remove(3));
+  EXPECT_FALSE(table->Find(3, frame_id));
+  EXPECT_EQ(7U, table->Size());
+}
+
+TEST(PageTableTest, ChurnTest) {
+  // Keep the table full while pages come and go, so that removals keep shifting entries of long probe sequences.
+  const int pool_size = 64;
+  auto table = std::make_unique<PageTable>(pool_size);
+  for (int i = 0; i < pool_size; i++) {
+    table->Insert(i, i);
+  }
+
+  frame_id_t frame_id;
+  for (int page_id = pool_size; page_id < 100 * pool_size; page_id++) {
+    const int victim = page_id - pool_size;
+    ASSERT_TRUE(table->Find(victim, frame_id));
+    ASSERT_TRUE(table->Remove(victim));
+    table->Insert(page_id, frame_id);
+    ASSERT_EQ(static_cast<size_t>(pool_size), table->Size());
+  }
+  for (int page_id = 99 * pool_size; page_id < 100 * pool_size; page_id++) {
+    EXPECT_TRUE(table->Find(page_id, frame_id));
+    EXPECT_EQ(page_id % pool_size, frame_id);
+  }
+  EXPECT_FALSE(table->Find(0, frame_id));
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  // Pages 0..pinned-1 stay in the table while a writer churns through other pages. Readers must always find them.
+  const int pool_size = 64;
+  const int pinned = 16;
+  const int num_readers = 3;
+  auto table = std::make_unique<PageTable>(pool_size);
+  for (int i = 0; i < pinned; i++) {
+    table->Insert(i, i);
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  readers.reserve(num_readers);
+  for (int tid = 0; tid < num_readers; tid++) {
+    readers.emplace_back([&table, &done]() {
+      frame_id_t frame_id;
+      while (!done) {
+        for (int i = 0; i < pinned; i++) {
+          ASSERT_TRUE(table->Find(i, frame_id));
+          ASSERT_EQ(i, frame_id);
+        }
+      }
+    });
+  }
+
+  for (int page_id = pinned; page_id < 20000; page_id++) {
+    if (page_id >= pool_size) {
+      table->Remove(page_id - (pool_size - pinned));
+    }
+    table->Insert(page_id, pinned + page_id % (pool_size - pinned));
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression_test.cpp
+//
+// Identification: test/execution/compiled_expression_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/compiled_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto Constant(int32_t value) -> AbstractExpressionRef {
+  return std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(value));
+}
+
+void ExpectSameValue(const Value &compiled, const Value &expected, int row) {
+  ASSERT_EQ(compiled.IsNull(), expected.IsNull()) << row;
+  if (!expected.IsNull()) {
+    ASSERT_EQ(compiled.CompareEquals(expected), CmpBool::CmpTrue) << row;
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(CompiledExpressionTest, EvaluateTest) {
+  Schema schema(std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 16},
+                                    Column{"c", TypeId::BIGINT}, Column{"d", TypeId::BOOLEAN}});
+  std::vector<Tuple> tuples;
+  TupleBatch batch;
+  batch.Reset(&schema);
+  for (int i = 0; i < 100; i++) {
+    std::vector<Value> values{
+        i % 7 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i),
+        ValueFactory::GetVarcharValue(std::string(1, static_cast<char>('a' + i % 26))),
+        i % 11 == 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT) : ValueFactory::GetBigIntValue(i * 3),
+        i % 5 == 0 ? ValueFactory::GetNullValueByType(TypeId::BOOLEAN) : ValueFactory::GetBooleanValue(i % 2 == 0)};
+    tuples.emplace_back(values, &schema);
+    batch.AppendTuple(tuples.back(), RID{});
+  }
+
+  auto a = std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER);
+  auto b = std::make_shared<ColumnValueExpression>(0, 1, TypeId::VARCHAR);
+  auto c = std::make_shared<ColumnValueExpression>(0, 2, TypeId::BIGINT);
+  auto d = std::make_shared<ColumnValueExpression>(0, 3, TypeId::BOOLEAN);
+
+  // (a + 2147483600 > a - 7 or c >= 150) and d, which wraps around, and mixes NULLs into AND and OR
+  auto sum = std::make_shared<ArithmeticExpression>(a, Constant(2147483600), ArithmeticType::Plus);
+  auto diff = std::make_shared<ArithmeticExpression>(a, Constant(7), ArithmeticType::Minus);
+  auto c_ge = std::make_shared<ComparisonExpression>(
+      c, std::make_shared<ConstantValueExpression>(ValueFactory::GetBigIntValue(150)),
+      ComparisonType::GreaterThanOrEqual);
+  auto predicate = std::make_shared<LogicExpression>(
+      std::make_shared<LogicExpression>(std::make_shared<ComparisonExpression>(sum, diff, ComparisonType::GreaterThan),
+                                        c_ge, LogicType::Or),
+      d, LogicType::And);
+  // b is a VARCHAR, so this one is left to the expression tree
+  auto b_le = std::make_shared<ComparisonExpression>(
+      b, std::make_shared<ConstantValueExpression>(ValueFactory::GetVarcharValue("c")),
+      ComparisonType::LessThanOrEqual);
+
+  CompiledExpression compiled_predicate(predicate, schema);
+  CompiledExpression compiled_sum(sum, schema);
+  CompiledExpression compiled_b_le(b_le, schema);
+  ASSERT_TRUE(compiled_predicate.IsCompiled());
+  ASSERT_TRUE(compiled_sum.IsCompiled());
+  ASSERT_FALSE(compiled_b_le.IsCompiled());
+
+  // a = 48 wraps onto the NULL integer, which the expression tree has to read back as NULL too, tuple and batch alike
+  ColumnVector predicate_column;
+  ColumnVector sum_column;
+  ColumnVector tree_sum_column;
+  compiled_predicate.EvaluateBatch(batch, &predicate_column);
+  compiled_sum.EvaluateBatch(batch, &sum_column);
+  sum->EvaluateBatch(batch, &tree_sum_column);
+  for (int i = 0; i < 100; i++) {
+    const auto *tuple = &tuples[i];
+    auto expected = predicate->Evaluate(tuple, schema);
+    ExpectSameValue(compiled_predicate.Evaluate(tuple), expected, i);
+    ExpectSameValue(predicate_column.GetValue(i), expected, i);
+    ASSERT_EQ(compiled_predicate.EvaluatePredicate(tuple), !expected.IsNull() && expected.GetAs<bool>()) << i;
+    ExpectSameValue(compiled_sum.Evaluate(tuple), sum->Evaluate(tuple, schema), i);
+    ExpectSameValue(sum_column.GetValue(i), sum->Evaluate(tuple, schema), i);
+    ExpectSameValue(tree_sum_column.GetValue(i), sum->Evaluate(tuple, schema), i);
+    ExpectSameValue(compiled_b_le.Evaluate(tuple), b_le->Evaluate(tuple, schema), i);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(CompiledExpressionTest, EvaluateJoinTest) {
+  Schema left_schema(std::vector<Column>{Column{"x", TypeId::VARCHAR, 8}, Column{"a", TypeId::INTEGER}});
+  Schema right_schema(std::vector<Column>{Column{"b", TypeId::SMALLINT}});
+
+  // a = b, where the columns sit at different offsets of tuples of different schemas
+  auto a = std::make_shared<ColumnValueExpression>(0, 1, TypeId::INTEGER);
+  auto b = std::make_shared<ColumnValueExpression>(1, 0, TypeId::SMALLINT);
+  auto predicate = std::make_shared<ComparisonExpression>(a, b, ComparisonType::Equal);
+  CompiledExpression compiled(predicate, left_schema, &right_schema);
+  ASSERT_TRUE(compiled.IsCompiled());
+
+  for (int i = 0; i < 10; i++) {
+    Tuple left{std::vector<Value>{ValueFactory::GetVarcharValue("x"),
+                                  i == 3 ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                                         : ValueFactory::GetIntegerValue(i)},
+               &left_schema};
+    for (int j = 0; j < 10; j++) {
+      Tuple right{std::vector<Value>{ValueFactory::GetSmallIntValue(static_cast<int16_t>(j))}, &right_schema};
+      auto expected = predicate->EvaluateJoin(&left, left_schema, &right, right_schema);
+      ExpectSameValue(compiled.EvaluateJoin(&left, &right), expected, i * 10 + j);
+      ASSERT_EQ(compiled.EvaluateJoinPredicate(&left, &right), i != 3 && i == j);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_queue_test.cpp
+//
+// Identification: test/execution/morsel_queue_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "execution/morsel_queue.h"
+#include "execution/worker_pool.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MorselQueueTest, ParallelScanTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  Transaction txn(0);
+  Schema schema({Column("id", TypeId::INTEGER), Column("payload", TypeId::VARCHAR, 100)});
+  auto table = std::make_unique<TableHeap>(bpm.get(), nullptr, nullptr, &txn);
+
+  // enough tuples to span a lot more pages than the buffer pool holds, with some deleted along the way
+  const int tuple_cnt = 20000;
+  for (int i = 0; i < tuple_cnt; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(i % 100, 'x'))},
+                &schema);
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, &txn));
+    if (i % 10 == 0) {
+      ASSERT_TRUE(table->MarkDelete(rid, &txn));
+      table->ApplyDelete(rid, &txn);
+    }
+  }
+
+  // every worker counts the tuples it reads, and each tuple is read by exactly one of them
+  const size_t workers = 4;
+  MorselQueue morsels(table.get(), bpm.get(), &txn, 3);
+  std::vector<std::vector<int>> seen(workers, std::vector<int>(tuple_cnt, 0));
+  WorkerPool pool;
+  pool.Run(workers, [&](size_t worker) {
+    Morsel morsel;
+    std::vector<Tuple> tuples;
+    while (morsels.Next(&morsel)) {
+      for (size_t i = 0; i < morsel.page_count_; i++) {
+        morsels.ReadPage(morsel.page_ids_[i], &tuples);
+        for (const auto &tuple : tuples) {
+          seen[worker][tuple.GetValue(&schema, 0).GetAs<int32_t>()]++;
+        }
+      }
+    }
+  });
+  for (int i = 0; i < tuple_cnt; i++) {
+    int total = 0;
+    for (const auto &counts : seen) {
+      total += counts[i];
+    }
+    ASSERT_EQ(total, i % 10 == 0 ? 0 : 1) << i;
+  }
+
+  // the pool is reused, and a task throwing does not keep the others from finishing
+  std::vector<int> done(workers, 0);
+  ASSERT_THROW(pool.Run(workers,
+                        [&](size_t worker) {
+                          done[worker] = 1;
+                          if (worker == 1) {
+                            throw std::runtime_error("worker failed");
+                          }
+                        }),
+               std::runtime_error);
+  ASSERT_EQ(done, std::vector<int>(workers, 1));
+}
+
+}  // namespace bustub
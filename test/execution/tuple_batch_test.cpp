@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch_test.cpp
+//
+// Identification: test/execution/tuple_batch_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/tuple_batch.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TupleBatchTest, RoundTripTest) {
+  Schema schema(std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 16},
+                                    Column{"c", TypeId::BIGINT}, Column{"d", TypeId::BOOLEAN}});
+  TupleBatch batch;
+  batch.Reset(&schema);
+
+  // enough rows for the null bitmap to span several words
+  for (int i = 0; i < 200; i++) {
+    std::vector<Value> values{
+        i % 3 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(-i),
+        i % 5 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                   : ValueFactory::GetVarcharValue(std::to_string(i)),
+        ValueFactory::GetBigIntValue(int64_t{1} << 40 | i), ValueFactory::GetBooleanValue(i % 2 == 0)};
+    batch.AppendTuple(Tuple{values, &schema}, RID(i, 0));
+  }
+  ASSERT_EQ(batch.Size(), 200);
+  ASSERT_FALSE(batch.IsFull());
+
+  TupleBatch copy;
+  copy.Reset(&schema);
+  for (size_t row = 0; row < batch.Size(); row++) {
+    copy.AppendRow(batch, row);
+  }
+
+  for (int i = 0; i < 200; i++) {
+    auto tuple = copy.GetTuple(i);
+    ASSERT_EQ(copy.GetRid(i).GetPageId(), i);
+    ASSERT_EQ(tuple.GetValue(&schema, 0).IsNull(), i % 3 == 0);
+    if (i % 3 != 0) {
+      ASSERT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), -i);
+    }
+    ASSERT_EQ(tuple.GetValue(&schema, 1).IsNull(), i % 5 == 0);
+    if (i % 5 != 0) {
+      ASSERT_EQ(tuple.GetValue(&schema, 1).ToString(), std::to_string(i));
+    }
+    ASSERT_EQ(tuple.GetValue(&schema, 2).GetAs<int64_t>(), int64_t{1} << 40 | i);
+    ASSERT_EQ(tuple.GetValue(&schema, 3).GetAs<bool>(), i % 2 == 0);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(TupleBatchTest, EvaluateBatchTest) {
+  Schema schema(std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 16}});
+  TupleBatch batch;
+  batch.Reset(&schema);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 100; i++) {
+    std::vector<Value> values{
+        i % 7 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i),
+        ValueFactory::GetVarcharValue(std::string(1, static_cast<char>('a' + i % 26)))};
+    tuples.emplace_back(values, &schema);
+    batch.AppendTuple(tuples.back(), RID{});
+  }
+
+  // (a > 50 or b <= 'c') and a != 90, evaluated on whole columns has to agree with evaluating each tuple
+  auto a = std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER);
+  auto b = std::make_shared<ColumnValueExpression>(0, 1, TypeId::VARCHAR);
+  auto a_gt = std::make_shared<ComparisonExpression>(
+      a, std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(50)), ComparisonType::GreaterThan);
+  auto b_le = std::make_shared<ComparisonExpression>(
+      b, std::make_shared<ConstantValueExpression>(ValueFactory::GetVarcharValue("c")),
+      ComparisonType::LessThanOrEqual);
+  auto a_ne = std::make_shared<ComparisonExpression>(
+      a, std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(90)), ComparisonType::NotEqual);
+  auto predicate = std::make_shared<LogicExpression>(std::make_shared<LogicExpression>(a_gt, b_le, LogicType::Or),
+                                                     a_ne, LogicType::And);
+
+  // a column is read in place, anything computed goes to scratch
+  ColumnVector scratch;
+  ASSERT_EQ(&a->EvaluateBatchRef(batch, &scratch), &batch.GetColumn(0));
+  ASSERT_EQ(&predicate->EvaluateBatchRef(batch, &scratch), &scratch);
+
+  ColumnVector result;
+  predicate->EvaluateBatch(batch, &result);
+  ASSERT_EQ(result.Size(), 100);
+  for (int i = 0; i < 100; i++) {
+    auto expected = predicate->Evaluate(&tuples[i], schema);
+    ASSERT_EQ(result.IsNull(i), expected.IsNull()) << i;
+    if (!expected.IsNull()) {
+      ASSERT_EQ(result.GetInteger(i) != 0, expected.GetAs<bool>()) << i;
+    }
+  }
+}
+
+}  // namespace bustub
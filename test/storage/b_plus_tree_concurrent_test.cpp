@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
@@ -147,8 +148,8 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
   EXPECT_EQ(current_key, keys.size() + 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -198,8 +199,8 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
   EXPECT_EQ(current_key, keys.size() + 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -240,8 +241,8 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   EXPECT_EQ(size, 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -283,8 +284,8 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   EXPECT_EQ(size, 4);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -328,8 +329,77 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   EXPECT_EQ(size, 5);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, OptimisticReadTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  // create b+ tree, small pages so that the writers split pages all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // the even keys are there from the start, the odd keys are inserted while readers look for the even ones
+  std::vector<int64_t> keys;
+  std::vector<int64_t> new_keys;
+  int64_t scale_factor = 1000;
+  for (int64_t key = 0; key < scale_factor; key++) {
+    (key % 2 == 0 ? keys : new_keys).push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  std::atomic<bool> done{false};
+  auto reader = [&]() {
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    while (!done) {
+      for (auto key : keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        ASSERT_TRUE(tree.GetValue(index_key, &rids));
+        ASSERT_EQ(rids[0].GetSlotNum(), key);
+      }
+      int64_t last_key = -1;
+      size_t even_keys = 0;
+      for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+        auto key = static_cast<int64_t>((*iterator).second.GetSlotNum());
+        ASSERT_GT(key, last_key);
+        last_key = key;
+        even_keys += key % 2 == 0 ? 1 : 0;
+      }
+      ASSERT_EQ(even_keys, keys.size());
+    }
+  };
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 2; i++) {
+    readers.emplace_back(reader);
+  }
+  LaunchParallelTest(2, InsertHelperSplit, &tree, new_keys, 2);
+  done = true;
+  for (auto &thread : readers) {
+    thread.join();
+  }
+
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, scale_factor);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
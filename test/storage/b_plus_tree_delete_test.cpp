@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -87,8 +88,8 @@ TEST(BPlusTreeTests, DeleteTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -159,8 +160,146 @@ TEST(BPlusTreeTests, DeleteTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DeleteTest3) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 60; key++) {
+    keys.push_back(key);
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  // Removing from the front keeps underflowing the first child of a parent, which merges the sibling on its right
+  // into it, and every few removes the sibling has entries to spare and lends one instead
+  std::vector<RID> rids;
+  for (int64_t removed = 1; removed <= 50; removed++) {
+    index_key.SetFromInteger(removed);
+    tree.Remove(index_key, transaction);
+
+    int64_t expected = removed + 1;
+    index_key.SetFromInteger(expected);
+    for (auto iterator = tree.Begin(index_key); iterator != tree.End(); ++iterator) {
+      ASSERT_EQ((*iterator).second.GetSlotNum(), expected) << "after removing " << removed;
+      expected++;
+    }
+    ASSERT_EQ(expected, 61) << "after removing " << removed;
+  }
+
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key > 50) << key;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, CompressedDeleteTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(200, disk_manager);
+  // create b+ trees with compressed pages, one with small pages that underflow by their number of entries and one
+  // with pages as large as fit, which can only merge if the encoded entries of both fit into one page
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> small("foo_pk", bpm, comparator, 5, 5, true);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> large("bar_pk", bpm, comparator, 100000, 100000, true);
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // small keys, and keys that share no byte with the others and so make the large pages run out of room early
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 6000; key++) {
+    keys.push_back(key);
+  }
+  std::mt19937_64 random(0);
+  for (int i = 0; i < 1500; i++) {
+    keys.push_back(static_cast<int64_t>(random() | (uint64_t{1} << 62)));
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(small.Insert(index_key, RID(key), transaction));
+    ASSERT_TRUE(large.Insert(index_key, RID(key), transaction));
+  }
+  auto small_pages = small.GetPageCount();
+  auto large_pages = large.GetPageCount();
+
+  // Removing in random order underflows pages whose siblings sometimes have entries to spare, which redistributes,
+  // and sometimes not, which coalesces
+  auto check = [&](BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, std::vector<int64_t> remaining) {
+    std::sort(remaining.begin(), remaining.end());
+    for (auto key : remaining) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree->GetValue(index_key, &rids)) << key;
+      EXPECT_EQ(rids[0], RID(key));
+    }
+    size_t index = 0;
+    for (auto it = tree->Begin(); it != tree->End(); ++it, index++) {
+      ASSERT_LT(index, remaining.size());
+      EXPECT_EQ((*it).second, RID(remaining[index]));
+    }
+    EXPECT_EQ(index, remaining.size());
+  };
+  std::vector<int64_t> remaining = keys;
+  for (int round = 0; round < 3; round++) {
+    size_t keep = remaining.size() / 3;
+    for (size_t i = keep; i < remaining.size(); i++) {
+      index_key.SetFromInteger(remaining[i]);
+      small.Remove(index_key, transaction);
+      large.Remove(index_key, transaction);
+      rids.clear();
+      ASSERT_FALSE(small.GetValue(index_key, &rids)) << remaining[i];
+    }
+    remaining.resize(keep);
+    check(&small, remaining);
+    check(&large, remaining);
+  }
+  EXPECT_LT(small.GetPageCount(), small_pages);
+  EXPECT_LT(large.GetPageCount(), large_pages);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
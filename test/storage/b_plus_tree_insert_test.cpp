@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -58,8 +59,8 @@ TEST(BPlusTreeTests, InsertTest1) {
   bpm->UnpinPage(root_page_id, false);
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -121,8 +122,8 @@ TEST(BPlusTreeTests, InsertTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -190,9 +191,258 @@ TEST(BPlusTreeTests, InsertTest3) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+TEST(BPlusTreeTests, BulkLoadTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  (void)header_page;
+
+  // the even keys are bulk loaded, the odd keys are inserted into the loaded tree afterwards
+  int64_t scale_factor = 2000;
+  std::vector<std::pair<GenericKey<8>, RID>> items;
+  for (int64_t key = 0; key < scale_factor; key += 2) {
+    index_key.SetFromInteger(key);
+    items.emplace_back(index_key, RID(key));
+  }
+  for (auto [leaf_max_size, internal_max_size] : {std::pair{3, 3}, std::pair{5, 4}, std::pair{255, 255}}) {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                              internal_max_size);
+    ASSERT_TRUE(tree.BulkLoad(items, 0.7));
+    ASSERT_FALSE(tree.BulkLoad(items));
+
+    std::vector<RID> rids;
+    for (int64_t key = 0; key < scale_factor; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(tree.GetValue(index_key, &rids), key % 2 == 0);
+    }
+    int64_t current_key = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key = current_key + 2;
+    }
+    EXPECT_EQ(current_key, scale_factor);
+
+    for (int64_t key = 1; key < scale_factor; key += 2) {
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, RID(key), transaction));
+    }
+    current_key = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+    }
+    EXPECT_EQ(current_key, scale_factor);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
+TEST(BPlusTreeTests, GetValuesTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  GenericKey<8> index_key;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  (void)header_page;
+
+  // no keys are found in an empty tree
+  std::vector<GenericKey<8>> probes(3);
+  std::vector<std::vector<RID>> results;
+  tree.GetValues(probes, &results);
+  EXPECT_EQ(results, std::vector<std::vector<RID>>(3));
+
+  // multiples of three are in the tree, the probes are unsorted, have duplicates and miss some keys
+  for (int64_t key = 0; key < 300; key += 3) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key), transaction);
+  }
+  std::vector<int64_t> probe_keys;
+  for (int64_t key = 0; key < 320; key++) {
+    probe_keys.push_back((key * 37) % 320);
+    probe_keys.push_back(key);
+  }
+  probes.clear();
+  for (auto key : probe_keys) {
+    index_key.SetFromInteger(key);
+    probes.push_back(index_key);
+  }
+  tree.GetValues(probes, &results);
+  ASSERT_EQ(results.size(), probe_keys.size());
+  for (size_t i = 0; i < probe_keys.size(); i++) {
+    if (probe_keys[i] % 3 == 0 && probe_keys[i] < 300) {
+      ASSERT_EQ(results[i].size(), 1);
+      EXPECT_EQ(results[i][0].GetSlotNum(), probe_keys[i]);
+    } else {
+      EXPECT_TRUE(results[i].empty());
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, CompressedPagesTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(200, disk_manager);
+  // create b+ trees, one with as large pages as fit and one with compressed pages, whose sizes are clamped
+  const int leaf_size = (BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+  const int internal_size =
+      (BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, page_id_t>);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> plain("foo_pk", bpm, comparator, leaf_size, internal_size);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> compressed("bar_pk", bpm, comparator, 100000, 100000, true);
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  (void)header_page;
+
+  // small keys share most of their bytes, so the compressed tree needs fewer pages
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 10000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(plain.Insert(index_key, RID(key), transaction));
+    EXPECT_TRUE(compressed.Insert(index_key, RID(key), transaction));
+  }
+  EXPECT_LT(compressed.GetPageCount(), plain.GetPageCount());
+  EXPECT_LE(compressed.GetHeight(), plain.GetHeight());
+
+  // keys that share no byte with the others make pages run out of room before they are full
+  std::mt19937_64 random(0);
+  std::vector<int64_t> wide_keys;
+  for (int i = 0; i < 3000; i++) {
+    auto key = static_cast<int64_t>(random() | (uint64_t{1} << 62));
+    index_key.SetFromInteger(key);
+    if (compressed.Insert(index_key, RID(key), transaction)) {
+      wide_keys.push_back(key);
+    }
+  }
+  keys.insert(keys.end(), wide_keys.begin(), wide_keys.end());
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(compressed.GetValue(index_key, &rids)) << key;
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0], RID(key));
+  }
+  std::sort(keys.begin(), keys.end());
+  size_t index = 0;
+  for (auto it = compressed.Begin(); it != compressed.End(); ++it, index++) {
+    ASSERT_LT(index, keys.size());
+    EXPECT_EQ((*it).second, RID(keys[index]));
+  }
+  EXPECT_EQ(index, keys.size());
+
+  // a bulk loaded compressed tree fills its pages by bytes
+  std::vector<std::pair<GenericKey<8>, RID>> items;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    items.emplace_back(index_key, RID(key));
+  }
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> loaded("baz_pk", bpm, comparator, 100000, 100000, true);
+  ASSERT_TRUE(loaded.BulkLoad(items));
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(loaded.GetValue(index_key, &rids)) << key;
+    EXPECT_EQ(rids[0], RID(key));
+  }
+  index = 0;
+  for (auto it = loaded.Begin(); it != loaded.End(); ++it, index++) {
+    ASSERT_LT(index, keys.size());
+    EXPECT_EQ((*it).second, RID(keys[index]));
+  }
+  EXPECT_EQ(index, keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+template <typename Int>
+void CheckIntegerKeySearch(const std::string &column) {
+  auto key_schema = ParseCreateStatement("a " + column);
+  GenericComparator<sizeof(Int)> comparator(key_schema.get());
+  ASSERT_NE(KeyLayout::GENERIC, comparator.GetLayout());
+  auto make_key = [](Int value) {
+    GenericKey<sizeof(Int)> key;
+    memcpy(key.data_, &value, sizeof(Int));
+    return key;
+  };
+  std::mt19937 rng(0);
+  for (int size = 0; size < 70; size++) {
+    // sorted keys with gaps, the negative ones check that keys compare signed
+    std::vector<std::pair<GenericKey<sizeof(Int)>, RID>> entries;
+    std::vector<Int> keys;
+    Int next = -3 * size / 2;
+    for (int i = 0; i < size; i++) {
+      keys.push_back(next);
+      entries.emplace_back(make_key(next), RID(i));
+      next += 1 + rng() % 3;
+    }
+    for (Int k = -3 * size / 2 - 2; k <= next + 1; k++) {
+      int below = std::lower_bound(keys.begin(), keys.end(), k) - keys.begin();
+      int not_above = std::upper_bound(keys.begin(), keys.end(), k) - keys.begin();
+      EXPECT_EQ(below, IntegerKeyCountBelow(entries.data(), size, make_key(k), comparator, false)) << size << " " << k;
+      EXPECT_EQ(not_above, IntegerKeyCountBelow(entries.data(), size, make_key(k), comparator, true)) << size << " " << k;
+    }
+  }
+}
+
+TEST(BPlusTreeTests, IntegerKeySearchTest) {
+  CheckIntegerKeySearch<int32_t>("integer");
+  CheckIntegerKeySearch<int64_t>("bigint");
+}
 }  // namespace bustub
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/**
+ * Checks that comparator orders every pair of rows like comparing their values column by column does, with NULL
+ * before every other value.
+ */
+template <size_t KeySize>
+void CheckOrder(const GenericComparator<KeySize> &comparator, Schema *key_schema,
+                const std::vector<std::vector<Value>> &rows) {
+  std::vector<GenericKey<KeySize>> keys(rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    keys[i].SetFromKey(Tuple(rows[i], key_schema));
+  }
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      int expected = 0;
+      for (size_t c = 0; c < rows[i].size() && expected == 0; c++) {
+        if (rows[i][c].IsNull() || rows[j][c].IsNull()) {
+          expected = static_cast<int>(rows[j][c].IsNull()) - static_cast<int>(rows[i][c].IsNull());
+        } else if (rows[i][c].CompareLessThan(rows[j][c]) == CmpBool::CmpTrue) {
+          expected = -1;
+        } else if (rows[i][c].CompareGreaterThan(rows[j][c]) == CmpBool::CmpTrue) {
+          expected = 1;
+        }
+      }
+      int result = comparator(keys[i], keys[j]);
+      EXPECT_EQ(expected, (result > 0) - (result < 0)) << "rows " << i << " and " << j;
+    }
+  }
+}
+
+TEST(GenericKeyTest, LayoutComparatorTest) {
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int32_t> small(-3, 3);
+  std::vector<int32_t> integers{0, 1, -1, 255, 256, -256, BUSTUB_INT32_MAX, BUSTUB_INT32_MIN + 1};
+
+  auto integer_schema = ParseCreateStatement("a integer");
+  GenericComparator<4> integer_comparator(integer_schema.get());
+  EXPECT_EQ(KeyLayout::INTEGER, integer_comparator.GetLayout());
+  std::vector<std::vector<Value>> integer_rows;
+  for (auto v : integers) {
+    integer_rows.push_back({ValueFactory::GetIntegerValue(v)});
+  }
+  integer_rows.push_back({ValueFactory::GetNullValueByType(TypeId::INTEGER)});
+  CheckOrder(integer_comparator, integer_schema.get(), integer_rows);
+
+  auto bigint_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> bigint_comparator(bigint_schema.get());
+  EXPECT_EQ(KeyLayout::BIGINT, bigint_comparator.GetLayout());
+  std::vector<std::vector<Value>> bigint_rows;
+  for (auto v : integers) {
+    bigint_rows.push_back({ValueFactory::GetBigIntValue(static_cast<int64_t>(v) << 16)});
+  }
+  bigint_rows.push_back({ValueFactory::GetNullValueByType(TypeId::BIGINT)});
+  CheckOrder(bigint_comparator, bigint_schema.get(), bigint_rows);
+
+  auto pair_schema = ParseCreateStatement("a integer,b integer");
+  GenericComparator<8> pair_comparator(pair_schema.get());
+  EXPECT_EQ(KeyLayout::INTEGER_PAIR, pair_comparator.GetLayout());
+  std::vector<std::vector<Value>> pair_rows;
+  for (int i = 0; i < 40; i++) {
+    pair_rows.push_back({ValueFactory::GetIntegerValue(small(rng)), ValueFactory::GetIntegerValue(small(rng) * 300)});
+  }
+  CheckOrder(pair_comparator, pair_schema.get(), pair_rows);
+
+  auto varchar_schema = ParseCreateStatement("a varchar(16)");
+  GenericComparator<32> varchar_comparator(varchar_schema.get());
+  EXPECT_EQ(KeyLayout::VARCHAR, varchar_comparator.GetLayout());
+  std::vector<std::vector<Value>> varchar_rows;
+  for (const auto *s : {"", "a", "ab", "abc", "abd", "b", "ba", "\x7f", "\x80", "zzzzzzzz"}) {
+    varchar_rows.push_back({ValueFactory::GetVarcharValue(s)});
+  }
+  varchar_rows.push_back({ValueFactory::GetNullValueByType(TypeId::VARCHAR)});
+  CheckOrder(varchar_comparator, varchar_schema.get(), varchar_rows);
+
+  // keys that do not fit, or schemas without a raw byte layout, keep comparing values
+  GenericComparator<4> narrow_comparator(bigint_schema.get());
+  EXPECT_EQ(KeyLayout::GENERIC, narrow_comparator.GetLayout());
+  auto mixed_schema = ParseCreateStatement("a integer,b bigint");
+  GenericComparator<16> mixed_comparator(mixed_schema.get());
+  EXPECT_EQ(KeyLayout::GENERIC, mixed_comparator.GetLayout());
+  std::vector<std::vector<Value>> mixed_rows;
+  for (int i = 0; i < 20; i++) {
+    mixed_rows.push_back({ValueFactory::GetIntegerValue(small(rng)), ValueFactory::GetBigIntValue(small(rng))});
+  }
+  mixed_rows.push_back({ValueFactory::GetIntegerValue(0), ValueFactory::GetNullValueByType(TypeId::BIGINT)});
+  mixed_rows.push_back({ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetBigIntValue(0)});
+  mixed_rows.push_back(
+      {ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetNullValueByType(TypeId::BIGINT)});
+  CheckOrder(mixed_comparator, mixed_schema.get(), mixed_rows);
+}
+
+}  // namespace bustub
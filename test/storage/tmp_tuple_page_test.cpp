@@ -19,7 +19,7 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(TmpTuplePageTest, DISABLED_BasicTest) {
+TEST(TmpTuplePageTest, BasicTest) {
   // There are many ways to do this assignment, and this is only one of them.
   // If you don't like the TmpTuplePage idea, please feel free to delete this test case entirely.
   // You will get full credit as long as you are correctly using a linear probe hash table.
@@ -46,6 +46,19 @@ TEST(TmpTuplePageTest, DISABLED_BasicTest) {
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + sizeof(page_id_t) + sizeof(lsn_t)), BUSTUB_PAGE_SIZE - 8);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + BUSTUB_PAGE_SIZE - 8), 4);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + BUSTUB_PAGE_SIZE - 4), 123);
+  ASSERT_EQ(tmp_tuple.GetPageId(), page_id);
+  ASSERT_EQ(tmp_tuple.GetOffset(), BUSTUB_PAGE_SIZE - 8);
+
+  Tuple read_tuple;
+  ASSERT_EQ(page.Get(tmp_tuple.GetOffset(), &read_tuple), BUSTUB_PAGE_SIZE);
+  ASSERT_EQ(read_tuple.GetValue(&schema, 0).GetAs<int32_t>(), 123);
+
+  // the page refuses tuples once it is full
+  size_t inserted = 1;
+  while (page.Insert(tuple, &tmp_tuple)) {
+    inserted++;
+  }
+  ASSERT_EQ(inserted, (BUSTUB_PAGE_SIZE - 12) / 8);
 }
 
 }  // namespace bustub
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/table/table_heap_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  Transaction txn(0);
+  Schema schema({Column("payload", TypeId::VARCHAR, 400)});
+  Tuple tuple({ValueFactory::GetVarcharValue(std::string(400, 'x'))}, &schema);
+
+  // Enough pages for the free space map to need more than one page.
+  auto table = std::make_unique<TableHeap>(bpm.get(), nullptr, nullptr, &txn);
+  const auto first_page_id = table->GetFirstPageId();
+  std::vector<std::vector<RID>> rids_by_page;
+  page_id_t last_page_id = INVALID_PAGE_ID;
+  size_t tuple_cnt = 0;
+  while (rids_by_page.size() < FreeSpaceMapPage::CAPACITY + 100) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, &txn));
+    tuple_cnt++;
+    if (rid.GetPageId() != last_page_id) {
+      // Full pages are never gone back to.
+      ASSERT_GT(rid.GetPageId(), last_page_id);
+      last_page_id = rid.GetPageId();
+      rids_by_page.emplace_back();
+    }
+    rids_by_page.back().push_back(rid);
+  }
+
+  // Free a page at the start of the table, and the next insert goes there instead of the end.
+  auto free_page = [&](size_t page) {
+    for (const auto &rid : rids_by_page[page]) {
+      ASSERT_TRUE(table->MarkDelete(rid, &txn));
+      table->ApplyDelete(rid, &txn);
+      tuple_cnt--;
+    }
+  };
+  free_page(1);
+  RID rid;
+  auto insert = [&]() {
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, &txn));
+    tuple_cnt++;
+  };
+  insert();
+  EXPECT_EQ(rids_by_page[1][0].GetPageId(), rid.GetPageId());
+
+  // The map is on disk: a reopened table finds freed space right away.
+  free_page(FreeSpaceMapPage::CAPACITY + 10);
+  table = std::make_unique<TableHeap>(bpm.get(), nullptr, nullptr, first_page_id);
+  insert();
+  EXPECT_EQ(rids_by_page[1][0].GetPageId(), rid.GetPageId());
+  for (size_t i = 2; i < rids_by_page[1].size(); i++) {
+    insert();
+  }
+  insert();
+  EXPECT_EQ(rids_by_page[FreeSpaceMapPage::CAPACITY + 10][0].GetPageId(), rid.GetPageId());
+
+  // A table without a map, as written before maps existed, gets one built when it is opened.
+  free_page(2);
+  auto first_page = static_cast<TablePage *>(bpm->FetchPage(first_page_id));
+  first_page->SetFreeSpaceMapPageId(INVALID_PAGE_ID);
+  bpm->UnpinPage(first_page_id, true);
+  table = std::make_unique<TableHeap>(bpm.get(), nullptr, nullptr, first_page_id);
+  insert();
+  EXPECT_EQ(rids_by_page[2][0].GetPageId(), rid.GetPageId());
+
+  // Once every page is full again, inserts go to the end of the table.
+  while (rid.GetPageId() <= last_page_id) {
+    insert();
+  }
+  size_t scanned_cnt = 0;
+  for (auto it = table->Begin(&txn); it != table->End(); ++it) {
+    scanned_cnt++;
+  }
+  EXPECT_EQ(tuple_cnt, scanned_cnt);
+}
+
+}  // namespace bustub
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+/**
+ * Runs `thread_cnt` threads that repeatedly fetch and unpin a random page for `duration_ms` milliseconds.
+ * @return the total number of fetch/unpin pairs completed by all the threads
+ */
+auto RunFetchUnpin(bustub::BufferPoolManager *bpm, const std::vector<bustub::page_id_t> &page_ids, size_t thread_cnt,
+                   uint64_t duration_ms) -> uint64_t {
+  std::atomic<uint64_t> total_ops{0};
+  std::atomic<bool> start{false};
+  std::vector<std::thread> threads;
+
+  for (size_t thread_id = 0; thread_id < thread_cnt; thread_id++) {
+    threads.emplace_back([thread_id, bpm, &page_ids, duration_ms, &total_ops, &start] {
+      std::default_random_engine gen(thread_id);
+      std::uniform_int_distribution<size_t> page_dist(0, page_ids.size() - 1);
+      uint64_t ops = 0;
+      while (!start.load()) {
+        std::this_thread::yield();
+      }
+      auto begin = ClockMs();
+      while (ClockMs() - begin < duration_ms) {
+        // Check the clock every few hundred operations so that gettimeofday does not dominate the loop.
+        for (size_t i = 0; i < 256; i++) {
+          auto page_id = page_ids[page_dist(gen)];
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            fmt::print(stderr, "cannot fetch page {}, is the working set larger than the pool?\n", page_id);
+            exit(1);
+          }
+          bpm->UnpinPage(page_id, false);
+          ops++;
+        }
+      }
+      total_ops += ops;
+    });
+  }
+
+  start = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return total_ops.load();
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-bpm-bench");
+  program.add_argument("--duration").help("run each thread count for n milliseconds");
+  program.add_argument("--threads").help("maximum number of worker threads, doubled from 1 up to this value");
+  program.add_argument("--instances").help("number of buffer pool shards");
+  program.add_argument("--pool-size").help("number of frames in each shard");
+  program.add_argument("--pages").help("number of pages in the working set");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 2000;
+  size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  size_t num_instances = 1;
+  size_t pool_size = 1024;
+
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--threads")) {
+    max_threads = std::stoul(program.get("--threads"));
+  }
+  if (program.present("--instances")) {
+    num_instances = std::stoul(program.get("--instances"));
+  }
+  if (program.present("--pool-size")) {
+    pool_size = std::stoul(program.get("--pool-size"));
+  }
+
+  // By default the working set fits in half of the pool, so the benchmark measures latch contention, not eviction.
+  size_t page_cnt = num_instances * pool_size / 2;
+  if (program.present("--pages")) {
+    page_cnt = std::stoul(program.get("--pages"));
+  }
+
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  std::unique_ptr<bustub::BufferPoolManager> bpm;
+  if (num_instances > 1) {
+    bpm = std::make_unique<bustub::ParallelBufferPoolManager>(num_instances, pool_size, disk_manager.get());
+  } else {
+    bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+  }
+
+  std::vector<bustub::page_id_t> page_ids;
+  for (size_t i = 0; i < page_cnt; i++) {
+    bustub::page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    if (page == nullptr) {
+      fmt::print(stderr, "cannot allocate page {}\n", i);
+      return 1;
+    }
+    bpm->UnpinPage(page_id, false);
+    page_ids.push_back(page_id);
+  }
+
+  fmt::print(stderr, "x: {} instance(s), {} frames each, {} pages, {}ms per run\n", num_instances, pool_size, page_cnt,
+             duration_ms);
+
+  for (size_t thread_cnt = 1; thread_cnt <= max_threads; thread_cnt *= 2) {
+    auto ops = RunFetchUnpin(bpm.get(), page_ids, thread_cnt, duration_ms);
+    fmt::print("threads={:<3} ops={:<10} throughput={:.0f} ops/s\n", thread_cnt, ops,
+               static_cast<double>(ops) * 1000 / duration_ms);
+  }
+
+  return 0;
+}
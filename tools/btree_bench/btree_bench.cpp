@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "type/value_factory.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+struct RunResult {
+  uint64_t insert_ms_;
+  uint64_t lookup_ms_;
+  uint64_t found_;
+};
+
+/**
+ * Inserts `key_cnt` keys into a new index from `thread_cnt` threads, then looks every key up again from the same
+ * threads. Each thread gets every `thread_cnt`-th key in a random order, so that the threads write to the same leaves.
+ */
+auto RunIndex(size_t pool_size, size_t key_cnt, size_t thread_cnt) -> RunResult {
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  bustub::Schema schema({bustub::Column("key", bustub::TypeId::INTEGER)});
+  auto metadata = std::make_unique<bustub::IndexMetadata>("bench_idx", "bench", &schema, std::vector<uint32_t>{0});
+  bustub::BPlusTreeIndexForOneIntegerColumn index(std::move(metadata), bpm.get());
+
+  std::vector<std::vector<int32_t>> keys(thread_cnt);
+  for (size_t i = 0; i < key_cnt; i++) {
+    keys[i % thread_cnt].push_back(static_cast<int32_t>(i));
+  }
+  for (size_t t = 0; t < thread_cnt; t++) {
+    std::shuffle(keys[t].begin(), keys[t].end(), std::default_random_engine(t));
+  }
+
+  auto run = [&](bool insert, std::atomic<uint64_t> *found) {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_cnt; t++) {
+      threads.emplace_back([&, t] {
+        bustub::Transaction txn(static_cast<bustub::txn_id_t>(t));
+        std::vector<bustub::RID> result;
+        uint64_t thread_found = 0;
+        for (auto key : keys[t]) {
+          bustub::Tuple tuple({bustub::ValueFactory::GetIntegerValue(key)}, &schema);
+          if (insert) {
+            index.InsertEntry(tuple, bustub::RID(key), &txn);
+          } else {
+            result.clear();
+            index.ScanKey(tuple, &result, &txn);
+            thread_found += static_cast<uint64_t>(result.size() == 1 && result[0] == bustub::RID(key));
+          }
+        }
+        *found += thread_found;
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  };
+
+  RunResult result{0, 0, 0};
+  std::atomic<uint64_t> found{0};
+  auto begin = ClockMs();
+  run(true, &found);
+  result.insert_ms_ = ClockMs() - begin;
+  begin = ClockMs();
+  run(false, &found);
+  result.lookup_ms_ = ClockMs() - begin;
+  result.found_ = found;
+  return result;
+}
+
+/**
+ * Builds a new index over `key_cnt` keys in a random order with one bulk insert, like CREATE INDEX on a table that
+ * already has rows, and returns how long that took. Returns 0 if a key cannot be found afterwards.
+ */
+auto RunBulkLoad(size_t pool_size, size_t key_cnt) -> uint64_t {
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  bustub::Schema schema({bustub::Column("key", bustub::TypeId::INTEGER)});
+  auto metadata = std::make_unique<bustub::IndexMetadata>("bench_idx", "bench", &schema, std::vector<uint32_t>{0});
+  bustub::BPlusTreeIndexForOneIntegerColumn index(std::move(metadata), bpm.get());
+
+  std::vector<int32_t> keys(key_cnt);
+  for (size_t i = 0; i < key_cnt; i++) {
+    keys[i] = static_cast<int32_t>(i);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine(0));
+  std::vector<std::pair<bustub::Tuple, bustub::RID>> entries;
+  entries.reserve(key_cnt);
+  for (auto key : keys) {
+    entries.emplace_back(bustub::Tuple({bustub::ValueFactory::GetIntegerValue(key)}, &schema), bustub::RID(key));
+  }
+
+  bustub::Transaction txn(0);
+  auto begin = ClockMs();
+  index.InsertEntries(&entries, &txn);
+  auto load_ms = ClockMs() - begin;
+
+  std::vector<bustub::RID> result;
+  for (auto key : keys) {
+    result.clear();
+    index.ScanKey(bustub::Tuple({bustub::ValueFactory::GetIntegerValue(key)}, &schema), &result, &txn);
+    if (result.size() != 1 || !(result[0] == bustub::RID(key))) {
+      return 0;
+    }
+  }
+  return std::max<uint64_t>(load_ms, 1);
+}
+
+struct LayoutResult {
+  int height_;
+  size_t pages_;
+  uint64_t lookup_ms_;
+  uint64_t found_;
+};
+
+/**
+ * Inserts `key_cnt` keys in a random order into a new index on `KeySize` byte keys, with plain or compressed pages,
+ * then looks every key up again, and returns the shape of the tree and how long the lookups took.
+ */
+template <size_t KeySize>
+auto RunLayout(size_t pool_size, size_t key_cnt, bool compressed) -> LayoutResult {
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  bustub::Schema schema({bustub::Column("key", bustub::TypeId::INTEGER)});
+  auto metadata = std::make_unique<bustub::IndexMetadata>("bench_idx", "bench", &schema, std::vector<uint32_t>{0});
+  bustub::BPlusTreeIndex<bustub::GenericKey<KeySize>, bustub::RID, bustub::GenericComparator<KeySize>> index(
+      std::move(metadata), bpm.get(), compressed);
+
+  std::vector<int32_t> keys(key_cnt);
+  for (size_t i = 0; i < key_cnt; i++) {
+    keys[i] = static_cast<int32_t>(i);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine(0));
+  bustub::Transaction txn(0);
+  for (auto key : keys) {
+    index.InsertEntry(bustub::Tuple({bustub::ValueFactory::GetIntegerValue(key)}, &schema), bustub::RID(key), &txn);
+  }
+
+  LayoutResult result{index.GetHeight(), index.GetPageCount(), 0, 0};
+  std::vector<bustub::RID> rids;
+  auto begin = ClockMs();
+  for (auto key : keys) {
+    rids.clear();
+    index.ScanKey(bustub::Tuple({bustub::ValueFactory::GetIntegerValue(key)}, &schema), &rids, &txn);
+    result.found_ += static_cast<uint64_t>(rids.size() == 1 && rids[0] == bustub::RID(key));
+  }
+  result.lookup_ms_ = ClockMs() - begin;
+  return result;
+}
+
+auto RunLayout(size_t key_size, size_t pool_size, size_t key_cnt, bool compressed) -> LayoutResult {
+  switch (key_size) {
+    case 4:
+      return RunLayout<4>(pool_size, key_cnt, compressed);
+    case 8:
+      return RunLayout<8>(pool_size, key_cnt, compressed);
+    case 16:
+      return RunLayout<16>(pool_size, key_cnt, compressed);
+    case 32:
+      return RunLayout<32>(pool_size, key_cnt, compressed);
+    case 64:
+      return RunLayout<64>(pool_size, key_cnt, compressed);
+    default:
+      throw std::runtime_error(fmt::format("no index on {} byte keys", key_size));
+  }
+}
+
+/** Parses a comma separated list of numbers. */
+auto ParseList(const std::string &list) -> std::vector<size_t> {
+  std::vector<size_t> values;
+  for (size_t pos = 0; pos < list.size();) {
+    size_t end = list.find(',', pos);
+    end = end == std::string::npos ? list.size() : end;
+    values.push_back(std::stoul(list.substr(pos, end - pos)));
+    pos = end + 1;
+  }
+  return values;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-btree-bench");
+  program.add_argument("--keys").help("number of keys to insert and look up in every run");
+  program.add_argument("--threads").help("comma separated thread counts, one run each");
+  program.add_argument("--pool-size").help("number of frames in the buffer pool");
+  program.add_argument("--key-sizes").help("comma separated key sizes in bytes to compare page layouts at");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t key_cnt = 200000;
+  size_t pool_size = 4096;
+  std::vector<size_t> thread_cnts{1, 2, 4, 8};
+  std::vector<size_t> key_sizes{4, 64};
+
+  if (program.present("--keys")) {
+    key_cnt = std::stoul(program.get("--keys"));
+  }
+  if (program.present("--pool-size")) {
+    pool_size = std::stoul(program.get("--pool-size"));
+  }
+  if (program.present("--threads")) {
+    thread_cnts = ParseList(program.get("--threads"));
+  }
+  if (program.present("--key-sizes")) {
+    key_sizes = ParseList(program.get("--key-sizes"));
+  }
+
+  fmt::print(stderr, "x: {} keys, {} frames, {} hardware threads\n", key_cnt, pool_size,
+             std::thread::hardware_concurrency());
+
+  auto bulk_load_ms = RunBulkLoad(pool_size, key_cnt);
+  if (bulk_load_ms == 0) {
+    fmt::print(stderr, "bulk load: not all of {} keys found\n", key_cnt);
+    return 1;
+  }
+  fmt::print("bulk load   inserts/s={:.0f}\n",
+             1000.0 * static_cast<double>(key_cnt) / static_cast<double>(bulk_load_ms));
+
+  for (auto thread_cnt : thread_cnts) {
+    auto result = RunIndex(pool_size, key_cnt, thread_cnt);
+    if (result.found_ != key_cnt) {
+      fmt::print(stderr, "{} threads: only {} of {} keys found\n", thread_cnt, result.found_, key_cnt);
+      return 1;
+    }
+    fmt::print("threads={:<3} inserts/s={:<10.0f} lookups/s={:.0f}\n", thread_cnt,
+               1000.0 * static_cast<double>(key_cnt) / static_cast<double>(std::max<uint64_t>(result.insert_ms_, 1)),
+               1000.0 * static_cast<double>(key_cnt) / static_cast<double>(std::max<uint64_t>(result.lookup_ms_, 1)));
+  }
+
+  for (auto key_size : key_sizes) {
+    for (auto compressed : {false, true}) {
+      auto result = RunLayout(key_size, pool_size, key_cnt, compressed);
+      if (result.found_ != key_cnt) {
+        fmt::print(stderr, "{} byte keys: only {} of {} keys found\n", key_size, result.found_, key_cnt);
+        return 1;
+      }
+      fmt::print("key_size={:<3} {:<10} height={} pages={:<7} lookup_us={:.2f}\n", key_size,
+                 compressed ? "compressed" : "plain", result.height_, result.pages_,
+                 1000.0 * static_cast<double>(result.lookup_ms_) / static_cast<double>(key_cnt));
+    }
+  }
+
+  return 0;
+}
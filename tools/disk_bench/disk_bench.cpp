@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <future>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_posix.h"
+#include "storage/disk/disk_manager_uring.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+/**
+ * Every thread reads or writes random pages of the file for `duration_ms` milliseconds, writing with probability
+ * `write_ratio`. The disk manager is synced once at the end, like a buffer pool flush would do.
+ * @return the number of pages read and written
+ */
+auto RunRandomIo(bustub::DiskManager *disk_manager, size_t page_cnt, size_t thread_cnt, double write_ratio,
+                 uint64_t duration_ms) -> uint64_t {
+  std::atomic<uint64_t> total_ops{0};
+  std::vector<std::thread> threads;
+  threads.reserve(thread_cnt);
+  auto begin = ClockMs();
+  for (size_t tid = 0; tid < thread_cnt; tid++) {
+    threads.emplace_back([&, tid] {
+      alignas(4096) char buf[bustub::BUSTUB_PAGE_SIZE] = {0};
+      std::default_random_engine gen(tid);
+      std::uniform_int_distribution<bustub::page_id_t> page_dist(0, page_cnt - 1);
+      std::uniform_real_distribution<double> op_dist(0, 1);
+      uint64_t ops = 0;
+      while (ClockMs() - begin < duration_ms) {
+        // Check the clock every few operations so that gettimeofday does not dominate the loop.
+        for (size_t i = 0; i < 32; i++) {
+          auto page_id = page_dist(gen);
+          if (op_dist(gen) < write_ratio) {
+            buf[0] = static_cast<char>(ops);
+            disk_manager->WritePage(page_id, buf);
+          } else {
+            disk_manager->ReadPage(page_id, buf);
+          }
+          ops++;
+        }
+      }
+      total_ops += ops;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  disk_manager->Sync();
+  return total_ops;
+}
+
+/**
+ * One thread reads random pages of the file with the asynchronous API for `duration_ms` milliseconds, keeping
+ * `queue_depth` reads in flight.
+ * @return the number of pages read
+ */
+auto RunAsyncReads(bustub::DiskManager *disk_manager, size_t page_cnt, size_t queue_depth, uint64_t duration_ms)
+    -> uint64_t {
+  std::vector<char> bufs(queue_depth * bustub::BUSTUB_PAGE_SIZE);
+  std::deque<std::pair<std::future<bool>, size_t>> in_flight;
+  std::vector<size_t> free_bufs;
+  for (size_t i = 0; i < queue_depth; i++) {
+    free_bufs.push_back(i);
+  }
+  std::default_random_engine gen(0);
+  std::uniform_int_distribution<bustub::page_id_t> page_dist(0, page_cnt - 1);
+
+  uint64_t ops = 0;
+  auto begin = ClockMs();
+  while (ClockMs() - begin < duration_ms) {
+    for (size_t i = 0; i < 32; i++) {
+      while (!free_bufs.empty()) {
+        auto buf = free_bufs.back();
+        free_bufs.pop_back();
+        in_flight.emplace_back(disk_manager->ReadPageAsync(page_dist(gen), &bufs[buf * bustub::BUSTUB_PAGE_SIZE]), buf);
+      }
+      in_flight.front().first.wait();
+      free_bufs.push_back(in_flight.front().second);
+      in_flight.pop_front();
+      ops++;
+    }
+  }
+  for (auto &[io, buf] : in_flight) {
+    io.wait();
+  }
+  return ops;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-disk-bench");
+  program.add_argument("--duration").help("run each backend for n milliseconds");
+  program.add_argument("--pages").help("number of pages in the database file");
+  program.add_argument("--threads").help("number of threads doing page I/O");
+  program.add_argument("--write-ratio").help("fraction of page I/O that are writes");
+  program.add_argument("--queue-depths").help("comma separated queue depths for the asynchronous O_DIRECT reads");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 2000;
+  size_t page_cnt = 4096;
+  size_t thread_cnt = 4;
+  double write_ratio = 0.2;
+
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--pages")) {
+    page_cnt = std::stoul(program.get("--pages"));
+  }
+  if (program.present("--threads")) {
+    thread_cnt = std::stoul(program.get("--threads"));
+  }
+  if (program.present("--write-ratio")) {
+    write_ratio = std::stod(program.get("--write-ratio"));
+  }
+  std::vector<size_t> queue_depths{1, 4, 16, 64};
+  if (program.present("--queue-depths")) {
+    queue_depths.clear();
+    std::string depths = program.get("--queue-depths");
+    for (size_t pos = 0; pos < depths.size();) {
+      size_t end = depths.find(',', pos);
+      end = end == std::string::npos ? depths.size() : end;
+      queue_depths.push_back(std::stoul(depths.substr(pos, end - pos)));
+      pos = end + 1;
+    }
+  }
+
+  const std::string db_file = "disk_bench.db";
+  fmt::print(stderr, "x: {} pages, {} threads, {:.0f}% writes, {}ms per run\n", page_cnt, thread_cnt,
+             write_ratio * 100, duration_ms);
+
+  for (const std::string backend : {"fstream", "posix", "posix-direct"}) {
+    std::remove(db_file.c_str());
+    std::unique_ptr<bustub::DiskManager> disk_manager;
+    if (backend == "fstream") {
+      disk_manager = std::make_unique<bustub::DiskManager>(db_file);
+    } else {
+      auto posix = std::make_unique<bustub::DiskManagerPosix>(db_file, backend == "posix-direct");
+      if (backend == "posix-direct" && !posix->IsDirectIo()) {
+        fmt::print(stderr, "O_DIRECT is not available here, posix-direct runs buffered\n");
+      }
+      disk_manager = std::move(posix);
+    }
+
+    // Write out the whole file first, so that every read hits an existing page.
+    char buf[bustub::BUSTUB_PAGE_SIZE] = {0};
+    for (size_t i = 0; i < page_cnt; i++) {
+      disk_manager->WritePage(i, buf);
+    }
+    disk_manager->Sync();
+
+    auto begin = ClockMs();
+    auto ops = RunRandomIo(disk_manager.get(), page_cnt, thread_cnt, write_ratio, duration_ms);
+    auto elapsed_ms = std::max<uint64_t>(ClockMs() - begin, 1);
+    fmt::print("backend={:<13} ops={:<10} throughput={:.0f} pages/s\n", backend, ops,
+               static_cast<double>(ops) * 1000 / static_cast<double>(elapsed_ms));
+    disk_manager->ShutDown();
+  }
+
+  // Asynchronous reads bypassing the page cache, so that every read goes to the device. The posix disk manager serves
+  // them synchronously, so it stays at queue depth 1 whatever the caller asks for.
+  for (const std::string backend : {"posix", "uring"}) {
+    std::remove(db_file.c_str());
+    std::unique_ptr<bustub::DiskManagerPosix> disk_manager;
+    if (backend == "posix") {
+      disk_manager = std::make_unique<bustub::DiskManagerPosix>(db_file, true);
+    } else {
+      auto uring = std::make_unique<bustub::DiskManagerUring>(db_file, true);
+      if (!uring->IsUringEnabled()) {
+        fmt::print(stderr, "io_uring is not available here, uring runs synchronously\n");
+      }
+      disk_manager = std::move(uring);
+    }
+    alignas(4096) char buf[bustub::BUSTUB_PAGE_SIZE] = {0};
+    for (size_t i = 0; i < page_cnt; i++) {
+      disk_manager->WritePage(i, buf);
+    }
+    disk_manager->Sync();
+
+    for (auto queue_depth : queue_depths) {
+      auto begin = ClockMs();
+      auto ops = RunAsyncReads(disk_manager.get(), page_cnt, queue_depth, duration_ms);
+      auto elapsed_ms = std::max<uint64_t>(ClockMs() - begin, 1);
+      fmt::print("async_backend={:<6} queue_depth={:<4} ops={:<10} throughput={:.0f} pages/s\n", backend, queue_depth,
+                 ops, static_cast<double>(ops) * 1000 / static_cast<double>(elapsed_ms));
+    }
+    disk_manager->ShutDown();
+  }
+
+  std::remove(db_file.c_str());
+  std::remove("disk_bench.log");
+  return 0;
+}
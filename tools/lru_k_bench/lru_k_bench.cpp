@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/lru_k_replacer.h"
+#include "common/config.h"
+#include "fmt/core.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+/**
+ * The previous LRU-K replacer, built on std::unordered_map and std::list, kept here as the baseline to compare
+ * against. Evict walks both lists from the back and skips the non-evictable frames.
+ */
+class MapLRUKReplacer {
+ public:
+  MapLRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+
+  auto Evict(bustub::frame_id_t *frame_id) -> bool {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (curr_size_ == 0) {
+      return false;
+    }
+    for (auto it = history_list_.rbegin(); it != history_list_.rend(); it++) {
+      auto frame = *it;
+      if (is_evictable_[frame]) {
+        access_count_[frame] = 0;
+        history_list_.erase(history_map_[frame]);
+        history_map_.erase(frame);
+        *frame_id = frame;
+        curr_size_--;
+        is_evictable_[frame] = false;
+        return true;
+      }
+    }
+    for (auto it = cache_list_.rbegin(); it != cache_list_.rend(); it++) {
+      auto frame = *it;
+      if (is_evictable_[frame]) {
+        access_count_[frame] = 0;
+        cache_list_.erase(cache_map_[frame]);
+        cache_map_.erase(frame);
+        *frame_id = frame;
+        curr_size_--;
+        is_evictable_[frame] = false;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void RecordAccess(bustub::frame_id_t frame_id) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (frame_id > static_cast<int>(replacer_size_)) {
+      throw std::exception();
+    }
+    access_count_[frame_id]++;
+    if (access_count_[frame_id] == k_) {
+      auto it = history_map_[frame_id];
+      history_list_.erase(it);
+      history_map_.erase(frame_id);
+      cache_list_.push_front(frame_id);
+      cache_map_[frame_id] = cache_list_.begin();
+    } else if (access_count_[frame_id] > k_) {
+      if (cache_map_.count(frame_id) != 0U) {
+        auto it = cache_map_[frame_id];
+        cache_list_.erase(it);
+      }
+      cache_list_.push_front(frame_id);
+      cache_map_[frame_id] = cache_list_.begin();
+    } else {
+      if (history_map_.count(frame_id) == 0U) {
+        history_list_.push_front(frame_id);
+        history_map_[frame_id] = history_list_.begin();
+      }
+    }
+  }
+
+  void SetEvictable(bustub::frame_id_t frame_id, bool set_evictable) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (frame_id > static_cast<int>(replacer_size_)) {
+      throw std::exception();
+    }
+    if (access_count_[frame_id] == 0) {
+      return;
+    }
+    if (!is_evictable_[frame_id] && set_evictable) {
+      curr_size_++;
+    }
+    if (is_evictable_[frame_id] && !set_evictable) {
+      curr_size_--;
+    }
+    is_evictable_[frame_id] = set_evictable;
+  }
+
+ private:
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  size_t k_;
+  std::mutex latch_;
+  std::unordered_map<bustub::frame_id_t, size_t> access_count_;
+  std::list<bustub::frame_id_t> history_list_;
+  std::unordered_map<bustub::frame_id_t, std::list<bustub::frame_id_t>::iterator> history_map_;
+  std::list<bustub::frame_id_t> cache_list_;
+  std::unordered_map<bustub::frame_id_t, std::list<bustub::frame_id_t>::iterator> cache_map_;
+  std::unordered_map<bustub::frame_id_t, bool> is_evictable_;
+};
+
+/**
+ * Drives a replacer the way the buffer pool does. The first `pinned` frames are accessed first and then stay pinned,
+ * like the root and header pages. Every fourth operation is a miss that evicts a frame and loads it again; the others
+ * are hits that pin and unpin a random unpinned frame.
+ * @return the throughput in operations per second
+ */
+template <typename Replacer>
+auto RunReplacer(size_t num_frames, size_t pinned, size_t k, uint64_t duration_ms) -> double {
+  auto replacer = std::make_unique<Replacer>(num_frames, k);
+  for (size_t i = 0; i < num_frames; i++) {
+    auto frame_id = static_cast<bustub::frame_id_t>(i);
+    replacer->RecordAccess(frame_id);
+    replacer->SetEvictable(frame_id, i >= pinned);
+  }
+
+  std::default_random_engine gen(0);
+  std::uniform_int_distribution<bustub::frame_id_t> frame_dist(pinned, num_frames - 1);
+  uint64_t ops = 0;
+  auto begin = ClockMs();
+  while (ClockMs() - begin < duration_ms) {
+    for (size_t i = 0; i < 64; i++, ops++) {
+      bustub::frame_id_t frame_id;
+      if (ops % 4 == 0) {
+        if (!replacer->Evict(&frame_id)) {
+          fmt::print(stderr, "nothing to evict\n");
+          exit(1);
+        }
+      } else {
+        frame_id = frame_dist(gen);
+        replacer->SetEvictable(frame_id, false);
+      }
+      replacer->RecordAccess(frame_id);
+      replacer->SetEvictable(frame_id, true);
+    }
+  }
+  // The slow replacer can overshoot duration_ms by a whole batch, so use the time that actually passed.
+  auto elapsed_ms = std::max<uint64_t>(ClockMs() - begin, 1);
+  return static_cast<double>(ops) * 1000 / elapsed_ms;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-lru-k-bench");
+  program.add_argument("--duration").help("run each replacer and pool size for n milliseconds");
+  program.add_argument("--max-frames").help("largest pool size, pool sizes go from 10 up to it in steps of 10x");
+  program.add_argument("--pinned").help("percentage of frames that stay pinned for the whole run");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 1000;
+  size_t max_frames = 1000000;
+  size_t pinned_percent = 50;
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--max-frames")) {
+    max_frames = std::stoul(program.get("--max-frames"));
+  }
+  if (program.present("--pinned")) {
+    pinned_percent = std::stoul(program.get("--pinned"));
+  }
+
+  for (size_t num_frames = 10; num_frames <= max_frames; num_frames *= 10) {
+    // Leave at least one unpinned frame, so that there is always something to evict.
+    size_t pinned = std::min(num_frames * pinned_percent / 100, num_frames - 1);
+    auto array_tput = RunReplacer<bustub::LRUKReplacer>(num_frames, pinned, bustub::LRUK_REPLACER_K, duration_ms);
+    auto map_tput = RunReplacer<MapLRUKReplacer>(num_frames, pinned, bustub::LRUK_REPLACER_K, duration_ms);
+    fmt::print("frames={:<8} array={:.0f} ops/s map={:.0f} ops/s speedup={:.2f}x\n", num_frames, array_tput, map_tput,
+               array_tput / map_tput);
+  }
+
+  return 0;
+}
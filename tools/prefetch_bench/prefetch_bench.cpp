@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "concurrency/transaction.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+/** A file-backed disk manager that takes at least `read_latency_us` for every read, like a real device would. */
+class SlowDiskManager : public bustub::DiskManager {
+ public:
+  SlowDiskManager(const std::string &db_file, uint64_t read_latency_us)
+      : DiskManager(db_file), read_latency_us_(read_latency_us) {}
+
+  void ReadPage(bustub::page_id_t page_id, char *page_data) override {
+    if (read_latency_us_ > 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(read_latency_us_));
+    }
+    DiskManager::ReadPage(page_id, page_data);
+  }
+
+ private:
+  uint64_t read_latency_us_;
+};
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-prefetch-bench");
+  program.add_argument("--pages").help("number of pages in the scanned table");
+  program.add_argument("--pool-size").help("number of frames in the buffer pool used for the scans");
+  program.add_argument("--read-latency-us").help("extra latency added to every page read, in microseconds");
+  program.add_argument("--runs").help("number of cold scans per setting");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t page_cnt = 512;
+  size_t pool_size = 64;
+  uint64_t read_latency_us = 100;
+  size_t runs = 3;
+
+  if (program.present("--pages")) {
+    page_cnt = std::stoul(program.get("--pages"));
+  }
+  if (program.present("--pool-size")) {
+    pool_size = std::stoul(program.get("--pool-size"));
+  }
+  if (program.present("--read-latency-us")) {
+    read_latency_us = std::stoul(program.get("--read-latency-us"));
+  }
+  if (program.present("--runs")) {
+    runs = std::stoul(program.get("--runs"));
+  }
+
+  const std::string db_file = "prefetch_bench.db";
+  auto disk_manager = std::make_unique<SlowDiskManager>(db_file, read_latency_us);
+  bustub::Schema schema({bustub::Column("payload", bustub::TypeId::VARCHAR, 400)});
+  bustub::Transaction txn(0);
+
+  // Build the table in a pool large enough to hold all of it, then write it out.
+  bustub::page_id_t first_page_id;
+  size_t tuple_cnt = 0;
+  {
+    auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(page_cnt + 16, disk_manager.get());
+    bustub::TableHeap table(bpm.get(), nullptr, nullptr, &txn);
+    first_page_id = table.GetFirstPageId();
+    bustub::Tuple tuple({bustub::ValueFactory::GetVarcharValue(std::string(400, 'x'))}, &schema);
+    bustub::RID rid;
+    while (rid.GetPageId() < first_page_id + static_cast<bustub::page_id_t>(page_cnt) - 1) {
+      if (!table.InsertTuple(tuple, &rid, &txn)) {
+        fmt::print(stderr, "cannot insert tuple {}\n", tuple_cnt);
+        return 1;
+      }
+      tuple_cnt++;
+    }
+    bpm->FlushAllPages();
+  }
+
+  fmt::print(stderr, "x: {} pages, {} tuples, {} frames, {}us read latency, {} runs\n", page_cnt, tuple_cnt,
+             pool_size, read_latency_us, runs);
+
+  for (bool prefetch : {false, true}) {
+    bustub::enable_prefetch = prefetch;
+    uint64_t total_ms = 0;
+    size_t pages_prefetched = 0;
+    for (size_t run = 0; run < runs; run++) {
+      // A new buffer pool for every run, so that every scan starts cold.
+      auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+      bustub::TableHeap table(bpm.get(), nullptr, nullptr, first_page_id);
+      size_t scanned = 0;
+      auto begin = ClockMs();
+      for (auto it = table.Begin(&txn); it != table.End(); ++it) {
+        scanned++;
+      }
+      total_ms += ClockMs() - begin;
+      pages_prefetched += bpm->GetPagesPrefetched();
+      if (scanned != tuple_cnt) {
+        fmt::print(stderr, "scanned {} tuples, expected {}\n", scanned, tuple_cnt);
+        return 1;
+      }
+    }
+    fmt::print("prefetch={:<5} avg_scan_ms={:<8.1f} throughput={:.0f} pages/s pages_prefetched={}\n", prefetch,
+               static_cast<double>(total_ms) / runs,
+               static_cast<double>(page_cnt * runs) * 1000 / static_cast<double>(std::max<uint64_t>(total_ms, 1)),
+               pages_prefetched / runs);
+  }
+
+  disk_manager->ShutDown();
+  std::remove(db_file.c_str());
+  std::remove("prefetch_bench.log");
+  return 0;
+}
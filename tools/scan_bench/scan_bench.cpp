@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+/** Pages read from disk by the current thread. Misses are served on the fetching thread, so this counts its misses. */
+thread_local uint64_t thread_reads = 0;
+
+class CountingDiskManager : public bustub::DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(bustub::page_id_t page_id, char *page_data) override {
+    thread_reads++;
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+};
+
+struct RunResult {
+  uint64_t lookups_;
+  uint64_t lookup_misses_;
+  uint64_t scanned_pages_;
+};
+
+/**
+ * Fetches random hot pages with the lookup hint for `duration_ms` milliseconds, while another thread scans over
+ * `scan_page_ids` again and again with `scan_hint`. Like a TableIterator reading one tuple at a time, the scan fetches
+ * every page `touches` times in a row.
+ */
+auto RunMixed(bustub::BufferPoolManager *bpm, const std::vector<bustub::page_id_t> &hot_page_ids,
+              const std::vector<bustub::page_id_t> &scan_page_ids, bustub::AccessType scan_hint, size_t touches,
+              uint64_t duration_ms) -> RunResult {
+  RunResult result{0, 0, 0};
+  std::atomic<bool> done{false};
+
+  std::thread scan_thread([&] {
+    uint64_t scanned_pages = 0;
+    while (!done) {
+      for (auto page_id : scan_page_ids) {
+        for (size_t i = 0; i < touches; i++) {
+          if (bpm->FetchPage(page_id, scan_hint) == nullptr) {
+            fmt::print(stderr, "cannot fetch page {}, is the pool too small?\n", page_id);
+            exit(1);
+          }
+          bpm->UnpinPage(page_id, false);
+        }
+        scanned_pages++;
+        if (done) {
+          break;
+        }
+      }
+    }
+    result.scanned_pages_ = scanned_pages;
+  });
+
+  std::default_random_engine gen(0);
+  std::uniform_int_distribution<size_t> page_dist(0, hot_page_ids.size() - 1);
+  thread_reads = 0;
+  auto begin = ClockMs();
+  while (ClockMs() - begin < duration_ms) {
+    // Check the clock every few operations so that gettimeofday does not dominate the loop.
+    for (size_t i = 0; i < 64; i++) {
+      auto page_id = hot_page_ids[page_dist(gen)];
+      if (bpm->FetchPage(page_id, bustub::AccessType::Lookup) == nullptr) {
+        fmt::print(stderr, "cannot fetch page {}, is the pool too small?\n", page_id);
+        exit(1);
+      }
+      bpm->UnpinPage(page_id, false);
+      result.lookups_++;
+    }
+  }
+  result.lookup_misses_ = thread_reads;
+
+  done = true;
+  scan_thread.join();
+  return result;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-scan-bench");
+  program.add_argument("--duration").help("run each scan hint for n milliseconds");
+  program.add_argument("--pool-size").help("number of frames in the buffer pool");
+  program.add_argument("--hot-pages").help("number of pages the point lookups pick from");
+  program.add_argument("--scan-pages").help("number of pages in the scanned table");
+  program.add_argument("--touches").help("number of times the scan fetches each page in a row");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 2000;
+  size_t pool_size = 256;
+  size_t touches = 16;
+
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--pool-size")) {
+    pool_size = std::stoul(program.get("--pool-size"));
+  }
+  if (program.present("--touches")) {
+    touches = std::stoul(program.get("--touches"));
+  }
+
+  // By default the hot set fits in half of the pool, and the table is eight times larger than the pool.
+  size_t hot_page_cnt = pool_size / 2;
+  size_t scan_page_cnt = pool_size * 8;
+  if (program.present("--hot-pages")) {
+    hot_page_cnt = std::stoul(program.get("--hot-pages"));
+  }
+  if (program.present("--scan-pages")) {
+    scan_page_cnt = std::stoul(program.get("--scan-pages"));
+  }
+
+  fmt::print(stderr, "x: {} frames, {} hot pages, {} scanned pages fetched {} times each, {}ms per run\n", pool_size,
+             hot_page_cnt, scan_page_cnt, touches, duration_ms);
+
+  for (auto scan_hint : {bustub::AccessType::Unknown, bustub::AccessType::Scan}) {
+    auto disk_manager = std::make_unique<CountingDiskManager>();
+    auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+
+    std::vector<bustub::page_id_t> hot_page_ids;
+    std::vector<bustub::page_id_t> scan_page_ids;
+    for (size_t i = 0; i < hot_page_cnt + scan_page_cnt; i++) {
+      bustub::page_id_t page_id;
+      if (bpm->NewPage(&page_id) == nullptr) {
+        fmt::print(stderr, "cannot allocate page {}\n", i);
+        return 1;
+      }
+      bpm->UnpinPage(page_id, false);
+      (i < hot_page_cnt ? hot_page_ids : scan_page_ids).push_back(page_id);
+    }
+    bpm->FlushAllPages();
+    for (auto page_id : hot_page_ids) {
+      bpm->FetchPage(page_id, bustub::AccessType::Lookup);
+      bpm->UnpinPage(page_id, false);
+    }
+
+    auto result = RunMixed(bpm.get(), hot_page_ids, scan_page_ids, scan_hint, touches, duration_ms);
+    fmt::print("scan_hint={:<8} lookups={:<10} lookup_hit_rate={:.2f}% scanned_pages={}\n",
+               scan_hint == bustub::AccessType::Scan ? "scan" : "unknown", result.lookups_,
+               100.0 * static_cast<double>(result.lookups_ - result.lookup_misses_) /
+                   static_cast<double>(std::max<uint64_t>(result.lookups_, 1)),
+               result.scanned_pages_);
+  }
+
+  return 0;
+}